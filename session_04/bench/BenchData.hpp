@@ -0,0 +1,53 @@
+//
+// BenchData.hpp
+//
+// Input generation shared by the session_04 benchmarks.
+//
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace bench {
+
+// build a V from doubles, whatever V's component type is
+template <typename V>
+V make(double x, double y, double z) {
+    using T = decltype(V::x);
+    return V(static_cast<T>(x), static_cast<T>(y), static_cast<T>(z));
+}
+
+// n distinct, non zero length points
+template <typename V>
+std::vector<V> points(std::size_t n, double seed) {
+    std::vector<V> result;
+    result.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(make<V>(seed + i, seed - 0.5 * i, 1.0 + seed * i));
+    return result;
+}
+
+// n points spread uniformly over the cube [-1, 1]^3
+template <typename V>
+std::vector<V> cloud(std::size_t n, unsigned seed = 1) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<V> result;
+    result.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double x = dist(rng), y = dist(rng), z = dist(rng);
+        result.push_back(make<V>(x, y, z));
+    }
+    return result;
+}
+
+// report elements/s and GB/s for a pass touching n elements of bytesPerElement
+inline void setThroughput(benchmark::State& state, std::size_t n, std::size_t bytesPerElement) {
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n * bytesPerElement);
+}
+
+} // namespace bench
@@ -0,0 +1,77 @@
+//
+// LegacyVector.cpp
+//
+// Out of line implementation of LegacyVector, copied from the original
+// session_04/src/Vector.cpp.
+//
+
+#include "LegacyVector.hpp"
+#include <cmath>
+
+LegacyVector::LegacyVector() :  x{0.0},
+                                y{0.0},
+                                z{1.0}
+{}
+
+LegacyVector::LegacyVector(double x_, double y_, double z_) :
+    x{x_},
+    y{y_},
+    z{z_}
+{}
+
+LegacyVector LegacyVector::operator+(const LegacyVector &rhs) const {
+    return LegacyVector(x + rhs.x, y + rhs.y, z + rhs.z);
+}
+
+LegacyVector LegacyVector::operator-(const LegacyVector &rhs) const {
+    return LegacyVector(x - rhs.x, y - rhs.y, z - rhs.z);
+}
+
+LegacyVector& LegacyVector::operator+=(const LegacyVector &rhs) {
+    x += rhs.x;
+    y += rhs.y;
+    z += rhs.z;
+    return *this;
+}
+
+LegacyVector &LegacyVector::operator-=(const LegacyVector &rhs) {
+    x -= rhs.x;
+    y -= rhs.y;
+    z -= rhs.z;
+    return *this;
+}
+
+LegacyVector LegacyVector::operator*(const double d) const {
+    return LegacyVector(x*d, y*d, z*d);
+}
+
+
+LegacyVector operator*(const double d, const LegacyVector &v) {
+    return LegacyVector(v.x * d, v.y * d, v.z * d);
+}
+
+// dot product
+double LegacyVector::operator*(const LegacyVector &rhs) const {
+    return x*rhs.x + y*rhs.y + z*rhs.z;
+}
+
+bool LegacyVector::operator==(const LegacyVector &rhs) const {
+    return x == rhs.x && y == rhs.y && z == rhs.z;
+}
+
+LegacyVector LegacyVector::cross(const LegacyVector &rhs) const {
+    return LegacyVector(y * rhs.z - z * rhs.y,
+                  z * rhs.x - x * rhs.z,
+                  x * rhs.y - y * rhs.x);
+}
+
+void LegacyVector::normalize() {
+    double len = sqrt(x*x + y*y + z*z);
+    x /= len;
+    y /= len;
+    z /= len;
+}
+
+double LegacyVector::length() const {
+    return sqrt(x * x + y * y + z * z);
+}
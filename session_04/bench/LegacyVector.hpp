@@ -0,0 +1,35 @@
+//
+// LegacyVector.hpp
+//
+// The original session_04 Vector, with every operator defined out of line
+// in a shared library. It only exists so the benchmarks can show what the
+// header only BasicVector buys us.
+//
+#pragma once
+
+struct LegacyVector {
+    double x, y, z;
+    LegacyVector();
+    LegacyVector(double x_, double y_, double z_);
+    LegacyVector operator+(const LegacyVector& rhs) const;
+    LegacyVector operator-(const LegacyVector& rhs) const;
+
+    LegacyVector& operator+=(const LegacyVector& rhs);
+    LegacyVector& operator-=(const LegacyVector& rhs);
+
+    LegacyVector operator*(const double d) const;
+
+    friend LegacyVector operator*(const double d, const LegacyVector& v);
+
+    // dot product
+    double operator*(const LegacyVector& rhs) const;
+
+    // cross product
+    LegacyVector cross(const LegacyVector& rhs) const;
+
+    bool operator==(const LegacyVector& rhs) const;
+
+    double length() const;
+
+    void normalize();
+};
@@ -0,0 +1,101 @@
+//
+// inlineBench.cpp
+//
+// Before / after comparison for the header only BasicVector. LegacyVector
+// is the original out of line Vector ( every operator is a call into a
+// shared library ), Vector is BasicVector<double> and Vectorf is
+// BasicVector<float>. Each benchmark runs the same operator heavy loop over
+// arrays of the three types.
+//
+//     ./inline_bench --benchmark_counters_tabular=true
+//
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "BenchData.hpp"
+#include "LegacyVector.hpp"
+#include "../src/Vector.hpp"
+
+using bench::points;
+
+namespace {
+
+template <typename V>
+void setCounters(benchmark::State& state, std::size_t n, std::size_t streams) {
+    bench::setThroughput(state, n, streams * sizeof(V));
+}
+
+} // namespace
+
+// out = a + b * 2 - c
+template <typename V>
+void BM_Axpy(benchmark::State& state) {
+    const std::size_t n = state.range(0);
+    auto a = points<V>(n, 1.0), b = points<V>(n, 2.0), c = points<V>(n, 3.0);
+    std::vector<V> out(n);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = a[i] + b[i] * 2.0 - c[i];
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters<V>(state, n, 4);
+}
+
+template <typename V>
+void BM_Dot(benchmark::State& state) {
+    const std::size_t n = state.range(0);
+    auto a = points<V>(n, 1.0), b = points<V>(n, 2.0);
+    for (auto _ : state) {
+        decltype(V::x) sum = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            sum += a[i] * b[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    setCounters<V>(state, n, 2);
+}
+
+template <typename V>
+void BM_Cross(benchmark::State& state) {
+    const std::size_t n = state.range(0);
+    auto a = points<V>(n, 1.0), b = points<V>(n, 2.0);
+    std::vector<V> out(n);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = a[i].cross(b[i]);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters<V>(state, n, 3);
+}
+
+template <typename V>
+void BM_Normalize(benchmark::State& state) {
+    const std::size_t n = state.range(0);
+    const auto a = points<V>(n, 1.0);
+    std::vector<V> out(n);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = a[i];
+            out[i].normalize();
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters<V>(state, n, 2);
+}
+
+#define VECTOR_BENCH(fn) \
+    BENCHMARK_TEMPLATE(fn, LegacyVector)->Range(1 << 10, 1 << 20); \
+    BENCHMARK_TEMPLATE(fn, Vector)->Range(1 << 10, 1 << 20); \
+    BENCHMARK_TEMPLATE(fn, Vectorf)->Range(1 << 10, 1 << 20)
+
+VECTOR_BENCH(BM_Axpy);
+VECTOR_BENCH(BM_Dot);
+VECTOR_BENCH(BM_Cross);
+VECTOR_BENCH(BM_Normalize);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,585 @@
+//
+// vectorBench.cpp
+//
+// Micro benchmarks for every Vector operation, built on google benchmark.
+//
+//   call/<op>         one operation on Vectors held in registers ( ns/op )
+//   aos/<op>/<n>      the operation over std::vector<Vector> of n elements
+//   soa/<op>/<n>      the VectorArray batch kernel over n elements
+//   batch/<op>/<n>    a multithreaded batch call over std::vector<Vector>
+//   kdtree/<op>/<n>   KdTree construction, and single query latency on a
+//                     tree of n points
+//
+// Array benchmarks report time_per_op ( ns/op ), bytes_per_second ( GB/s ) and
+// items_per_second ( elements/s ) for sizes from 1K up to --max_elements
+// ( 100M by default; the binary ops need three arrays of that size, about
+// 7GB at 100M ). Results are also written as JSON to vector_bench.json
+// unless --benchmark_out is given, so runs can be diffed between releases
+// with google benchmark's tools/compare.py.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchData.hpp"
+#include "../src/Vector.hpp"
+#include "../src/ConvexHull.hpp"
+#include "../src/KMeans.hpp"
+#include "../src/KdTree.hpp"
+#include "../src/Quantize.hpp"
+#include "../src/Reduce.hpp"
+#include "../src/SpaceFillingCurve.hpp"
+#include "../src/SpatialGrid.hpp"
+#include "../src/Transform.hpp"
+#include "../src/TriangleMesh.hpp"
+#include "../src/VectorArray.hpp"
+
+using bench::cloud;
+using bench::points;
+
+namespace {
+
+const Vector unitX{1, 0, 0};
+
+// GB/s and elements/s, plus time per element
+void setArrayCounters(benchmark::State& state, std::size_t n, std::size_t bytesPerElement) {
+    bench::setThroughput(state, n, bytesPerElement);
+    state.counters["time_per_op"] = benchmark::Counter(
+            static_cast<double>(state.iterations() * n),
+            benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+//
+// per call
+//
+template <typename Op>
+void callBench(benchmark::State& state, Op op) {
+    Vector a{1.5, -2.25, 3.0};
+    Vector b{0.5, 4.0, -1.75};
+    for (auto _ : state) {
+        // hide the inputs from the optimizer so nothing is constant folded
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        auto result = op(a, b);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+//
+// array of structures: std::vector<Vector>
+//
+template <typename Op>
+void aosBench(benchmark::State& state, Op op, std::size_t inputs) {
+    const std::size_t n = state.range(0);
+    const auto a = points<Vector>(n, 1.0);
+    const auto b = points<Vector>(n, 2.0);
+    using Out = decltype(op(a[0], b[0]));
+    std::vector<Out> out(n);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = op(a[i], b[i]);
+        benchmark::DoNotOptimize(out);
+        benchmark::ClobberMemory();
+    }
+    setArrayCounters(state, n, inputs * sizeof(Vector) + sizeof(Out));
+}
+
+//
+// structure of arrays: VectorArray kernels
+//
+template <typename Op>
+void soaBench(benchmark::State& state, Op op, std::size_t bytesPerElement) {
+    const std::size_t n = state.range(0);
+    const VectorArray a(points<Vector>(n, 1.0));
+    const VectorArray b(points<Vector>(n, 2.0));
+    VectorArray out(n);
+    std::vector<double> scalars(n);
+    for (auto _ : state) {
+        op(a, b, out, scalars);
+        benchmark::ClobberMemory();
+    }
+    setArrayCounters(state, n, bytesPerElement);
+}
+
+//
+// whole array calls over std::vector<Vector>, such as transformPoints
+//
+template <typename Op>
+void batchBench(benchmark::State& state, Op op, std::size_t bytesPerElement) {
+    const std::size_t n = state.range(0);
+    const auto a = points<Vector>(n, 1.0);
+    std::vector<Vector> out(n);
+    for (auto _ : state) {
+        op(a, out);
+        benchmark::ClobberMemory();
+    }
+    setArrayCounters(state, n, bytesPerElement);
+}
+
+//
+// KdTree
+//
+void kdBuildBench(benchmark::State& state) {
+    const std::size_t n = state.range(0);
+    const auto a = points<Vector>(n, 1.0);
+    for (auto _ : state) {
+        KdTree tree(a);
+        benchmark::DoNotOptimize(tree);
+    }
+    setArrayCounters(state, n, sizeof(Vector));
+}
+
+// one query per iteration, so the reported time is the query latency
+template <typename Query>
+void kdQueryBench(benchmark::State& state, Query query) {
+    const std::size_t n = state.range(0);
+    const KdTree tree(points<Vector>(n, 1.0));
+    const auto queries = points<Vector>(4096, 0.25);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto result = query(tree, queries[i++ & 4095]);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+//
+// Quantize: decode reads the encoded bytes and writes Vectors
+//
+void quantEncodeBench(benchmark::State& state, QuantizedPoints::Precision precision) {
+    const std::size_t n = state.range(0);
+    const auto a = points<Vector>(n, 1.0);
+    const BoundingBox box = bounds(a);
+    for (auto _ : state) {
+        QuantizedPoints q(a, box, precision);
+        benchmark::DoNotOptimize(q);
+    }
+    setArrayCounters(state, n, sizeof(Vector));
+}
+
+void quantDecodeBench(benchmark::State& state, QuantizedPoints::Precision precision) {
+    const std::size_t n = state.range(0);
+    const QuantizedPoints q(points<Vector>(n, 1.0), precision);
+    std::vector<Vector> out(n);
+    for (auto _ : state) {
+        q.decode(out.data());
+        benchmark::ClobberMemory();
+    }
+    setArrayCounters(state, n, q.bytes() / n + sizeof(Vector));
+}
+
+void octDecodeBench(benchmark::State& state) {
+    const std::size_t n = state.range(0);
+    auto normals = points<Vector>(n, 1.0);
+    for (auto& v : normals)
+        v.normalize();
+    const OctNormals oct(normals);
+    std::vector<Vector> out(n);
+    for (auto _ : state) {
+        oct.decode(out.data());
+        benchmark::ClobberMemory();
+    }
+    setArrayCounters(state, n, oct.bytes() / n + sizeof(Vector));
+}
+
+//
+// SpatialGrid and weld, over a random cloud since points() is a line.
+// Cells are sized for about one point each.
+//
+void gridBuildBench(benchmark::State& state) {
+    const std::size_t n = state.range(0);
+    const auto a = cloud<Vector>(n);
+    const double cell = 2.0 / std::cbrt(static_cast<double>(n));
+    for (auto _ : state) {
+        SpatialGrid grid(a, cell);
+        benchmark::DoNotOptimize(grid);
+    }
+    setArrayCounters(state, n, sizeof(Vector));
+}
+
+// every point appears six times, as the corners of an unindexed mesh do
+void weldBench(benchmark::State& state) {
+    const std::size_t n = state.range(0);
+    const auto unique = cloud<Vector>((n + 5) / 6);
+    std::vector<Vector> a(n);
+    for (std::size_t i = 0; i < n; ++i)
+        a[i] = unique[(i * 7919) % unique.size()];
+    for (auto _ : state) {
+        auto welded = weld(a, 1e-9);
+        benchmark::DoNotOptimize(welded);
+    }
+    setArrayCounters(state, n, sizeof(Vector));
+}
+
+//
+// space filling curves: the cost of ordering, and what it buys downstream.
+// The locality benchmarks run the same work over the same random cloud,
+// laid out in random order or sorted along a curve.
+//
+void curveOrderBench(benchmark::State& state, Curve curve) {
+    const std::size_t n = state.range(0);
+    const auto a = cloud<Vector>(n);
+    for (auto _ : state) {
+        auto order = curveOrder(a, curve);
+        benchmark::DoNotOptimize(order);
+    }
+    setArrayCounters(state, n, sizeof(Vector));
+}
+
+enum class Layout { Random, Morton, Hilbert };
+
+std::vector<Vector> laidOut(std::size_t n, Layout layout) {
+    auto a = cloud<Vector>(n);
+    if (layout != Layout::Random)
+        sortAlongCurve(a, layout == Layout::Morton ? Curve::Morton : Curve::Hilbert);
+    return a;
+}
+
+// the 8 nearest neighbours of every point, as a batch of queries in
+// memory order
+void knnLocalityBench(benchmark::State& state, Layout layout) {
+    const std::size_t n = state.range(0);
+    const auto a = laidOut(n, layout);
+    const KdTree tree(a);
+    std::vector<KdTree::Neighbour> out;
+    for (auto _ : state) {
+        tree.kNearest(a.data(), n, 8, out);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// one step of Laplacian smoothing: move every point to the mean of its 8
+// nearest neighbours. Each point gathers from wherever its neighbours are
+// stored.
+void smoothLocalityBench(benchmark::State& state, Layout layout) {
+    const std::size_t n = state.range(0);
+    const auto a = laidOut(n, layout);
+    std::vector<KdTree::Neighbour> neighbours;
+    KdTree(a).kNearest(a.data(), n, 8, neighbours);
+    std::vector<Vector> out(n);
+    for (auto _ : state) {
+        ThreadPool::global().parallelFor(n, 16 * 1024, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                Vector mean(0, 0, 0);
+                for (std::size_t k = 0; k < 8; ++k)
+                    mean += a[neighbours[i * 8 + k].index];
+                out[i] = mean * 0.125;
+            }
+        });
+        benchmark::ClobberMemory();
+    }
+    setArrayCounters(state, n, 9 * sizeof(Vector));
+}
+
+//
+// TriangleMesh over a height field grid of about n triangles. Items are
+// triangles.
+//
+TriangleMesh gridMesh(std::size_t n) {
+    const std::uint32_t side = static_cast<std::uint32_t>(std::sqrt(n / 2.0)) + 2;
+    VectorArray vertices(static_cast<std::size_t>(side) * side);
+    for (std::uint32_t i = 0; i < side; ++i)
+        for (std::uint32_t j = 0; j < side; ++j)
+            vertices.set(i * side + j, Vector(i, j, std::sin(i * 0.1) * std::cos(j * 0.1)));
+    std::vector<std::uint32_t> indices;
+    indices.reserve(6 * static_cast<std::size_t>(side - 1) * (side - 1));
+    for (std::uint32_t i = 0; i + 1 < side; ++i) {
+        for (std::uint32_t j = 0; j + 1 < side; ++j) {
+            const std::uint32_t a = i * side + j, b = a + side;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    return TriangleMesh(std::move(vertices), std::move(indices));
+}
+
+template <typename Op>
+void meshBench(benchmark::State& state, Op op) {
+    const TriangleMesh mesh = gridMesh(state.range(0));
+    VectorArray out;
+    for (auto _ : state) {
+        op(mesh, out);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * mesh.triangleCount());
+}
+
+//
+// k-means over the random cloud, with the iterations capped so every size
+// does the same number of passes. "pruned" is the fraction of point to
+// center distances the bounds saved.
+//
+void kMeansBench(benchmark::State& state, std::size_t k) {
+    const std::size_t n = state.range(0);
+    const auto a = cloud<Vector>(n);
+    const auto seeds = kMeansPlusPlus(a, k);
+    KMeansOptions options;
+    options.maxIterations = 20;
+    std::uint64_t distances = 0, possible = 0;
+    for (auto _ : state) {
+        auto result = kMeans(a, seeds, options);
+        distances += result.distances;
+        possible += static_cast<std::uint64_t>(result.iterations) * n * k;
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["pruned"] = 1.0 - static_cast<double>(distances) / possible;
+    setArrayCounters(state, n, sizeof(Vector));
+}
+
+void kMeansSeedBench(benchmark::State& state, std::size_t k) {
+    const std::size_t n = state.range(0);
+    const auto a = cloud<Vector>(n);
+    for (auto _ : state) {
+        auto seeds = kMeansPlusPlus(a, k);
+        benchmark::DoNotOptimize(seeds);
+    }
+    setArrayCounters(state, n, sizeof(Vector));
+}
+
+// hull of the random cloud ( a cube, so the cull leaves almost nothing )
+// or of the points of the same cloud inside the unit ball
+void hullBench(benchmark::State& state, bool ball) {
+    const std::size_t n = state.range(0);
+    std::vector<Vector> a;
+    if (ball) {
+        for (const Vector& p : cloud<Vector>(2 * n))
+            if (p * p <= 1 && a.size() < n)
+                a.push_back(p);
+    } else {
+        a = cloud<Vector>(n);
+    }
+    for (auto _ : state) {
+        auto hull = convexHullIndices(a);
+        benchmark::DoNotOptimize(hull);
+    }
+    setArrayCounters(state, a.size(), sizeof(Vector));
+}
+
+void registerSizes(benchmark::internal::Benchmark* b, long long maxElements) {
+    for (long long n = 1000; n <= maxElements; n *= 10)
+        b->Arg(n);
+    b->Unit(benchmark::kMicrosecond);
+}
+
+template <typename Op>
+void addCall(const std::string& name, Op op) {
+    benchmark::RegisterBenchmark(("call/" + name).c_str(),
+                                 [op](benchmark::State& st) { callBench(st, op); });
+}
+
+template <typename Op>
+void addAos(const std::string& name, std::size_t inputs, long long maxElements, Op op) {
+    registerSizes(benchmark::RegisterBenchmark(("aos/" + name).c_str(),
+                  [op, inputs](benchmark::State& st) { aosBench(st, op, inputs); }),
+                  maxElements);
+}
+
+template <typename Op>
+void addSoa(const std::string& name, std::size_t bytesPerElement, long long maxElements, Op op) {
+    registerSizes(benchmark::RegisterBenchmark(("soa/" + name).c_str(),
+                  [op, bytesPerElement](benchmark::State& st) { soaBench(st, op, bytesPerElement); }),
+                  maxElements);
+}
+
+template <typename Op>
+void addBatch(const std::string& name, std::size_t bytesPerElement, long long maxElements, Op op) {
+    registerSizes(benchmark::RegisterBenchmark(("batch/" + name).c_str(),
+                  [op, bytesPerElement](benchmark::State& st) { batchBench(st, op, bytesPerElement); }),
+                  maxElements);
+}
+
+void addKdTree(long long maxElements) {
+    registerSizes(benchmark::RegisterBenchmark("kdtree/build", kdBuildBench), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("kdtree/nearest", [](benchmark::State& st) {
+        kdQueryBench(st, [](const KdTree& t, const Vector& q) { return t.nearest(q); });
+    }), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("kdtree/k_nearest_8", [](benchmark::State& st) {
+        kdQueryBench(st, [](const KdTree& t, const Vector& q) { return t.kNearest(q, 8); });
+    }), maxElements);
+}
+
+void addQuantize(long long maxElements) {
+    using P = QuantizedPoints::Precision;
+    registerSizes(benchmark::RegisterBenchmark("quantize/encode_16", quantEncodeBench, P::Bits16), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("quantize/encode_21", quantEncodeBench, P::Bits21), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("quantize/decode_16", quantDecodeBench, P::Bits16), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("quantize/decode_21", quantDecodeBench, P::Bits21), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("quantize/oct_decode", octDecodeBench), maxElements);
+}
+
+void addSpatialGrid(long long maxElements) {
+    registerSizes(benchmark::RegisterBenchmark("grid/build", gridBuildBench), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("grid/weld", weldBench), maxElements);
+}
+
+void addCurves(long long maxElements) {
+    registerSizes(benchmark::RegisterBenchmark("curve/morton_order", curveOrderBench, Curve::Morton), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("curve/hilbert_order", curveOrderBench, Curve::Hilbert), maxElements);
+
+    // every size builds a tree and runs a full kNN pass to set up, so stop
+    // well short of the largest arrays
+    const long long m = std::min(maxElements, 10000000LL);
+    const std::pair<const char*, Layout> layouts[] = {
+        {"random", Layout::Random}, {"morton", Layout::Morton}, {"hilbert", Layout::Hilbert}};
+    for (const auto& l : layouts) {
+        const Layout layout = l.second;
+        registerSizes(benchmark::RegisterBenchmark((std::string("locality/knn_8_") + l.first).c_str(),
+                                                   knnLocalityBench, layout), m);
+        registerSizes(benchmark::RegisterBenchmark((std::string("locality/smooth_") + l.first).c_str(),
+                                                   smoothLocalityBench, layout), m);
+    }
+}
+
+template <typename Op>
+void addMesh(const std::string& name, long long maxElements, Op op) {
+    registerSizes(benchmark::RegisterBenchmark(("mesh/" + name).c_str(),
+                  [op](benchmark::State& st) { meshBench(st, op); }),
+                  maxElements);
+}
+
+void addHulls(long long maxElements) {
+    registerSizes(benchmark::RegisterBenchmark("hull/cube", hullBench, false), maxElements);
+    registerSizes(benchmark::RegisterBenchmark("hull/ball", hullBench, true), maxElements);
+}
+
+void addKMeans(long long maxElements) {
+    // twenty passes over every point per iteration: keep to the smaller sizes
+    const long long m = std::min(maxElements, 1000000LL);
+    for (std::size_t k : {16, 256}) {
+        const std::string suffix = "_k" + std::to_string(k);
+        registerSizes(benchmark::RegisterBenchmark(("kmeans/lloyd" + suffix).c_str(), kMeansBench, k), m);
+        registerSizes(benchmark::RegisterBenchmark(("kmeans/seed" + suffix).c_str(), kMeansSeedBench, k), m);
+    }
+}
+
+void addMeshes(long long maxElements) {
+    addMesh("face_normals", maxElements, [](const TriangleMesh& m, VectorArray& out) { m.faceNormals(out); });
+    addMesh("vertex_normals", maxElements, [](const TriangleMesh& m, VectorArray& out) { m.vertexNormals(out); });
+    addMesh("surface_area", maxElements, [](const TriangleMesh& m, VectorArray&) {
+        benchmark::DoNotOptimize(m.surfaceArea());
+    });
+    addMesh("volume", maxElements, [](const TriangleMesh& m, VectorArray&) {
+        benchmark::DoNotOptimize(m.volume());
+    });
+}
+
+// registers both the per call and the std::vector<Vector> version of op
+template <typename Op>
+void addOp(const std::string& name, std::size_t inputs, long long maxElements, Op op) {
+    addCall(name, op);
+    addAos(name, inputs, maxElements, op);
+}
+
+void registerAll(long long maxElements) {
+    const long long m = maxElements;
+
+    addCall("construct", [](const Vector& a, const Vector&) { return Vector(a.x, a.y, a.z); });
+    addOp("add", 2, m, [](const Vector& a, const Vector& b) { return a + b; });
+    addOp("sub", 2, m, [](const Vector& a, const Vector& b) { return a - b; });
+    addOp("add_assign", 2, m, [](const Vector& a, const Vector& b) { Vector r = a; r += b; return r; });
+    addOp("sub_assign", 2, m, [](const Vector& a, const Vector& b) { Vector r = a; r -= b; return r; });
+    addOp("scale", 1, m, [](const Vector& a, const Vector&) { return a * 2.5; });
+    addOp("scale_left", 1, m, [](const Vector& a, const Vector&) { return 2.5 * a; });
+    addOp("dot", 2, m, [](const Vector& a, const Vector& b) { return a * b; });
+    addOp("cross", 2, m, [](const Vector& a, const Vector& b) { return a.cross(b); });
+    addOp("equal", 2, m, [](const Vector& a, const Vector& b) { return a == b; });
+    addOp("length", 1, m, [](const Vector& a, const Vector&) { return a.length(); });
+    addOp("normalize", 1, m, [](const Vector& a, const Vector&) { Vector r = a; r.normalize(); return r; });
+    addOp("axpy_lazy", 2, m, [](const Vector& a, const Vector& b) {
+        return Vector(lazy(a) + lazy(b) * 2.5 - unitX);
+    });
+
+    const std::size_t v = 3 * sizeof(double);
+    const std::size_t d = sizeof(double);
+    addSoa("add", 3 * v, m, [](const VectorArray& a, const VectorArray& b, VectorArray& out, std::vector<double>&) { add(a, b, out); });
+    addSoa("sub", 3 * v, m, [](const VectorArray& a, const VectorArray& b, VectorArray& out, std::vector<double>&) { sub(a, b, out); });
+    addSoa("scale", 2 * v, m, [](const VectorArray& a, const VectorArray&, VectorArray& out, std::vector<double>&) { scale(a, 2.5, out); });
+    addSoa("dot", 2 * v + d, m, [](const VectorArray& a, const VectorArray& b, VectorArray&, std::vector<double>& s) { dot(a, b, s); });
+    addSoa("cross", 3 * v, m, [](const VectorArray& a, const VectorArray& b, VectorArray& out, std::vector<double>&) { cross(a, b, out); });
+    addSoa("length", v + d, m, [](const VectorArray& a, const VectorArray&, VectorArray&, std::vector<double>& s) { length(a, s); });
+    // copy first so every iteration normalizes the same, non unit, input
+    addSoa("normalize", 2 * v, m, [](const VectorArray& a, const VectorArray&, VectorArray& out, std::vector<double>&) {
+        out = a;
+        normalize(out);
+    });
+    addSoa("axpy_expr", 3 * v, m, [](const VectorArray& a, const VectorArray& b, VectorArray& out, std::vector<double>&) {
+        out = a + 2.5 * b;
+    });
+
+    static const Matrix4 rigid = Matrix4::rigid(Quaternion::fromAxisAngle(Vector{1, 2, 3}, 0.5),
+                                                Vector{1, 2, 3});
+    addCall("transform_point", [](const Vector& a, const Vector&) { return rigid.transformPoint(a); });
+    addSoa("transform_points", 2 * v, m, [](const VectorArray& a, const VectorArray&, VectorArray& out, std::vector<double>&) {
+        transformPoints(rigid, a, out);
+    });
+    addBatch("transform_points", 2 * v, m, [](const std::vector<Vector>& a, std::vector<Vector>& out) {
+        transformPoints(rigid, a.data(), out.data(), a.size());
+    });
+    addBatch("rotate", 2 * v, m, [](const std::vector<Vector>& a, std::vector<Vector>& out) {
+        rotate(Quaternion::fromAxisAngle(Vector{0, 0, 1}, 0.25), a.data(), out.data(), a.size());
+    });
+
+    addBatch("centroid", v, m, [](const std::vector<Vector>& a, std::vector<Vector>&) {
+        benchmark::DoNotOptimize(centroid(a));
+    });
+    addBatch("bounds", v, m, [](const std::vector<Vector>& a, std::vector<Vector>&) {
+        benchmark::DoNotOptimize(bounds(a));
+    });
+    // two passes: centroid, then scatter
+    addBatch("covariance", 2 * v, m, [](const std::vector<Vector>& a, std::vector<Vector>&) {
+        benchmark::DoNotOptimize(covariance(a));
+    });
+
+    addKdTree(m);
+    addQuantize(m);
+    addSpatialGrid(m);
+    addCurves(m);
+    addMeshes(m);
+    addKMeans(m);
+    addHulls(m);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long long maxElements = 100000000;
+    bool haveOut = false;
+
+    // pull out our own flag, pass the rest through to google benchmark
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        const char* flag = "--max_elements=";
+        if (std::strncmp(argv[i], flag, std::strlen(flag)) == 0) {
+            maxElements = std::atoll(argv[i] + std::strlen(flag));
+            continue;
+        }
+        if (std::strncmp(argv[i], "--benchmark_out=", 16) == 0)
+            haveOut = true;
+        args.push_back(argv[i]);
+    }
+    std::string out = "--benchmark_out=vector_bench.json";
+    std::string format = "--benchmark_out_format=json";
+    if (!haveOut) {
+        args.push_back(&out[0]);
+        args.push_back(&format[0]);
+    }
+
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+        return 1;
+
+    registerAll(maxElements);
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,547 @@
+//
+// ConvexHull.cpp
+//
+
+#include "ConvexHull.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "Simd.hpp"
+#include "VectorArray.hpp"
+
+namespace {
+
+const std::uint32_t none = 0xffffffffu;
+
+// points per chunk, for the extremes, the cull and the chunk hulls. Part
+// of which points reach the final hull, so keep it fixed.
+const std::size_t chunkSize = 64 * 1024;
+
+// most points sampled for the extremes
+const std::size_t maxSample = 1 << 20;
+
+const char* const flatMessage = "convexHull needs points which are not all on one plane";
+
+struct Face {
+    std::uint32_t v[3];
+    std::uint32_t adjacent[3];  // face across the edge from v[i] to v[i + 1]
+    Vector normal;              // unit, pointing out
+    double offset;              // normal * p for p on the face's plane
+    std::uint32_t outside;      // first node of the points above the face
+    std::uint32_t furthest;     // node of the point furthest above it
+    double furthestDistance;
+    std::uint32_t visit;
+    bool alive;
+};
+
+// a point in the list of points outside a face
+struct Node {
+    std::uint32_t point, next;
+};
+
+class Quickhull {
+public:
+    Quickhull(VectorSpan points, double epsilon) : points(points), epsilon(epsilon) {}
+
+    // hull of the candidate points. False if they are all on one plane.
+    bool build(const std::vector<std::uint32_t>& candidates);
+
+    // grow the hull built already to take in the candidates as well
+    void extend(const std::vector<std::uint32_t>& candidates);
+
+    const std::vector<Face>& faces() const { return arena; }
+
+    // indices of the hull's vertices, sorted
+    std::vector<std::uint32_t> vertices() const {
+        std::vector<std::uint32_t> out;
+        for (const Face& f : arena)
+            if (f.alive)
+                out.insert(out.end(), f.v, f.v + 3);
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+        return out;
+    }
+
+    std::vector<std::uint32_t> triangles() const {
+        std::vector<std::uint32_t> out;
+        for (const Face& f : arena)
+            if (f.alive)
+                out.insert(out.end(), f.v, f.v + 3);
+        return out;
+    }
+
+private:
+    struct Horizon {
+        std::uint32_t face;
+        int edge;
+    };
+
+    struct Step {
+        std::uint32_t face;
+        int first, done, count;
+    };
+
+    double distance(const Face& f, std::uint32_t p) const { return f.normal * points[p] - f.offset; }
+
+    std::uint32_t newFace(std::uint32_t a, std::uint32_t b, std::uint32_t c);
+
+    // link the node to the first of faces it is above, or drop it
+    void assign(std::uint32_t node, const std::uint32_t* faces, std::size_t count);
+
+    // add the furthest point above face to the hull
+    void grow(std::uint32_t face);
+
+    VectorSpan points;
+    double epsilon;
+    std::vector<Face> arena;
+    std::vector<std::uint32_t> freeFaces;
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> pending;     // faces which may have points outside
+    std::uint32_t stamp = 0;
+
+    // scratch for grow()
+    std::vector<std::uint32_t> visible, created;
+    std::vector<Horizon> horizon;
+    std::vector<Step> stack;
+};
+
+std::uint32_t Quickhull::newFace(std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+    std::uint32_t id;
+    if (freeFaces.empty()) {
+        id = static_cast<std::uint32_t>(arena.size());
+        arena.emplace_back();
+    } else {
+        id = freeFaces.back();
+        freeFaces.pop_back();
+    }
+    Face& f = arena[id];
+    f.v[0] = a;
+    f.v[1] = b;
+    f.v[2] = c;
+    f.adjacent[0] = f.adjacent[1] = f.adjacent[2] = none;
+    const Vector n = (points[b] - points[a]).cross(points[c] - points[a]);
+    const double length = n.length();
+    // a sliver with no usable normal has nothing above it
+    f.normal = length > 0 ? n * (1.0 / length) : Vector(0, 0, 0);
+    f.offset = f.normal * points[a];
+    f.outside = none;
+    f.furthest = none;
+    f.furthestDistance = 0;
+    f.visit = 0;
+    f.alive = true;
+    return id;
+}
+
+void Quickhull::assign(std::uint32_t node, const std::uint32_t* faces, std::size_t count) {
+    const std::uint32_t p = nodes[node].point;
+    for (std::size_t i = 0; i < count; ++i) {
+        Face& f = arena[faces[i]];
+        const double d = distance(f, p);
+        if (d > epsilon) {
+            nodes[node].next = f.outside;
+            f.outside = node;
+            if (d > f.furthestDistance) {
+                f.furthestDistance = d;
+                f.furthest = node;
+            }
+            return;
+        }
+    }
+}
+
+bool Quickhull::build(const std::vector<std::uint32_t>& candidates) {
+    if (candidates.size() < 4)
+        return false;
+
+    // a big tetrahedron to start from: the furthest apart of the extremes
+    // on each axis, the point furthest from the line through them, and the
+    // point furthest from the plane through all three
+    std::uint32_t extreme[6];
+    std::fill(extreme, extreme + 6, candidates[0]);
+    for (std::uint32_t p : candidates) {
+        const double c[3] = {points[p].x, points[p].y, points[p].z};
+        for (int axis = 0; axis < 3; ++axis) {
+            const Vector& lo = points[extreme[2 * axis]];
+            const Vector& hi = points[extreme[2 * axis + 1]];
+            const double l[3] = {lo.x, lo.y, lo.z}, h[3] = {hi.x, hi.y, hi.z};
+            if (c[axis] < l[axis])
+                extreme[2 * axis] = p;
+            if (c[axis] > h[axis])
+                extreme[2 * axis + 1] = p;
+        }
+    }
+    std::uint32_t a = extreme[0], b = extreme[1];
+    double widest = -1;
+    for (int i = 0; i < 6; ++i) {
+        for (int j = i + 1; j < 6; ++j) {
+            const Vector d = points[extreme[j]] - points[extreme[i]];
+            if (d * d > widest) {
+                widest = d * d;
+                a = extreme[i];
+                b = extreme[j];
+            }
+        }
+    }
+    if (std::sqrt(widest) <= epsilon)
+        return false;
+
+    const Vector ab = (points[b] - points[a]) * (1.0 / std::sqrt(widest));
+    std::uint32_t c = a;
+    double furthest = 0;
+    for (std::uint32_t p : candidates) {
+        const Vector offLine = (points[p] - points[a]).cross(ab);
+        if (offLine * offLine > furthest) {
+            furthest = offLine * offLine;
+            c = p;
+        }
+    }
+    if (std::sqrt(furthest) <= epsilon)
+        return false;
+
+    Vector normal = (points[b] - points[a]).cross(points[c] - points[a]);
+    normal = normal * (1.0 / normal.length());
+    std::uint32_t d = a;
+    furthest = 0;
+    for (std::uint32_t p : candidates) {
+        const double offPlane = std::abs(normal * (points[p] - points[a]));
+        if (offPlane > furthest) {
+            furthest = offPlane;
+            d = p;
+        }
+    }
+    if (furthest <= epsilon)
+        return false;
+
+    const std::uint32_t corners[4] = {a, b, c, d};
+    std::uint32_t start[4];
+    for (int i = 0; i < 4; ++i) {
+        // each face leaves out one corner, which must end up below it
+        std::uint32_t v[3], k = 0;
+        for (int j = 0; j < 4; ++j)
+            if (j != i)
+                v[k++] = corners[j];
+        start[i] = newFace(v[0], v[1], v[2]);
+        if (distance(arena[start[i]], corners[i]) > 0) {
+            arena[start[i]].alive = false;
+            freeFaces.push_back(start[i]);
+            start[i] = newFace(v[0], v[2], v[1]);
+        }
+    }
+    for (std::uint32_t f : start) {
+        for (int i = 0; i < 3; ++i) {
+            const std::uint32_t u = arena[f].v[i], w = arena[f].v[(i + 1) % 3];
+            for (std::uint32_t g : start)
+                for (int j = 0; j < 3; ++j)
+                    if (arena[g].v[j] == w && arena[g].v[(j + 1) % 3] == u)
+                        arena[f].adjacent[i] = g;
+        }
+    }
+
+    // the corners themselves are on the faces, and get dropped
+    extend(candidates);
+    return true;
+}
+
+void Quickhull::extend(const std::vector<std::uint32_t>& candidates) {
+    // every list is empty between calls, so the nodes can start over
+    std::vector<std::uint32_t> live;
+    for (std::uint32_t f = 0; f < arena.size(); ++f)
+        if (arena[f].alive)
+            live.push_back(f);
+    nodes.clear();
+    nodes.reserve(candidates.size());
+    for (std::uint32_t p : candidates) {
+        nodes.push_back(Node{p, none});
+        assign(static_cast<std::uint32_t>(nodes.size() - 1), live.data(), live.size());
+    }
+    for (std::uint32_t f : live)
+        if (arena[f].outside != none)
+            pending.push_back(f);
+
+    while (!pending.empty()) {
+        const std::uint32_t f = pending.back();
+        pending.pop_back();
+        if (arena[f].alive && arena[f].outside != none)
+            grow(f);
+    }
+}
+
+void Quickhull::grow(std::uint32_t face) {
+    const std::uint32_t eyeNode = arena[face].furthest;
+    const std::uint32_t eye = nodes[eyeNode].point;
+
+    // the faces the eye can see, found depth first from face. Crossing into
+    // a face and walking its other two edges in order lists the horizon
+    // edges, where a visible face meets a hidden one, in order around it.
+    ++stamp;
+    visible.assign(1, face);
+    horizon.clear();
+    arena[face].visit = stamp;
+    stack.assign(1, Step{face, 0, 0, 3});
+    while (!stack.empty()) {
+        Step& s = stack.back();
+        if (s.done == s.count) {
+            stack.pop_back();
+            continue;
+        }
+        const std::uint32_t from = s.face;
+        const int edge = (s.first + s.done++) % 3;
+        const std::uint32_t g = arena[from].adjacent[edge];
+        if (arena[g].visit == stamp)
+            continue;
+        if (distance(arena[g], eye) > epsilon) {
+            arena[g].visit = stamp;
+            visible.push_back(g);
+            int back = 0;
+            while (arena[g].adjacent[back] != from)
+                ++back;
+            stack.push_back(Step{g, back + 1, 0, 2});
+        } else {
+            horizon.push_back(Horizon{from, edge});
+        }
+    }
+
+    // a fan of faces from the eye to the horizon, each stitched to the
+    // hidden face across its horizon edge and to its neighbours in the fan
+    created.clear();
+    for (const Horizon& h : horizon) {
+        const Face& old = arena[h.face];
+        const std::uint32_t a = old.v[h.edge], b = old.v[(h.edge + 1) % 3];
+        const std::uint32_t hidden = old.adjacent[h.edge];
+        const std::uint32_t f = newFace(a, b, eye);
+        arena[f].adjacent[0] = hidden;
+        for (int j = 0; j < 3; ++j)
+            if (arena[hidden].v[j] == b && arena[hidden].v[(j + 1) % 3] == a)
+                arena[hidden].adjacent[j] = f;
+        created.push_back(f);
+    }
+    const std::size_t m = created.size();
+    for (std::size_t i = 0; i < m; ++i) {
+        arena[created[i]].adjacent[1] = created[(i + 1) % m];
+        arena[created[i]].adjacent[2] = created[(i + m - 1) % m];
+    }
+
+    // hand the points outside the old faces on to the new ones
+    for (std::uint32_t f : visible) {
+        for (std::uint32_t node = arena[f].outside; node != none;) {
+            const std::uint32_t next = nodes[node].next;
+            if (node != eyeNode)
+                assign(node, created.data(), m);
+            node = next;
+        }
+        arena[f].alive = false;
+        arena[f].outside = none;
+        freeFaces.push_back(f);
+    }
+    for (std::uint32_t f : created)
+        if (arena[f].outside != none)
+            pending.push_back(f);
+}
+
+// the 26 directions to the neighbours of a cell in a cubic grid come in 13
+// opposite pairs; one of each
+std::vector<Vector> cullDirections() {
+    std::vector<Vector> out;
+    for (int x = -1; x <= 1; ++x)
+        for (int y = -1; y <= 1; ++y)
+            for (int z = -1; z <= 1; ++z)
+                if (x > 0 || (x == 0 && (y > 0 || (y == 0 && z > 0))))
+                    out.push_back(Vector(x, y, z));
+    return out;
+}
+
+} // namespace
+
+std::vector<std::uint32_t> convexHullIndices(VectorSpan points, ThreadPool& pool) {
+    const std::size_t n = points.size();
+    if (n >= 0xffffffffu)
+        throw std::length_error("convexHull takes at most 2^32 - 1 points");
+    if (n < 4)
+        throw std::invalid_argument(flatMessage);
+
+    // the points furthest along and against each direction, first in each
+    // chunk and then over the chunks, keeping the lowest index on ties.
+    // Within a chunk a point is compared against a Pack of directions at
+    // a time. Any points at all span a polytope inside the hull, so an
+    // evenly spread sample of them is enough.
+    const std::vector<Vector> directions = cullDirections();
+    const std::size_t nd = directions.size();
+    const std::size_t w = simd::Pack::width;
+    const std::size_t packs = (nd + w - 1) / w;
+    std::vector<double> dx(packs * w), dy(packs * w), dz(packs * w);
+    for (std::size_t k = 0; k < nd; ++k) {
+        dx[k] = directions[k].x;
+        dy[k] = directions[k].y;
+        dz[k] = directions[k].z;
+    }
+    const std::size_t stride = std::max<std::size_t>(1, n / maxSample);
+    const std::size_t sampled = (n + stride - 1) / stride;
+    const std::size_t sampleChunks = (sampled + chunkSize - 1) / chunkSize;
+    std::vector<double> highest(sampleChunks * packs * w), lowest(sampleChunks * packs * w);
+    pool.parallelFor(sampleChunks, 1, [&](std::size_t begin, std::size_t end) {
+        using namespace simd;
+        const double inf = std::numeric_limits<double>::infinity();
+        const std::size_t maxPacks = 16;
+        Pack hi[maxPacks], lo[maxPacks], hiAt[maxPacks], loAt[maxPacks];
+        for (std::size_t c = begin; c < end; ++c) {
+            for (std::size_t k = 0; k < packs; ++k) {
+                hi[k] = broadcast(-inf);
+                lo[k] = broadcast(inf);
+                hiAt[k] = loAt[k] = broadcast(0.0);
+            }
+            for (std::size_t j = c * chunkSize, e = std::min(sampled, j + chunkSize); j < e; ++j) {
+                const std::size_t i = j * stride;
+                const Pack px = broadcast(points[i].x), py = broadcast(points[i].y), pz = broadcast(points[i].z);
+                const Pack at = broadcast(static_cast<double>(i));
+                for (std::size_t k = 0; k < packs; ++k) {
+                    const Pack d = load(&dx[k * w]) * px + load(&dy[k * w]) * py + load(&dz[k * w]) * pz;
+                    const Pack up = less(hi[k], d), down = less(d, lo[k]);
+                    hi[k] = select(up, d, hi[k]);
+                    hiAt[k] = select(up, at, hiAt[k]);
+                    lo[k] = select(down, d, lo[k]);
+                    loAt[k] = select(down, at, loAt[k]);
+                }
+            }
+            for (std::size_t k = 0; k < packs; ++k) {
+                store(&highest[(c * packs + k) * w], hiAt[k]);
+                store(&lowest[(c * packs + k) * w], loAt[k]);
+            }
+        }
+    });
+    std::vector<std::uint32_t> extremes;
+    for (std::size_t k = 0; k < nd; ++k) {
+        const std::size_t stride = packs * w;
+        std::uint32_t hi = static_cast<std::uint32_t>(highest[k]), lo = static_cast<std::uint32_t>(lowest[k]);
+        for (std::size_t c = 1; c < sampleChunks; ++c) {
+            const std::uint32_t h = static_cast<std::uint32_t>(highest[c * stride + k]);
+            const std::uint32_t l = static_cast<std::uint32_t>(lowest[c * stride + k]);
+            if (directions[k] * points[h] > directions[k] * points[hi])
+                hi = h;
+            if (directions[k] * points[l] < directions[k] * points[lo])
+                lo = l;
+        }
+        extremes.push_back(hi);
+        extremes.push_back(lo);
+    }
+
+    // the tolerance for "on a face" grows with the coordinates, as in
+    // Lloyd's quickhull3d ( which takes them from the extremes of every
+    // point; the sample's are near enough )
+    double scale = 0;
+    for (std::uint32_t e : extremes) {
+        const Vector& p = points[e];
+        scale = std::max(scale, std::abs(p.x) + std::abs(p.y) + std::abs(p.z));
+    }
+    const double epsilon = 3 * std::numeric_limits<double>::epsilon() * scale;
+
+    const std::size_t chunks = (n + chunkSize - 1) / chunkSize;
+    std::sort(extremes.begin(), extremes.end());
+    extremes.erase(std::unique(extremes.begin(), extremes.end()), extremes.end());
+    Quickhull inner(points, epsilon);
+    const bool cull = inner.build(extremes);
+
+    // the inner polytope's planes, padded to whole Packs with planes
+    // nothing is above, and a ball inside it to rule out most points with
+    // a single test
+    std::vector<double> nx, ny, nz, offset;
+    Vector middle(0, 0, 0);
+    double inside = 0;
+    if (cull) {
+        const std::vector<std::uint32_t> corners = inner.vertices();
+        for (std::uint32_t v : corners)
+            middle += points[v];
+        middle = middle * (1.0 / corners.size());
+        double radius = std::numeric_limits<double>::infinity();
+        for (const Face& f : inner.faces()) {
+            if (f.alive) {
+                nx.push_back(f.normal.x);
+                ny.push_back(f.normal.y);
+                nz.push_back(f.normal.z);
+                offset.push_back(f.offset);
+                radius = std::min(radius, f.offset - f.normal * middle);
+            }
+        }
+        radius -= epsilon;
+        inside = radius > 0 ? radius * radius : 0;
+        while (nx.size() % w != 0) {
+            nx.push_back(0);
+            ny.push_back(0);
+            nz.push_back(0);
+            offset.push_back(std::numeric_limits<double>::infinity());
+        }
+    }
+
+    // drop the points inside the polytope, then hull what is left of each
+    // chunk and keep only its vertices
+    std::vector<std::vector<std::uint32_t>> kept(chunks);
+    pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        using namespace simd;
+        for (std::size_t c = begin; c < end; ++c) {
+            std::vector<std::uint32_t>& survivors = kept[c];
+            for (std::size_t i = c * chunkSize, e = std::min(n, i + chunkSize); i < e; ++i) {
+                if (cull) {
+                    const Vector fromMiddle = points[i] - middle;
+                    if (fromMiddle * fromMiddle < inside)
+                        continue;
+                    const Pack px = broadcast(points[i].x), py = broadcast(points[i].y),
+                               pz = broadcast(points[i].z);
+                    Pack above = broadcast(-std::numeric_limits<double>::infinity());
+                    for (std::size_t f = 0; f < nx.size(); f += w)
+                        above = max(above, load(&nx[f]) * px + load(&ny[f]) * py + load(&nz[f]) * pz
+                                           - load(&offset[f]));
+                    double lanes[w];
+                    store(lanes, above);
+                    if (*std::max_element(lanes, lanes + w) <= epsilon)
+                        continue;
+                }
+                survivors.push_back(static_cast<std::uint32_t>(i));
+            }
+            // starting from the polytope saves sorting most points into a
+            // tetrahedron's faces only to move them again
+            if (survivors.empty())
+                continue;
+            if (cull) {
+                Quickhull chunkHull(inner);
+                chunkHull.extend(survivors);
+                survivors = chunkHull.vertices();
+            } else {
+                Quickhull chunkHull(points, epsilon);
+                if (chunkHull.build(survivors))
+                    survivors = chunkHull.vertices();
+            }
+        }
+    });
+
+    std::vector<std::uint32_t> candidates;
+    for (const auto& survivors : kept)
+        candidates.insert(candidates.end(), survivors.begin(), survivors.end());
+    if (cull) {
+        inner.extend(candidates);
+        return inner.triangles();
+    }
+    Quickhull hull(points, epsilon);
+    if (!hull.build(candidates))
+        throw std::invalid_argument(flatMessage);
+    return hull.triangles();
+}
+
+TriangleMesh convexHull(VectorSpan points, ThreadPool& pool) {
+    std::vector<std::uint32_t> indices = convexHullIndices(points, pool);
+    std::vector<std::uint32_t> used(indices);
+    std::sort(used.begin(), used.end());
+    used.erase(std::unique(used.begin(), used.end()), used.end());
+
+    VectorArray vertices(used.size());
+    for (std::size_t i = 0; i < used.size(); ++i) {
+        vertices.x()[i] = points[used[i]].x;
+        vertices.y()[i] = points[used[i]].y;
+        vertices.z()[i] = points[used[i]].z;
+    }
+    for (std::uint32_t& index : indices)
+        index = static_cast<std::uint32_t>(std::lower_bound(used.begin(), used.end(), index) - used.begin());
+    return TriangleMesh(std::move(vertices), std::move(indices), pool);
+}
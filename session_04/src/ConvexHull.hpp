@@ -0,0 +1,38 @@
+//
+// ConvexHull.hpp
+//
+// 3D convex hull by quickhull.
+//
+// Most points of a big cloud are nowhere near the hull, so they are thrown
+// away first, in parallel: the extreme points in 26 directions ( of an
+// evenly spread sample ) span a polytope inside the hull, and any point
+// below all of its faces cannot be on the hull. The survivors are hulled a
+// chunk at a time, in parallel, growing copies of the polytope, and only
+// the vertices of those hulls go into the final quickhull.
+//
+// The quickhull itself keeps its faces in an arena, reusing the slots of
+// faces it deletes, and links the points outside each face into lists
+// whose nodes move from face to face without allocating.
+//
+// Points within a small tolerance of a face ( relative to the size of the
+// coordinates ) count as on it, so nearly coplanar points do not become
+// vertices. Chunks are fixed, so the hull is the same on any ThreadPool.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "TriangleMesh.hpp"
+#include "VectorSpan.hpp"
+
+// triangles of the hull, 3 indices into points each, wound counter
+// clockwise seen from outside. Throws std::invalid_argument if the points
+// are all on one plane ( including fewer than 4 points ). Points must be
+// finite.
+std::vector<std::uint32_t> convexHullIndices(VectorSpan points, ThreadPool& pool = ThreadPool::global());
+
+// the hull as a closed mesh holding only the points on it, in the order
+// they come in points
+TriangleMesh convexHull(VectorSpan points, ThreadPool& pool = ThreadPool::global());
@@ -0,0 +1,336 @@
+//
+// KMeans.cpp
+//
+
+#include "KMeans.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include "Simd.hpp"
+
+namespace {
+
+const double inf = std::numeric_limits<double>::infinity();
+
+// points per parallelFor chunk in the assignment step
+const std::size_t pointGrain = 16 * 1024;
+
+// centers per parallelFor chunk
+const std::size_t centerGrain = 16;
+
+// sums are taken over fixed chunks of at least minChunk points, and at most
+// maxChunks of them, so the per chunk partial sums stay small for big k
+const std::size_t minChunk = 16 * 1024;
+const std::size_t maxChunks = 256;
+
+std::size_t chunkSizeFor(std::size_t n) {
+    return std::max(minChunk, (n + maxChunks - 1) / maxChunks);
+}
+
+// uniform double in [0, 1) from the top 53 bits
+double unit(std::mt19937_64& rng) {
+    return (rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// the centers as three coordinate streams plus their indices, padded to a
+// whole number of Packs with centers infinitely far away
+struct CenterStreams {
+    std::vector<double> x, y, z, index;
+
+    void assign(const std::vector<Vector>& centers) {
+        const std::size_t w = simd::Pack::width;
+        const std::size_t padded = (centers.size() + w - 1) / w * w;
+        x.assign(padded, inf);
+        y.assign(padded, inf);
+        z.assign(padded, inf);
+        index.assign(padded, 0.0);
+        for (std::size_t j = 0; j < centers.size(); ++j) {
+            x[j] = centers[j].x;
+            y[j] = centers[j].y;
+            z[j] = centers[j].z;
+            index[j] = static_cast<double>(j);
+        }
+    }
+};
+
+// closest center to a point, and the squared distances to the closest and
+// second closest. Ties go to the lower index.
+struct Nearest {
+    std::uint32_t index;
+    double d1, d2;
+};
+
+Nearest nearestTwo(const CenterStreams& c, const Vector& p) {
+    using namespace simd;
+    const std::size_t w = Pack::width;
+    const Pack px = broadcast(p.x), py = broadcast(p.y), pz = broadcast(p.z);
+    Pack best1 = broadcast(inf), best2 = broadcast(inf), best = broadcast(0.0);
+    // each lane keeps its own two best, over every w-th center
+    for (std::size_t j = 0; j < c.x.size(); j += w) {
+        const Pack dx = load(&c.x[j]) - px;
+        const Pack dy = load(&c.y[j]) - py;
+        const Pack dz = load(&c.z[j]) - pz;
+        const Pack d = dx * dx + dy * dy + dz * dz;
+        const Pack closer = less(d, best1);
+        best2 = select(closer, best1, min(best2, d));
+        best = select(closer, load(&c.index[j]), best);
+        best1 = select(closer, d, best1);
+    }
+
+    double b1[w], b2[w], id[w];
+    store(b1, best1);
+    store(b2, best2);
+    store(id, best);
+    Nearest r{static_cast<std::uint32_t>(id[0]), b1[0], b2[0]};
+    for (std::size_t l = 1; l < w; ++l) {
+        if (b1[l] < r.d1 || (b1[l] == r.d1 && id[l] < r.index)) {
+            r.d2 = std::min(r.d1, b2[l]);
+            r.d1 = b1[l];
+            r.index = static_cast<std::uint32_t>(id[l]);
+        } else {
+            r.d2 = std::min(r.d2, b1[l]);
+        }
+    }
+    return r;
+}
+
+} // namespace
+
+std::vector<Vector> kMeansPlusPlus(VectorSpan points, std::size_t k, std::uint64_t seed, ThreadPool& pool) {
+    const std::size_t n = points.size();
+    if (k == 0 || k > n)
+        throw std::invalid_argument("kMeansPlusPlus needs between 1 and points.size() centers");
+
+    std::mt19937_64 rng(seed);
+    std::vector<Vector> centers;
+    centers.reserve(k);
+    centers.push_back(points[rng() % n]);
+
+    // d2[i] = squared distance from point i to the nearest center so far
+    const std::size_t chunk = chunkSizeFor(n);
+    const std::size_t chunks = (n + chunk - 1) / chunk;
+    std::vector<double> d2(n, inf), chunkSum(chunks);
+    auto update = [&](const Vector& center) {
+        pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                double sum = 0;
+                for (std::size_t i = c * chunk, e = std::min(n, i + chunk); i < e; ++i) {
+                    const Vector d = points[i] - center;
+                    d2[i] = std::min(d2[i], d * d);
+                    sum += d2[i];
+                }
+                chunkSum[c] = sum;
+            }
+        });
+    };
+    update(centers[0]);
+
+    while (centers.size() < k) {
+        double total = 0;
+        for (double s : chunkSum)
+            total += s;
+        if (!(total > 0)) {
+            // every point sits on a center already
+            centers.push_back(points[rng() % n]);
+            continue;
+        }
+
+        // walk to the chunk, then the point, where the running sum passes
+        // target, never stopping on a point with no weight
+        double target = unit(rng) * total;
+        std::size_t c = 0, lastWeighted = 0;
+        for (; c + 1 < chunks; ++c) {
+            if (chunkSum[c] > 0) {
+                lastWeighted = c;
+                if (target < chunkSum[c])
+                    break;
+            }
+            target -= chunkSum[c];
+        }
+        if (!(chunkSum[c] > 0))
+            c = lastWeighted;
+        std::size_t pick = c * chunk;
+        for (std::size_t i = c * chunk, e = std::min(n, i + chunk); i < e; ++i) {
+            if (d2[i] > 0) {
+                pick = i;
+                if (target < d2[i])
+                    break;
+                target -= d2[i];
+            }
+        }
+        centers.push_back(points[pick]);
+        update(centers.back());
+    }
+    return centers;
+}
+
+KMeansResult kMeans(VectorSpan points, std::size_t k, const KMeansOptions& options, ThreadPool& pool) {
+    const std::size_t n = points.size();
+    if (k == 0 || k > n)
+        throw std::invalid_argument("kMeans needs between 1 and points.size() centers");
+    if (options.seedSample == 0 || n <= std::max(options.seedSample, k))
+        return kMeans(points, kMeansPlusPlus(points, k, options.seed, pool), options, pool);
+
+    // seed from a random sample, drawn with replacement
+    std::mt19937_64 rng(options.seed ^ 0x9e3779b97f4a7c15ull);
+    std::vector<Vector> sample(std::max(options.seedSample, k));
+    for (Vector& s : sample)
+        s = points[rng() % n];
+    return kMeans(points, kMeansPlusPlus(sample, k, options.seed, pool), options, pool);
+}
+
+KMeansResult kMeans(VectorSpan points, std::vector<Vector> centers, const KMeansOptions& options,
+                    ThreadPool& pool) {
+    const std::size_t n = points.size(), k = centers.size();
+    if (k == 0 || k > n)
+        throw std::invalid_argument("kMeans needs between 1 and points.size() centers");
+    if (n >= 0xffffffffu)
+        throw std::length_error("kMeans takes at most 2^32 - 1 points");
+
+    KMeansResult result;
+    result.labels.assign(n, 0);
+    result.iterations = 0;
+    result.converged = false;
+    result.distances = 0;
+    std::vector<std::uint32_t>& labels = result.labels;
+
+    // Hamerly's bounds: upper on the distance to the point's own center,
+    // lower on the distance to any other. The first pass scans everything.
+    std::vector<double> upper(n, inf), lower(n, 0.0);
+    std::vector<double> half(k), moved(k);
+    CenterStreams streams;
+
+    const std::size_t chunk = chunkSizeFor(n);
+    const std::size_t chunks = (n + chunk - 1) / chunk;
+    std::vector<double> partial(chunks * k * 4);   // x, y, z and count per chunk and center
+
+    for (std::size_t iteration = 0; iteration < options.maxIterations; ++iteration) {
+        streams.assign(centers);
+
+        // a point closer to its center than half the distance from that
+        // center to any other cannot be closer to another
+        pool.parallelFor(k, centerGrain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; ++j) {
+                double closest = inf;
+                for (std::size_t o = 0; o < k; ++o) {
+                    if (o != j) {
+                        const Vector d = centers[o] - centers[j];
+                        closest = std::min(closest, d * d);
+                    }
+                }
+                half[j] = 0.5 * std::sqrt(closest);
+            }
+        });
+
+        std::atomic<std::uint64_t> changed{0}, computed{0};
+        pool.parallelFor(n, pointGrain, [&](std::size_t begin, std::size_t end) {
+            std::uint64_t localChanged = 0, localComputed = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                const std::uint32_t a = labels[i];
+                const double bound = std::max(half[a], lower[i]);
+                if (upper[i] <= bound)
+                    continue;
+                // tighten the upper bound, and try again
+                upper[i] = (points[i] - centers[a]).length();
+                ++localComputed;
+                if (upper[i] <= bound)
+                    continue;
+                const Nearest nearest = nearestTwo(streams, points[i]);
+                localComputed += k;
+                if (nearest.index != a) {
+                    labels[i] = nearest.index;
+                    ++localChanged;
+                }
+                upper[i] = std::sqrt(nearest.d1);
+                lower[i] = std::sqrt(nearest.d2);
+            }
+            changed += localChanged;
+            computed += localComputed;
+        });
+        result.distances += computed;
+        result.iterations = iteration + 1;
+
+        // the labels are final once nothing moves; they are also left
+        // matching the centers when the iterations run out
+        if (iteration > 0 && changed == 0) {
+            result.converged = true;
+            break;
+        }
+        if (iteration + 1 == options.maxIterations)
+            break;
+
+        // new centers: per chunk sums, added up in chunk order
+        pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                double* sums = &partial[c * k * 4];
+                std::fill(sums, sums + k * 4, 0.0);
+                for (std::size_t i = c * chunk, e = std::min(n, i + chunk); i < e; ++i) {
+                    double* s = sums + labels[i] * 4;
+                    s[0] += points[i].x;
+                    s[1] += points[i].y;
+                    s[2] += points[i].z;
+                    s[3] += 1;
+                }
+            }
+        });
+        pool.parallelFor(k, centerGrain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; ++j) {
+                double x = 0, y = 0, z = 0, count = 0;
+                for (std::size_t c = 0; c < chunks; ++c) {
+                    const double* s = &partial[(c * k + j) * 4];
+                    x += s[0];
+                    y += s[1];
+                    z += s[2];
+                    count += s[3];
+                }
+                if (count == 0) {
+                    moved[j] = 0;
+                    continue;
+                }
+                const Vector next = Vector(x, y, z) * (1.0 / count);
+                moved[j] = (next - centers[j]).length();
+                centers[j] = next;
+            }
+        });
+
+        // widen the bounds by how far the centers moved. Every other center
+        // moved at most the furthest any did, or the second furthest for
+        // points of the furthest one.
+        std::size_t furthest = 0;
+        for (std::size_t j = 1; j < k; ++j)
+            if (moved[j] > moved[furthest])
+                furthest = j;
+        double second = 0;
+        for (std::size_t j = 0; j < k; ++j)
+            if (j != furthest)
+                second = std::max(second, moved[j]);
+        pool.parallelFor(n, pointGrain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                upper[i] += moved[labels[i]];
+                lower[i] -= labels[i] == furthest ? second : moved[furthest];
+            }
+        });
+    }
+
+    std::vector<double> chunkInertia(chunks);
+    pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            double sum = 0;
+            for (std::size_t i = c * chunk, e = std::min(n, i + chunk); i < e; ++i) {
+                const Vector d = points[i] - centers[labels[i]];
+                sum += d * d;
+            }
+            chunkInertia[c] = sum;
+        }
+    });
+    result.inertia = 0;
+    for (double s : chunkInertia)
+        result.inertia += s;
+    result.centers = std::move(centers);
+    return result;
+}
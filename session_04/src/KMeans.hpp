@@ -0,0 +1,64 @@
+//
+// KMeans.hpp
+//
+// k-means clustering of a set of Vectors: k-means++ seeding followed by
+// Lloyd iterations, with Hamerly's bounds to skip most of the distance
+// computations once the centers settle down.
+//
+// Hamerly keeps two bounds per point, an upper bound on the distance to its
+// own center and a lower bound on the distance to every other one. A point
+// whose bounds are still separated after the centers move cannot have
+// changed cluster and is not looked at again. ( Elkan's algorithm prunes
+// harder but keeps k bounds per point, which does not fit 100M points with
+// k in the hundreds. ) Points which do need a full scan compare against all
+// the centers a SIMD register at a time.
+//
+// The pruning is exact: the result is the same as plain Lloyd iterations
+// from the same seeds. Everything is split into fixed size chunks, so the
+// result is also the same on any ThreadPool.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+#include "VectorSpan.hpp"
+
+struct KMeansOptions {
+    // stop after this many iterations even if points are still moving
+    std::size_t maxIterations = 100;
+    // seeding draws from this many points picked at random, or from every
+    // point if there are fewer. Each of the k seeding rounds is a pass over
+    // them. 0 means every point.
+    std::size_t seedSample = 1 << 20;
+    std::uint64_t seed = 1;
+};
+
+struct KMeansResult {
+    std::vector<Vector> centers;
+    std::vector<std::uint32_t> labels;      // center of each point
+    double inertia;                         // sum of squared distances to the centers
+    std::size_t iterations;
+    bool converged;                         // the last iteration moved no point
+    std::uint64_t distances;                // point to center distances computed
+};
+
+// k-means++ seeds: the first center is a random point, and each following
+// one is a point picked with probability proportional to its squared
+// distance from the centers so far
+std::vector<Vector> kMeansPlusPlus(VectorSpan points, std::size_t k, std::uint64_t seed = 1,
+                                   ThreadPool& pool = ThreadPool::global());
+
+// cluster points around k centers. A cluster which loses all its points
+// keeps its old center. Throws std::invalid_argument if k is 0 or larger
+// than the number of points. Points must be finite.
+KMeansResult kMeans(VectorSpan points, std::size_t k, const KMeansOptions& options = KMeansOptions(),
+                    ThreadPool& pool = ThreadPool::global());
+
+// as kMeans, but starting from the given centers instead of seeding
+KMeansResult kMeans(VectorSpan points, std::vector<Vector> centers,
+                    const KMeansOptions& options = KMeansOptions(),
+                    ThreadPool& pool = ThreadPool::global());
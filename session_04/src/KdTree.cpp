@@ -0,0 +1,262 @@
+//
+// KdTree.cpp
+//
+
+#include "KdTree.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// subtrees bigger than this are built as separate parallelFor chunks
+const std::size_t parallelBuildSize = 64 * 1024;
+
+// queries per parallelFor chunk
+const std::size_t queryGrain = 256;
+
+// enough for any tree with 2^64 points
+const int maxDepth = 64;
+
+struct Item {
+    double c[3];
+    std::uint32_t id;
+};
+
+inline double component(const Vector& v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+// the axis along which items[begin, end) are most spread out
+int widestAxis(const Item* items, std::size_t begin, std::size_t end) {
+    double lo[3], hi[3];
+    for (int a = 0; a < 3; ++a)
+        lo[a] = hi[a] = items[begin].c[a];
+    for (std::size_t i = begin + 1; i < end; ++i) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], items[i].c[a]);
+            hi[a] = std::max(hi[a], items[i].c[a]);
+        }
+    }
+    int axis = 0;
+    for (int a = 1; a < 3; ++a)
+        if (hi[a] - lo[a] > hi[axis] - lo[axis])
+            axis = a;
+    return axis;
+}
+
+} // namespace
+
+//
+// Best keeps the candidates found so far. With a finite k it holds at most k
+// entries in sorted order; for radius queries k is unbounded and the result
+// is only sorted at the end.
+//
+class KdTree::Best {
+public:
+    Best(std::size_t k_, double bound_) : k(k_), initialBound(bound_) {
+        if (k != unbounded)
+            items.reserve(k);
+    }
+
+    static const std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+
+    // anything further away than this cannot make it in
+    double bound() const {
+        return items.size() < k ? initialBound : items.back().distanceSquared;
+    }
+
+    void consider(std::uint32_t index, double d2) {
+        if (d2 > bound())
+            return;
+        if (k == unbounded) {
+            items.push_back(Neighbour{index, d2});
+            return;
+        }
+        if (items.size() == k) {
+            if (d2 == items.back().distanceSquared)
+                return;
+            items.pop_back();
+        }
+        auto at = std::upper_bound(items.begin(), items.end(), d2,
+                                   [](double d, const Neighbour& n) { return d < n.distanceSquared; });
+        items.insert(at, Neighbour{index, d2});
+    }
+
+    std::vector<Neighbour> take() {
+        if (k == unbounded)
+            std::sort(items.begin(), items.end(), [](const Neighbour& a, const Neighbour& b) {
+                return a.distanceSquared < b.distanceSquared ||
+                       (a.distanceSquared == b.distanceSquared && a.index < b.index);
+            });
+        return std::move(items);
+    }
+
+private:
+    std::size_t k;
+    double initialBound;
+    std::vector<Neighbour> items;
+};
+
+const std::uint32_t KdTree::none;
+
+KdTree::KdTree() {}
+
+KdTree::KdTree(const std::vector<Vector>& points, ThreadPool& pool, std::size_t leafSize) :
+    KdTree(points.data(), points.size(), pool, leafSize)
+{}
+
+KdTree::KdTree(const Vector* points, std::size_t n, ThreadPool& pool, std::size_t leafSize) {
+    if (n >= none)
+        throw std::length_error("KdTree holds at most 2^32 - 1 points");
+    if (n == 0)
+        return;
+    leafSize = std::max<std::size_t>(leafSize, 1);
+
+    // depth at which every leaf holds at most leafSize points
+    int depth = 0;
+    while (((n - 1) >> depth) + 1 > leafSize)
+        ++depth;
+    nodes.resize((std::size_t(2) << depth) - 1);
+
+    std::vector<Item> items(n);
+    pool.parallelFor(n, parallelBuildSize, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            items[i] = Item{{points[i].x, points[i].y, points[i].z}, static_cast<std::uint32_t>(i)};
+    });
+
+    // split at the median along the widest axis, then recurse. The two
+    // halves of a big subtree are built as separate chunks.
+    std::function<void(std::size_t, std::size_t, std::size_t, int)> build =
+            [&](std::size_t node, std::size_t begin, std::size_t end, int level) {
+        if (level == depth) {
+            nodes[node] = Node{0.0, -1};
+            return;
+        }
+        const int axis = widestAxis(items.data(), begin, end);
+        const std::size_t mid = begin + (end - begin) / 2;
+        std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+                         [axis](const Item& a, const Item& b) { return a.c[axis] < b.c[axis]; });
+        nodes[node] = Node{items[mid].c[axis], axis};
+
+        if (end - begin > parallelBuildSize) {
+            pool.parallelFor(2, 1, [&](std::size_t child, std::size_t) {
+                if (child == 0)
+                    build(2 * node + 1, begin, mid, level + 1);
+                else
+                    build(2 * node + 2, mid, end, level + 1);
+            });
+        } else {
+            build(2 * node + 1, begin, mid, level + 1);
+            build(2 * node + 2, mid, end, level + 1);
+        }
+    };
+    build(0, 0, n, 0);
+
+    xs.resize(n);
+    ys.resize(n);
+    zs.resize(n);
+    ids.resize(n);
+    pool.parallelFor(n, parallelBuildSize, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            xs[i] = items[i].c[0];
+            ys[i] = items[i].c[1];
+            zs[i] = items[i].c[2];
+            ids[i] = items[i].id;
+        }
+    });
+}
+
+void KdTree::search(const Vector& q, Best& best) const {
+    if (empty())
+        return;
+
+    // subtrees still to visit, with a lower bound on their distance to q
+    struct Pending {
+        std::size_t node, begin, end;
+        double d2;
+    };
+    Pending stack[maxDepth + 1];
+    int top = 0;
+    stack[top++] = Pending{0, 0, size(), 0.0};
+
+    while (top > 0) {
+        Pending p = stack[--top];
+        if (p.d2 > best.bound())
+            continue;
+
+        // walk down to the leaf containing q, leaving the far sides behind
+        std::size_t node = p.node, begin = p.begin, end = p.end;
+        while (nodes[node].axis >= 0) {
+            const Node& n = nodes[node];
+            const std::size_t mid = begin + (end - begin) / 2;
+            const double diff = component(q, n.axis) - n.split;
+            if (diff < 0) {
+                stack[top++] = Pending{2 * node + 2, mid, end, diff * diff};
+                node = 2 * node + 1;
+                end = mid;
+            } else {
+                stack[top++] = Pending{2 * node + 1, begin, mid, diff * diff};
+                node = 2 * node + 2;
+                begin = mid;
+            }
+        }
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const double dx = xs[i] - q.x, dy = ys[i] - q.y, dz = zs[i] - q.z;
+            best.consider(ids[i], dx * dx + dy * dy + dz * dz);
+        }
+    }
+}
+
+KdTree::Neighbour KdTree::nearest(const Vector& q) const {
+    Best best(1, std::numeric_limits<double>::infinity());
+    search(q, best);
+    auto found = best.take();
+    return found.empty() ? Neighbour{none, std::numeric_limits<double>::infinity()} : found[0];
+}
+
+std::vector<KdTree::Neighbour> KdTree::kNearest(const Vector& q, std::size_t k) const {
+    if (k == 0)
+        return {};
+    Best best(std::min(k, size()), std::numeric_limits<double>::infinity());
+    search(q, best);
+    return best.take();
+}
+
+std::vector<KdTree::Neighbour> KdTree::withinRadius(const Vector& q, double radius) const {
+    Best best(Best::unbounded, radius * radius);
+    search(q, best);
+    return best.take();
+}
+
+void KdTree::nearest(const Vector* queries, std::size_t n, std::vector<Neighbour>& out,
+                     ThreadPool& pool) const {
+    out.resize(n);
+    pool.parallelFor(n, queryGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            out[i] = nearest(queries[i]);
+    });
+}
+
+void KdTree::kNearest(const Vector* queries, std::size_t n, std::size_t k, std::vector<Neighbour>& out,
+                      ThreadPool& pool) const {
+    out.assign(n * k, Neighbour{none, std::numeric_limits<double>::infinity()});
+    pool.parallelFor(n, queryGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            auto found = kNearest(queries[i], k);
+            std::copy(found.begin(), found.end(), out.begin() + i * k);
+        }
+    });
+}
+
+void KdTree::withinRadius(const Vector* queries, std::size_t n, double radius,
+                          std::vector<std::vector<Neighbour>>& out, ThreadPool& pool) const {
+    out.resize(n);
+    pool.parallelFor(n, queryGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            out[i] = withinRadius(queries[i], radius);
+    });
+}
@@ -0,0 +1,83 @@
+//
+// KdTree.hpp
+//
+// Static k-d tree over a set of Vectors for nearest neighbour, k nearest
+// and radius queries.
+//
+// The tree is balanced ( every split is at the median ) and stored as a
+// flat array in heap order: the children of node i are 2i+1 and 2i+2, so
+// there are no child pointers and each node is just a split plane. The
+// points are copied into tree order as three coordinate streams, so each
+// leaf is a short contiguous run. Query results refer to points by their
+// index in the input the tree was built from.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+
+class KdTree {
+public:
+    struct Neighbour {
+        std::uint32_t index;        // position in the input points
+        double distanceSquared;
+    };
+
+    // index of a Neighbour slot with nothing in it ( fewer than k points )
+    static const std::uint32_t none = 0xffffffffu;
+
+    KdTree();
+    // builds in parallel on pool. Leaves hold at most leafSize points.
+    KdTree(const Vector* points, std::size_t n,
+           ThreadPool& pool = ThreadPool::global(), std::size_t leafSize = 16);
+    KdTree(const std::vector<Vector>& points,
+           ThreadPool& pool = ThreadPool::global(), std::size_t leafSize = 16);
+
+    std::size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+
+    // closest point to q. index is none if the tree is empty.
+    Neighbour nearest(const Vector& q) const;
+
+    // up to k closest points to q, closest first
+    std::vector<Neighbour> kNearest(const Vector& q, std::size_t k) const;
+
+    // every point within radius of q, closest first
+    std::vector<Neighbour> withinRadius(const Vector& q, double radius) const;
+
+    //
+    // batched queries, spread over pool
+    //
+
+    // out[i] = nearest(queries[i])
+    void nearest(const Vector* queries, std::size_t n, std::vector<Neighbour>& out,
+                 ThreadPool& pool = ThreadPool::global()) const;
+
+    // out[i * k .. i * k + k) = kNearest(queries[i], k), padded with none
+    void kNearest(const Vector* queries, std::size_t n, std::size_t k, std::vector<Neighbour>& out,
+                  ThreadPool& pool = ThreadPool::global()) const;
+
+    // out[i] = withinRadius(queries[i], radius)
+    void withinRadius(const Vector* queries, std::size_t n, double radius,
+                      std::vector<std::vector<Neighbour>>& out,
+                      ThreadPool& pool = ThreadPool::global()) const;
+
+private:
+    struct Node {
+        double split;
+        int axis;                   // 0, 1, 2 or -1 for a leaf
+    };
+
+    // sorted, bounded list of the best candidates seen so far
+    class Best;
+
+    void search(const Vector& q, Best& best) const;
+
+    std::vector<Node> nodes;
+    std::vector<double> xs, ys, zs;     // points in tree order
+    std::vector<std::uint32_t> ids;     // input index of each point in tree order
+};
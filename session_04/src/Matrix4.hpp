@@ -0,0 +1,104 @@
+//
+// Matrix4.hpp
+//
+// Row major 4x4 affine transform. Points are treated as column vectors with
+// w = 1 ( translation applies ), directions with w = 0 ( it does not ).
+// Batch versions of transformPoint / transformDirection live in
+// Transform.hpp.
+//
+#pragma once
+
+#include "Quaternion.hpp"
+#include "Vector.hpp"
+
+struct Matrix4 {
+    double m[4][4];
+
+    // identity
+    Matrix4() : Matrix4(1, 0, 0, 0,
+                        0, 1, 0, 0,
+                        0, 0, 1, 0,
+                        0, 0, 0, 1) {}
+
+    Matrix4(double m00, double m01, double m02, double m03,
+            double m10, double m11, double m12, double m13,
+            double m20, double m21, double m22, double m23,
+            double m30, double m31, double m32, double m33) :
+        m{ {m00, m01, m02, m03},
+           {m10, m11, m12, m13},
+           {m20, m21, m22, m23},
+           {m30, m31, m32, m33} }
+    {}
+
+    static Matrix4 translation(const Vector& t) {
+        return Matrix4(1, 0, 0, t.x,
+                       0, 1, 0, t.y,
+                       0, 0, 1, t.z,
+                       0, 0, 0, 1);
+    }
+
+    static Matrix4 scaling(const Vector& s) {
+        return Matrix4(s.x, 0,   0,   0,
+                       0,   s.y, 0,   0,
+                       0,   0,   s.z, 0,
+                       0,   0,   0,   1);
+    }
+
+    // rotation matrix for a unit quaternion
+    static Matrix4 rotation(const Quaternion& q) {
+        const double xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        const double xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        const double wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+        return Matrix4(1 - 2 * (yy + zz), 2 * (xy - wz),     2 * (xz + wy),     0,
+                       2 * (xy + wz),     1 - 2 * (xx + zz), 2 * (yz - wx),     0,
+                       2 * (xz - wy),     2 * (yz + wx),     1 - 2 * (xx + yy), 0,
+                       0,                 0,                 0,                 1);
+    }
+
+    // rotate, then translate
+    static Matrix4 rigid(const Quaternion& q, const Vector& t) {
+        Matrix4 result = rotation(q);
+        result.m[0][3] = t.x;
+        result.m[1][3] = t.y;
+        result.m[2][3] = t.z;
+        return result;
+    }
+
+    // the transform rhs followed by this one
+    Matrix4 operator*(const Matrix4& rhs) const {
+        Matrix4 result;
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                result.m[r][c] = m[r][0] * rhs.m[0][c] + m[r][1] * rhs.m[1][c]
+                               + m[r][2] * rhs.m[2][c] + m[r][3] * rhs.m[3][c];
+        return result;
+    }
+
+    Matrix4 transpose() const {
+        return Matrix4(m[0][0], m[1][0], m[2][0], m[3][0],
+                       m[0][1], m[1][1], m[2][1], m[3][1],
+                       m[0][2], m[1][2], m[2][2], m[3][2],
+                       m[0][3], m[1][3], m[2][3], m[3][3]);
+    }
+
+    bool operator==(const Matrix4& rhs) const {
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                if (m[r][c] != rhs.m[r][c])
+                    return false;
+        return true;
+    }
+
+    // affine transforms only; the bottom row is assumed to be 0 0 0 1
+    Vector transformPoint(const Vector& p) const {
+        return Vector(m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+                      m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+                      m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]);
+    }
+
+    Vector transformDirection(const Vector& d) const {
+        return Vector(m[0][0] * d.x + m[0][1] * d.y + m[0][2] * d.z,
+                      m[1][0] * d.x + m[1][1] * d.y + m[1][2] * d.z,
+                      m[2][0] * d.x + m[2][1] * d.y + m[2][2] * d.z);
+    }
+};
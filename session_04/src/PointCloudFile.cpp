@@ -0,0 +1,288 @@
+//
+// PointCloudFile.cpp
+//
+
+#include "PointCloudFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(Vector) == 24 && std::is_standard_layout<Vector>::value,
+              "the file format stores Vectors as three packed doubles");
+
+namespace {
+
+const char magic[8] = {'V', 'E', 'C', 'C', 'L', 'O', 'U', 'D'};
+const std::uint32_t byteOrderMark = 0x01020304;
+const std::uint64_t dataAlignment = 4096;
+
+const std::uint64_t fnvOffset = 14695981039346656037ull;
+const std::uint64_t fnvPrime = 1099511628211ull;
+
+// continue a checksum over more data. Whole words are mixed in 8 at a time,
+// which keeps the checksum from dominating the cost of writing a file.
+std::uint64_t checksumUpdate(std::uint64_t h, const void* data, std::size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        h = (h ^ word) * fnvPrime;
+    }
+    for (; i < bytes; ++i)
+        h = (h ^ p[i]) * fnvPrime;
+    return h;
+}
+
+std::runtime_error fileError(const std::string& path, const std::string& what) {
+    return std::runtime_error(path + ": " + what);
+}
+
+} // namespace
+
+std::uint64_t pointCloudChecksum(const void* data, std::size_t bytes) {
+    return checksumUpdate(fnvOffset, data, bytes);
+}
+
+//
+// PointCloudWriter
+//
+
+PointCloudWriter::PointCloudWriter(const std::string& path_, bool checksums_, std::uint64_t blockSize_) :
+    file{nullptr},
+    path{path_},
+    checksums{checksums_},
+    blockSize{blockSize_ > 0 ? blockSize_ : 1},
+    count{0},
+    blockHash{fnvOffset}
+{
+    file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        throw fileError(path, "cannot open for writing");
+    // the real header is written by close(). Until then the file starts
+    // with zeros, which no reader will accept.
+    // The destructor does not run if this throws, so close the file here.
+    try {
+        std::vector<char> zeros(dataAlignment, 0);
+        write(zeros.data(), zeros.size());
+    } catch (...) {
+        std::fclose(file);
+        throw;
+    }
+}
+
+PointCloudWriter::~PointCloudWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void PointCloudWriter::write(const void* data, std::size_t bytes) {
+    // fwrite may not be handed a null buffer, even for nothing
+    if (bytes == 0)
+        return;
+    if (std::fwrite(data, 1, bytes, file) != bytes)
+        throw fileError(path, "write failed");
+}
+
+void PointCloudWriter::append(const Vector* vectors, std::size_t n) {
+    if (!file)
+        throw fileError(path, "append after close");
+    while (n > 0) {
+        // never let a write straddle two checksum blocks
+        std::size_t take = n;
+        if (checksums)
+            take = static_cast<std::size_t>(std::min<std::uint64_t>(n, blockSize - count % blockSize));
+        const std::size_t bytes = take * sizeof(Vector);
+        write(vectors, bytes);
+        count += take;
+        if (checksums) {
+            blockHash = checksumUpdate(blockHash, vectors, bytes);
+            if (count % blockSize == 0) {
+                table.push_back(blockHash);
+                blockHash = fnvOffset;
+            }
+        }
+        vectors += take;
+        n -= take;
+    }
+}
+
+void PointCloudWriter::close() {
+    if (!file)
+        return;
+
+    PointCloudHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = PointCloudHeader::currentVersion;
+    header.byteOrder = byteOrderMark;
+    header.count = count;
+    header.vectorSize = sizeof(Vector);
+    header.blockSize = blockSize;
+    header.dataOffset = dataAlignment;
+
+    // whatever happens, the file is closed once, and the header is only
+    // written over the zeros if everything before it was
+    bool ok = true;
+    if (checksums) {
+        std::vector<std::uint64_t> finalTable(table);
+        if (count % blockSize != 0)
+            finalTable.push_back(blockHash);
+        header.flags |= PointCloudHeader::hasChecksums;
+        header.checksumOffset = dataAlignment + count * sizeof(Vector);
+        try {
+            write(finalTable.data(), finalTable.size() * sizeof(std::uint64_t));
+        } catch (const std::runtime_error&) {
+            ok = false;
+        }
+    }
+
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 &&
+         std::fwrite(&header, sizeof(header), 1, file) == 1;
+    const bool closed = std::fclose(file) == 0;
+    file = nullptr;
+    if (!ok || !closed)
+        throw fileError(path, "failed to finalize");
+}
+
+//
+// PointCloudReader
+//
+
+PointCloudReader::PointCloudReader(const std::string& path) :
+    base{nullptr},
+    length{0},
+    data{nullptr},
+    checksums{nullptr}
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw fileError(path, "cannot open");
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PointCloudHeader))) {
+        ::close(fd);
+        throw fileError(path, "too small to be a point cloud");
+    }
+    length = static_cast<std::size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+        throw fileError(path, "mmap failed");
+    base = mapped;
+
+    const PointCloudHeader& h = header();
+    std::string problem;
+    if (std::memcmp(h.magic, magic, sizeof(magic)) != 0)
+        problem = "not a point cloud file ( or it was never closed )";
+    else if (h.version == 0 || h.version > PointCloudHeader::currentVersion)
+        problem = "unsupported version " + std::to_string(h.version);
+    else if (h.byteOrder != byteOrderMark)
+        problem = "written with a different byte order";
+    else if (h.vectorSize != sizeof(Vector))
+        problem = "unexpected Vector size";
+    else if (h.dataOffset % alignof(Vector) != 0 || h.dataOffset > length ||
+             h.count > (length - h.dataOffset) / sizeof(Vector))
+        problem = "truncated";
+    else if (h.flags & PointCloudHeader::hasChecksums) {
+        const std::uint64_t blocks = h.blockSize ? (h.count + h.blockSize - 1) / h.blockSize : 0;
+        if (h.blockSize == 0 || h.checksumOffset % sizeof(std::uint64_t) != 0 ||
+            h.checksumOffset > length || blocks > (length - h.checksumOffset) / sizeof(std::uint64_t))
+            problem = "truncated checksum table";
+    }
+    if (!problem.empty()) {
+        unmap();
+        throw fileError(path, problem);
+    }
+
+    data = reinterpret_cast<const Vector*>(static_cast<const char*>(base) + h.dataOffset);
+    if (h.flags & PointCloudHeader::hasChecksums)
+        checksums = reinterpret_cast<const std::uint64_t*>(static_cast<const char*>(base) + h.checksumOffset);
+}
+
+PointCloudReader::~PointCloudReader() {
+    unmap();
+}
+
+PointCloudReader::PointCloudReader(PointCloudReader&& other) noexcept :
+    base{other.base},
+    length{other.length},
+    data{other.data},
+    checksums{other.checksums}
+{
+    other.base = nullptr;
+    other.length = 0;
+    other.data = nullptr;
+    other.checksums = nullptr;
+}
+
+PointCloudReader& PointCloudReader::operator=(PointCloudReader&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        base = other.base;
+        length = other.length;
+        data = other.data;
+        checksums = other.checksums;
+        other.base = nullptr;
+        other.length = 0;
+        other.data = nullptr;
+        other.checksums = nullptr;
+    }
+    return *this;
+}
+
+const PointCloudHeader& PointCloudReader::emptyHeader() {
+    static const PointCloudHeader empty = PointCloudHeader();
+    return empty;
+}
+
+void PointCloudReader::unmap() {
+    if (base)
+        ::munmap(base, length);
+    base = nullptr;
+    data = nullptr;
+    checksums = nullptr;
+}
+
+std::size_t PointCloudReader::blockCount() const {
+    const PointCloudHeader& h = header();
+    return h.blockSize ? (h.count + h.blockSize - 1) / h.blockSize : 0;
+}
+
+VectorSpan PointCloudReader::block(std::size_t i) const {
+    const std::uint64_t blockSize = header().blockSize;
+    return vectors().subspan(i * blockSize, blockSize);
+}
+
+bool PointCloudReader::verifyBlock(std::size_t i) const {
+    if (i >= blockCount())
+        throw std::out_of_range("PointCloudReader::verifyBlock: no block " + std::to_string(i));
+    if (!hasChecksums())
+        return true;
+    VectorSpan b = block(i);
+    return pointCloudChecksum(b.data(), b.size() * sizeof(Vector)) == checksums[i];
+}
+
+bool PointCloudReader::verify(ThreadPool& pool) const {
+    std::vector<char> ok(blockCount(), 1);
+    pool.parallelFor(ok.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            ok[i] = verifyBlock(i);
+    });
+    for (char b : ok)
+        if (!b)
+            return false;
+    return true;
+}
+
+void PointCloudReader::adviseSequential() const {
+    ::madvise(base, length, MADV_SEQUENTIAL);
+}
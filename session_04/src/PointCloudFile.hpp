@@ -0,0 +1,139 @@
+//
+// PointCloudFile.hpp
+//
+// Binary file format for arrays of Vectors, designed to be mmap'ed and used
+// in place rather than parsed.
+//
+// Layout ( all integers and doubles in the writer's native byte order, which
+// is little endian on every supported target. Readers reject a file whose
+// byteOrder mark shows it came from a host of the other order. ):
+//
+//   0              PointCloudHeader, 64 bytes
+//   dataOffset     count Vectors as packed x, y, z doubles. dataOffset is a
+//                  multiple of 4096, so the data starts on a page boundary.
+//   checksumOffset optional table of one 64 bit checksum per block of
+//                  blockSize Vectors ( the last block may be short )
+//
+// Readers must reject files with a different magic or a newer version.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+#include "VectorSpan.hpp"
+
+struct PointCloudHeader {
+    char magic[8];                  // "VECCLOUD"
+    std::uint32_t version;
+    std::uint32_t byteOrder;        // 0x01020304 as written by the producer
+    std::uint64_t count;            // number of Vectors
+    std::uint32_t vectorSize;       // bytes per Vector ( 24 )
+    std::uint32_t flags;
+    std::uint64_t blockSize;        // Vectors per checksum block
+    std::uint64_t dataOffset;
+    std::uint64_t checksumOffset;   // valid if flags has hasChecksums
+    std::uint64_t reserved;
+
+    static const std::uint32_t currentVersion = 1;
+    static const std::uint32_t hasChecksums = 1;
+};
+
+static_assert(sizeof(PointCloudHeader) == 64, "PointCloudHeader is part of the file format");
+
+// checksum used for each block: 64 bit FNV-1a over 8 byte words
+std::uint64_t pointCloudChecksum(const void* data, std::size_t bytes);
+
+//
+// PointCloudWriter streams Vectors to a file. Nothing is buffered beyond
+// the current stdio buffer and the running checksum of one block, so files
+// larger than memory can be written. close() ( or the destructor ) writes
+// the checksum table and finalizes the header; a file which was never
+// closed is rejected by PointCloudReader.
+//
+class PointCloudWriter {
+public:
+    explicit PointCloudWriter(const std::string& path, bool checksums = true,
+                              std::uint64_t blockSize = 1 << 16);
+    ~PointCloudWriter();
+
+    PointCloudWriter(const PointCloudWriter&) = delete;
+    PointCloudWriter& operator=(const PointCloudWriter&) = delete;
+
+    void append(const Vector* vectors, std::size_t n);
+    void append(VectorSpan vectors) { append(vectors.data(), vectors.size()); }
+    void append(const Vector& v) { append(&v, 1); }
+
+    std::uint64_t size() const { return count; }
+
+    // throws std::runtime_error if the file could not be finished, in
+    // which case it is closed anyway, with the zeros still in place of the
+    // header for readers to reject
+    void close();
+
+private:
+    void write(const void* data, std::size_t bytes);
+
+    std::FILE* file;
+    std::string path;
+    bool checksums;
+    std::uint64_t blockSize;
+    std::uint64_t count;
+    std::uint64_t blockHash;            // running checksum of the current block
+    std::vector<std::uint64_t> table;   // checksums of the finished blocks
+};
+
+//
+// PointCloudReader maps a file written by PointCloudWriter. vectors()
+// points straight into the mapping, so opening costs the same regardless of
+// file size and pages are only read as they are touched. Throws
+// std::runtime_error if the file cannot be mapped or its header does not
+// describe a complete, supported file.
+//
+class PointCloudReader {
+public:
+    explicit PointCloudReader(const std::string& path);
+    ~PointCloudReader();
+
+    PointCloudReader(PointCloudReader&& other) noexcept;
+    PointCloudReader& operator=(PointCloudReader&& other) noexcept;
+    PointCloudReader(const PointCloudReader&) = delete;
+    PointCloudReader& operator=(const PointCloudReader&) = delete;
+
+    // a reader which has been moved from has an all zero header, and so
+    // no Vectors and no blocks
+    const PointCloudHeader& header() const {
+        return base ? *reinterpret_cast<const PointCloudHeader*>(base) : emptyHeader();
+    }
+
+    VectorSpan vectors() const { return VectorSpan(data, header().count); }
+    std::size_t size() const { return header().count; }
+
+    bool hasChecksums() const { return (header().flags & PointCloudHeader::hasChecksums) != 0; }
+    std::size_t blockCount() const;
+    VectorSpan block(std::size_t i) const;
+
+    // recompute the checksum of block i and compare it with the table.
+    // Files without checksums always verify. Throws std::out_of_range if
+    // there is no block i.
+    bool verifyBlock(std::size_t i) const;
+    // verify every block, in parallel on pool
+    bool verify(ThreadPool& pool = ThreadPool::global()) const;
+
+    // hint that the whole file is about to be read front to back
+    void adviseSequential() const;
+
+private:
+    static const PointCloudHeader& emptyHeader();
+    void unmap();
+
+    void* base;
+    std::size_t length;
+    const Vector* data;
+    const std::uint64_t* checksums;
+};
@@ -0,0 +1,328 @@
+//
+// Quantize.cpp
+//
+
+#include "Quantize.hpp"
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using namespace simd;
+
+const std::size_t grain = 64 * 1024;
+const std::size_t W = Pack::width;
+
+double levels(QuantizedPoints::Precision precision) {
+    return precision == QuantizedPoints::Precision::Bits16 ? 65535.0 : 2097151.0;
+}
+
+// scale from [min, min + extent] to [0, maxLevel]; 0 for a flat axis
+double inverseStep(double extent, double maxLevel) {
+    return extent > 0 ? maxLevel / extent : 0.0;
+}
+
+//
+// octahedral mapping
+//
+const double octLevels = 65535.0;
+
+inline double signNotZero(double v) {
+    return v < 0 ? -1.0 : 1.0;
+}
+
+inline std::uint32_t octEncode(const Vector& n) {
+    const double l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    double u = l1 > 0 ? n.x / l1 : 0.0;
+    double v = l1 > 0 ? n.y / l1 : 0.0;
+    // fold the lower half of the octahedron over the upper one
+    if (n.z < 0) {
+        const double fu = (1 - std::abs(v)) * signNotZero(u);
+        const double fv = (1 - std::abs(u)) * signNotZero(v);
+        u = fu;
+        v = fv;
+    }
+    const std::uint32_t qu = static_cast<std::uint32_t>(std::lround((u * 0.5 + 0.5) * octLevels));
+    const std::uint32_t qv = static_cast<std::uint32_t>(std::lround((v * 0.5 + 0.5) * octLevels));
+    return qu | (qv << 16);
+}
+
+// the scalar decode, for single normals and the ends of the bulk loops
+inline void octDecode(std::uint32_t code, double& x, double& y, double& z) {
+    const double u = (code & 0xffff) * (2.0 / octLevels) - 1.0;
+    const double v = (code >> 16) * (2.0 / octLevels) - 1.0;
+    z = 1.0 - std::abs(u) - std::abs(v);
+    const double t = std::max(-z, 0.0);
+    x = u + (u >= 0 ? -t : t);
+    y = v + (v >= 0 ? -t : t);
+    const double inv = 1.0 / std::sqrt(x * x + y * y + z * z);
+    x *= inv;
+    y *= inv;
+    z *= inv;
+}
+
+inline Pack abs(Pack a) {
+    return max(a, broadcast(0.0) - a);
+}
+
+// octEncode on W normals at once. Rounds halves to even rather than away
+// from zero, which moves a code by at most one step either way.
+inline void octEncodePack(Pack x, Pack y, Pack z, std::uint32_t* out) {
+    const Pack zero = broadcast(0.0), one = broadcast(1.0), half = broadcast(0.5);
+    const Pack l1 = abs(x) + abs(y) + abs(z);
+    const Pack nonZero = less(zero, l1);
+    Pack u = select(nonZero, x / l1, zero);
+    Pack v = select(nonZero, y / l1, zero);
+    const Pack lower = less(z, zero);
+    const Pack fu = (one - abs(v)) * select(less(u, zero), broadcast(-1.0), one);
+    const Pack fv = (one - abs(u)) * select(less(v, zero), broadcast(-1.0), one);
+    u = select(lower, fu, u);
+    v = select(lower, fv, v);
+    const Pack top = broadcast(octLevels);
+    std::uint64_t qu[W], qv[W];
+    storeRounded(qu, min(max((u * half + half) * top, zero), top));
+    storeRounded(qv, min(max((v * half + half) * top, zero), top));
+    for (std::size_t k = 0; k < W; ++k)
+        out[k] = static_cast<std::uint32_t>(qu[k] | (qv[k] << 16));
+}
+
+// octDecode of codes [0, n) into three streams
+void octDecodeRange(const std::uint32_t* codes, std::size_t n, double* x, double* y, double* z) {
+    const Pack zero = broadcast(0.0), one = broadcast(1.0);
+    const Pack scale = broadcast(2.0 / octLevels);
+    double du[W], dv[W];
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        for (std::size_t k = 0; k < W; ++k) {
+            du[k] = codes[i + k] & 0xffff;
+            dv[k] = codes[i + k] >> 16;
+        }
+        const Pack u = load(du) * scale - one;
+        const Pack v = load(dv) * scale - one;
+        const Pack pz = one - abs(u) - abs(v);
+        const Pack t = max(zero - pz, zero);
+        const Pack px = u + select(less(u, zero), t, zero - t);
+        const Pack py = v + select(less(v, zero), t, zero - t);
+        const Pack inv = one / sqrt(px * px + py * py + pz * pz);
+        store(x + i, px * inv);
+        store(y + i, py * inv);
+        store(z + i, pz * inv);
+    }
+    for (; i < n; ++i)
+        octDecode(codes[i], x[i], y[i], z[i]);
+}
+
+} // namespace
+
+//
+// QuantizedPoints
+//
+
+QuantizedPoints::QuantizedPoints() :
+    step{0, 0, 0},
+    bits{Precision::Bits16},
+    count{0}
+{}
+
+QuantizedPoints::QuantizedPoints(VectorSpan points, Precision precision, ThreadPool& pool) :
+    QuantizedPoints(points, ::bounds(points, pool), precision, pool)
+{}
+
+QuantizedPoints::QuantizedPoints(VectorSpan points, const BoundingBox& box_, Precision precision,
+                                 ThreadPool& pool) :
+    box{box_},
+    bits{precision},
+    count{points.size()}
+{
+    if (points.empty()) {
+        step = Vector(0, 0, 0);
+        return;
+    }
+
+    const double maxLevel = levels(precision);
+    const Vector extent = box.size();
+    step = extent * (1.0 / maxLevel);
+    const double ix = inverseStep(extent.x, maxLevel);
+    const double iy = inverseStep(extent.y, maxLevel);
+    const double iz = inverseStep(extent.z, maxLevel);
+
+    if (precision == Precision::Bits16) {
+        x16.resize(count);
+        y16.resize(count);
+        z16.resize(count);
+    } else {
+        packed21.resize(count);
+    }
+
+    pool.parallelFor(count, grain, [&](std::size_t begin, std::size_t end) {
+        const Pack minX = broadcast(box.min.x), minY = broadcast(box.min.y), minZ = broadcast(box.min.z);
+        const Pack scaleX = broadcast(ix), scaleY = broadcast(iy), scaleZ = broadcast(iz);
+        const Pack zero = broadcast(0.0), top = broadcast(maxLevel);
+
+        double px[W], py[W], pz[W];
+        std::uint64_t qx[W], qy[W], qz[W];
+        for (std::size_t i = begin; i < end; i += W) {
+            // the last group of a chunk may be short; repeat its final point
+            for (std::size_t k = 0; k < W; ++k) {
+                const Vector& p = points[std::min(i + k, end - 1)];
+                px[k] = p.x;
+                py[k] = p.y;
+                pz[k] = p.z;
+            }
+            storeRounded(qx, min(max((load(px) - minX) * scaleX, zero), top));
+            storeRounded(qy, min(max((load(py) - minY) * scaleY, zero), top));
+            storeRounded(qz, min(max((load(pz) - minZ) * scaleZ, zero), top));
+
+            const std::size_t n = std::min(W, end - i);
+            for (std::size_t k = 0; k < n; ++k) {
+                if (precision == Precision::Bits16) {
+                    x16[i + k] = static_cast<std::uint16_t>(qx[k]);
+                    y16[i + k] = static_cast<std::uint16_t>(qy[k]);
+                    z16[i + k] = static_cast<std::uint16_t>(qz[k]);
+                } else {
+                    packed21[i + k] = qx[k] | (qy[k] << 21) | (qz[k] << 42);
+                }
+            }
+        }
+    });
+}
+
+std::size_t QuantizedPoints::bytes() const {
+    return (x16.size() + y16.size() + z16.size()) * sizeof(std::uint16_t) +
+           packed21.size() * sizeof(std::uint64_t);
+}
+
+Vector QuantizedPoints::operator[](std::size_t i) const {
+    double x, y, z;
+    if (bits == Precision::Bits16) {
+        x = x16[i];
+        y = y16[i];
+        z = z16[i];
+    } else {
+        x = static_cast<double>(packed21[i] & mask21);
+        y = static_cast<double>((packed21[i] >> 21) & mask21);
+        z = static_cast<double>((packed21[i] >> 42) & mask21);
+    }
+    return Vector(box.min.x + x * step.x, box.min.y + y * step.y, box.min.z + z * step.z);
+}
+
+// decode [begin, end) into three coordinate streams
+void QuantizedPoints::decodeRange(std::size_t begin, std::size_t end,
+                                  double* x, double* y, double* z) const {
+    const Pack minX = broadcast(box.min.x), minY = broadcast(box.min.y), minZ = broadcast(box.min.z);
+    const Pack sx = broadcast(step.x), sy = broadcast(step.y), sz = broadcast(step.z);
+
+    std::size_t i = begin;
+    if (bits == Precision::Bits16) {
+        for (; i + W <= end; i += W) {
+            store(x + i - begin, minX + loadU16(&x16[i]) * sx);
+            store(y + i - begin, minY + loadU16(&y16[i]) * sy);
+            store(z + i - begin, minZ + loadU16(&z16[i]) * sz);
+        }
+    } else {
+        for (; i + W <= end; i += W) {
+            store(x + i - begin, minX + loadU21(&packed21[i], 0) * sx);
+            store(y + i - begin, minY + loadU21(&packed21[i], 21) * sy);
+            store(z + i - begin, minZ + loadU21(&packed21[i], 42) * sz);
+        }
+    }
+    for (; i < end; ++i) {
+        const Vector v = (*this)[i];
+        x[i - begin] = v.x;
+        y[i - begin] = v.y;
+        z[i - begin] = v.z;
+    }
+}
+
+void QuantizedPoints::decode(VectorArray& out, ThreadPool& pool) const {
+    out.resize(count);
+    pool.parallelFor(count, grain, [&](std::size_t begin, std::size_t end) {
+        decodeRange(begin, end, out.x() + begin, out.y() + begin, out.z() + begin);
+    });
+}
+
+void QuantizedPoints::decode(Vector* out, ThreadPool& pool) const {
+    // decode a cache sized batch into streams, then interleave
+    const std::size_t batch = 1024;
+    pool.parallelFor(count, grain, [&](std::size_t begin, std::size_t end) {
+        double x[batch], y[batch], z[batch];
+        for (std::size_t b = begin; b < end; b += batch) {
+            const std::size_t e = std::min(end, b + batch);
+            decodeRange(b, e, x, y, z);
+            for (std::size_t i = b; i < e; ++i)
+                out[i] = Vector(x[i - b], y[i - b], z[i - b]);
+        }
+    });
+}
+
+std::vector<Vector> QuantizedPoints::toVectors(ThreadPool& pool) const {
+    std::vector<Vector> result(count);
+    decode(result.data(), pool);
+    return result;
+}
+
+//
+// OctNormals
+//
+
+OctNormals::OctNormals() {}
+
+OctNormals::OctNormals(VectorSpan normals, ThreadPool& pool) :
+    codes(normals.size())
+{
+    pool.parallelFor(normals.size(), grain, [&](std::size_t begin, std::size_t end) {
+        double px[W], py[W], pz[W];
+        std::size_t i = begin;
+        for (; i + W <= end; i += W) {
+            for (std::size_t k = 0; k < W; ++k) {
+                px[k] = normals[i + k].x;
+                py[k] = normals[i + k].y;
+                pz[k] = normals[i + k].z;
+            }
+            octEncodePack(load(px), load(py), load(pz), &codes[i]);
+        }
+        for (; i < end; ++i)
+            codes[i] = octEncode(normals[i]);
+    });
+}
+
+Vector OctNormals::operator[](std::size_t i) const {
+    Vector v;
+    octDecode(codes[i], v.x, v.y, v.z);
+    return v;
+}
+
+void OctNormals::decode(Vector* out, ThreadPool& pool) const {
+    // decode a cache sized batch into streams, then interleave
+    const std::size_t batch = 1024;
+    pool.parallelFor(codes.size(), grain, [&](std::size_t begin, std::size_t end) {
+        double x[batch], y[batch], z[batch];
+        for (std::size_t b = begin; b < end; b += batch) {
+            const std::size_t e = std::min(end, b + batch);
+            octDecodeRange(&codes[b], e - b, x, y, z);
+            for (std::size_t i = b; i < e; ++i)
+                out[i] = Vector(x[i - b], y[i - b], z[i - b]);
+        }
+    });
+}
+
+void OctNormals::decode(VectorArray& out, ThreadPool& pool) const {
+    out.resize(codes.size());
+    double* x = out.x();
+    double* y = out.y();
+    double* z = out.z();
+    pool.parallelFor(codes.size(), grain, [&](std::size_t begin, std::size_t end) {
+        octDecodeRange(codes.data() + begin, end - begin, x + begin, y + begin, z + begin);
+    });
+}
+
+double OctNormals::maxAngularError() {
+    // rounding moves (u, v) by at most half a step on each axis, h * sqrt(2)
+    // with h = 1 / octLevels in [-1, 1] units. Unfolding onto the octahedron
+    // stretches distances by at most sqrt(3), and projecting a point of the
+    // octahedron ( |p| >= 1 / sqrt(3) ) onto the sphere by at most sqrt(3).
+    const double h = 1.0 / octLevels;
+    return 3.0 * std::sqrt(2.0) * h;
+}
@@ -0,0 +1,92 @@
+//
+// Quantize.hpp
+//
+// Compressed storage for Vectors.
+//
+// QuantizedPoints stores positions as fixed point offsets inside a bounding
+// box: 16 bits per axis ( 6 bytes a point, 4x smaller than a Vector ) or
+// 21 bits per axis packed into one 64 bit word ( 8 bytes, 3x smaller ).
+//
+// OctNormals stores unit vectors with the octahedral mapping: the sphere is
+// folded onto an octahedron and unwrapped into a square, whose two
+// coordinates take 16 bits each ( 4 bytes a normal, 6x smaller ).
+//
+// Both decode in bulk, in parallel, back to Vectors or a VectorArray.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Reduce.hpp"
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+#include "VectorArray.hpp"
+#include "VectorSpan.hpp"
+
+class QuantizedPoints {
+public:
+    enum class Precision { Bits16, Bits21 };
+
+    QuantizedPoints();
+    // quantize relative to the bounds of points
+    QuantizedPoints(VectorSpan points, Precision precision,
+                    ThreadPool& pool = ThreadPool::global());
+    // quantize relative to box, e.g. one shared by several sets of points.
+    // Points outside box are clamped to it.
+    QuantizedPoints(VectorSpan points, const BoundingBox& box, Precision precision,
+                    ThreadPool& pool = ThreadPool::global());
+
+    std::size_t size() const { return count; }
+    Precision precision() const { return bits; }
+    const BoundingBox& bounds() const { return box; }
+
+    Vector operator[](std::size_t i) const;
+
+    // out must have room for size() Vectors
+    void decode(Vector* out, ThreadPool& pool = ThreadPool::global()) const;
+    void decode(VectorArray& out, ThreadPool& pool = ThreadPool::global()) const;
+    std::vector<Vector> toVectors(ThreadPool& pool = ThreadPool::global()) const;
+
+    // the furthest, per axis, that a decoded point can be from the original
+    // ( for points inside bounds() ): half a quantization step
+    Vector maxError() const { return step * 0.5; }
+
+    // bytes of encoded data held
+    std::size_t bytes() const;
+
+private:
+    void decodeRange(std::size_t begin, std::size_t end, double* x, double* y, double* z) const;
+
+    BoundingBox box;
+    Vector step;
+    Precision bits;
+    std::size_t count;
+    std::vector<std::uint16_t> x16, y16, z16;   // Bits16, one stream per axis
+    std::vector<std::uint64_t> packed21;        // Bits21, x | y << 21 | z << 42
+};
+
+class OctNormals {
+public:
+    OctNormals();
+    // normals should be unit length; they are normalized on the way in
+    explicit OctNormals(VectorSpan normals, ThreadPool& pool = ThreadPool::global());
+
+    std::size_t size() const { return codes.size(); }
+
+    Vector operator[](std::size_t i) const;
+
+    // out must have room for size() Vectors
+    void decode(Vector* out, ThreadPool& pool = ThreadPool::global()) const;
+    void decode(VectorArray& out, ThreadPool& pool = ThreadPool::global()) const;
+
+    // upper bound, in radians, on the angle between a unit normal and its
+    // decoded value ( about 0.0037 degrees )
+    static double maxAngularError();
+
+    std::size_t bytes() const { return codes.size() * sizeof(std::uint32_t); }
+
+private:
+    std::vector<std::uint32_t> codes;           // u in the low 16 bits, v in the high 16
+};
@@ -0,0 +1,61 @@
+//
+// Quaternion.hpp
+//
+// Rotation quaternion ( w + xi + yj + zk ). Like Vector it is header only,
+// so rotating a single Vector inlines completely.
+//
+#pragma once
+
+#include <cmath>
+
+#include "Vector.hpp"
+
+struct Quaternion {
+    double w, x, y, z;
+
+    // identity rotation
+    constexpr Quaternion() : w{1}, x{0}, y{0}, z{0} {}
+    constexpr Quaternion(double w_, double x_, double y_, double z_) : w{w_}, x{x_}, y{y_}, z{z_} {}
+
+    // rotation of angle radians about axis ( which need not be normalized )
+    static Quaternion fromAxisAngle(Vector axis, double angle) {
+        axis.normalize();
+        const double s = std::sin(angle * 0.5);
+        return Quaternion(std::cos(angle * 0.5), axis.x * s, axis.y * s, axis.z * s);
+    }
+
+    // the rotation rhs followed by this one
+    constexpr Quaternion operator*(const Quaternion& rhs) const {
+        return Quaternion(w * rhs.w - x * rhs.x - y * rhs.y - z * rhs.z,
+                          w * rhs.x + x * rhs.w + y * rhs.z - z * rhs.y,
+                          w * rhs.y - x * rhs.z + y * rhs.w + z * rhs.x,
+                          w * rhs.z + x * rhs.y - y * rhs.x + z * rhs.w);
+    }
+
+    constexpr Quaternion conjugate() const {
+        return Quaternion(w, -x, -y, -z);
+    }
+
+    double length() const {
+        return std::sqrt(w * w + x * x + y * y + z * z);
+    }
+
+    void normalize() {
+        double len = length();
+        w /= len;
+        x /= len;
+        y /= len;
+        z /= len;
+    }
+
+    // rotate v. Assumes a unit quaternion.
+    //   v' = v + 2w (q x v) + 2 q x (q x v)
+    constexpr Vector rotate(const Vector& v) const {
+        return rotate(v, Vector(x, y, z).cross(v));
+    }
+
+private:
+    constexpr Vector rotate(const Vector& v, const Vector& t) const {
+        return v + t * (2 * w) + Vector(x, y, z).cross(t) * 2.0;
+    }
+};
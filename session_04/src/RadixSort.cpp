@@ -0,0 +1,79 @@
+//
+// RadixSort.cpp
+//
+
+#include "RadixSort.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+const int digitBits = 11;
+const std::size_t radix = std::size_t(1) << digitBits;
+
+// keys per chunk
+const std::size_t chunkSize = 128 * 1024;
+
+} // namespace
+
+void radixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values,
+               int keyBits, ThreadPool& pool) {
+    if (keys.size() != values.size())
+        throw std::invalid_argument("radixSort: keys and values differ in size");
+    if (keyBits < 0 || keyBits > 64)
+        throw std::invalid_argument("radixSort: keyBits must be between 0 and 64");
+    const std::size_t n = keys.size();
+    if (n < 2)
+        return;
+
+    const std::size_t chunks = (n + chunkSize - 1) / chunkSize;
+    std::vector<std::size_t> offsets(chunks * radix);
+    std::vector<std::uint64_t> keyTmp(n);
+    std::vector<std::uint32_t> valueTmp(n);
+
+    for (int shift = 0; shift < keyBits; shift += digitBits) {
+        // the last digit may be narrower, so bits above keyBits are ignored
+        const int bits = std::min(digitBits, keyBits - shift);
+        const std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+
+        pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                std::size_t* count = &offsets[c * radix];
+                std::fill(count, count + radix, 0);
+                for (std::size_t i = c * chunkSize, e = std::min(n, i + chunkSize); i < e; ++i)
+                    ++count[(keys[i] >> shift) & mask];
+            }
+        });
+
+        // exclusive prefix, digit major so chunks keep their order. A pass
+        // where every key has the same digit would not move anything.
+        std::size_t total = 0;
+        bool trivial = false;
+        for (std::size_t d = 0; d < radix; ++d) {
+            const std::size_t before = total;
+            for (std::size_t c = 0; c < chunks; ++c) {
+                const std::size_t count = offsets[c * radix + d];
+                offsets[c * radix + d] = total;
+                total += count;
+            }
+            if (total - before == n)
+                trivial = true;
+        }
+        if (trivial)
+            continue;
+
+        pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                std::size_t* next = &offsets[c * radix];
+                for (std::size_t i = c * chunkSize, e = std::min(n, i + chunkSize); i < e; ++i) {
+                    const std::size_t at = next[(keys[i] >> shift) & mask]++;
+                    keyTmp[at] = keys[i];
+                    valueTmp[at] = values[i];
+                }
+            }
+        });
+        keys.swap(keyTmp);
+        values.swap(valueTmp);
+    }
+}
@@ -0,0 +1,23 @@
+//
+// RadixSort.hpp
+//
+// Parallel least significant digit radix sort of integer keys, each
+// carrying a 32 bit value ( usually the key's index in some other array ).
+//
+// Every pass counts digits per chunk, works out where each chunk's keys
+// go, then scatters the chunks in parallel. Chunks are fixed size, so the
+// result does not depend on the number of threads, and the sort is stable.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+// sort keys, and values with them, by the low keyBits bits of each key.
+// Keys which are equal in those bits keep their order. Throws
+// std::invalid_argument if keys and values differ in size.
+void radixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values,
+               int keyBits = 64, ThreadPool& pool = ThreadPool::global());
@@ -0,0 +1,137 @@
+//
+// Reduce.cpp
+//
+
+#include "Reduce.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Vectors per chunk. Part of the result's definition: changing it changes
+// the rounding, so keep it fixed.
+const std::size_t chunkSize = 8192;
+
+// reduce each chunk [begin, end) of n points with chunkFn, then fold the
+// chunk results together pairwise, always in the same order
+template <typename T, typename ChunkFn, typename Combine>
+T reduceRange(std::size_t n, ThreadPool& pool, ChunkFn chunkFn, Combine combine) {
+    const std::size_t chunks = (n + chunkSize - 1) / chunkSize;
+    std::vector<T> partial(chunks);
+    pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c)
+            partial[c] = chunkFn(c * chunkSize, std::min(n, (c + 1) * chunkSize));
+    });
+    // pairwise: neighbours at distance 1, then 2, 4, ...
+    for (std::size_t step = 1; step < chunks; step *= 2)
+        for (std::size_t i = 0; i + step < chunks; i += 2 * step)
+            partial[i] = combine(partial[i], partial[i + step]);
+    return partial[0];
+}
+
+template <typename T, typename ChunkFn, typename Combine>
+T reduce(VectorSpan points, ThreadPool& pool, ChunkFn chunkFn, Combine combine) {
+    return reduceRange<T>(points.size(), pool,
+                          [&](std::size_t begin, std::size_t end) {
+                              return chunkFn(points.subspan(begin, end - begin));
+                          },
+                          combine);
+}
+
+Vector chunkSum(VectorSpan points) {
+    // two accumulators per component to keep the adders busy
+    double x0 = 0, y0 = 0, z0 = 0, x1 = 0, y1 = 0, z1 = 0;
+    std::size_t i = 0;
+    for (; i + 2 <= points.size(); i += 2) {
+        x0 += points[i].x;     y0 += points[i].y;     z0 += points[i].z;
+        x1 += points[i + 1].x; y1 += points[i + 1].y; z1 += points[i + 1].z;
+    }
+    if (i < points.size()) {
+        x0 += points[i].x; y0 += points[i].y; z0 += points[i].z;
+    }
+    return Vector(x0 + x1, y0 + y1, z0 + z1);
+}
+
+// bounds of points[begin, end), for a VectorSpan or a VectorArray
+template <typename Points>
+BoundingBox chunkBounds(const Points& points, std::size_t begin, std::size_t end) {
+    const double inf = std::numeric_limits<double>::infinity();
+    BoundingBox box{Vector(inf, inf, inf), Vector(-inf, -inf, -inf)};
+    for (std::size_t i = begin; i < end; ++i) {
+        const Vector p = points[i];
+        box.min.x = std::min(box.min.x, p.x);
+        box.min.y = std::min(box.min.y, p.y);
+        box.min.z = std::min(box.min.z, p.z);
+        box.max.x = std::max(box.max.x, p.x);
+        box.max.y = std::max(box.max.y, p.y);
+        box.max.z = std::max(box.max.z, p.z);
+    }
+    return box;
+}
+
+BoundingBox combineBounds(const BoundingBox& a, const BoundingBox& b) {
+    return BoundingBox{Vector(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z)),
+                       Vector(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z))};
+}
+
+Covariance chunkScatter(VectorSpan points, const Vector& mean) {
+    Covariance c{0, 0, 0, 0, 0, 0};
+    for (const Vector& p : points) {
+        const double dx = p.x - mean.x, dy = p.y - mean.y, dz = p.z - mean.z;
+        c.xx += dx * dx; c.xy += dx * dy; c.xz += dx * dz;
+        c.yy += dy * dy; c.yz += dy * dz;
+        c.zz += dz * dz;
+    }
+    return c;
+}
+
+Covariance combineScatter(const Covariance& a, const Covariance& b) {
+    return Covariance{a.xx + b.xx, a.xy + b.xy, a.xz + b.xz,
+                      a.yy + b.yy, a.yz + b.yz,
+                      a.zz + b.zz};
+}
+
+} // namespace
+
+Vector sum(VectorSpan points, ThreadPool& pool) {
+    if (points.empty())
+        return Vector(0, 0, 0);
+    return reduce<Vector>(points, pool, chunkSum,
+                          [](const Vector& a, const Vector& b) { return a + b; });
+}
+
+Vector centroid(VectorSpan points, ThreadPool& pool) {
+    if (points.empty())
+        throw std::invalid_argument("centroid of no points");
+    return sum(points, pool) * (1.0 / points.size());
+}
+
+BoundingBox bounds(VectorSpan points, ThreadPool& pool) {
+    if (points.empty())
+        return chunkBounds(points, 0, 0);
+    return reduceRange<BoundingBox>(points.size(), pool,
+                                    [&](std::size_t begin, std::size_t end) { return chunkBounds(points, begin, end); },
+                                    combineBounds);
+}
+
+BoundingBox bounds(const VectorArray& points, ThreadPool& pool) {
+    if (points.empty())
+        return chunkBounds(points, 0, 0);
+    return reduceRange<BoundingBox>(points.size(), pool,
+                                    [&](std::size_t begin, std::size_t end) { return chunkBounds(points, begin, end); },
+                                    combineBounds);
+}
+
+Covariance covariance(VectorSpan points, ThreadPool& pool) {
+    const Vector mean = centroid(points, pool);
+    Covariance c = reduce<Covariance>(points, pool,
+                                      [&mean](VectorSpan chunk) { return chunkScatter(chunk, mean); },
+                                      combineScatter);
+    const double scale = 1.0 / points.size();
+    return Covariance{c.xx * scale, c.xy * scale, c.xz * scale,
+                      c.yy * scale, c.yz * scale,
+                      c.zz * scale};
+}
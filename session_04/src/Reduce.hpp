@@ -0,0 +1,58 @@
+//
+// Reduce.hpp
+//
+// Parallel reductions over runs of Vectors: sum, centroid, bounding box and
+// covariance.
+//
+// The input is cut into fixed size chunks and each chunk is reduced on its
+// own, whichever thread picks it up. The chunk results are then combined
+// pairwise in chunk order. Because neither the chunk boundaries nor the
+// combining order depend on the number of threads, the results are bit for
+// bit the same on any ThreadPool, including one with no workers.
+//
+#pragma once
+
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+#include "VectorArray.hpp"
+#include "VectorSpan.hpp"
+
+struct BoundingBox {
+    Vector min, max;
+
+    // an empty box has min > max on every axis
+    bool empty() const { return min.x > max.x; }
+    Vector size() const { return max - min; }
+    Vector center() const { return (min + max) * 0.5; }
+};
+
+// symmetric 3x3 matrix, e.g. the covariance of a point set
+struct Covariance {
+    double xx, xy, xz, yy, yz, zz;
+
+    double operator()(int row, int col) const {
+        const double m[3][3] = { {xx, xy, xz}, {xy, yy, yz}, {xz, yz, zz} };
+        return m[row][col];
+    }
+};
+
+// sum of all the Vectors. ( 0, 0, 0 ) for an empty span.
+Vector sum(VectorSpan points, ThreadPool& pool = ThreadPool::global());
+
+// mean of all the Vectors. Throws std::invalid_argument for an empty span.
+Vector centroid(VectorSpan points, ThreadPool& pool = ThreadPool::global());
+
+// axis aligned bounds. empty() for an empty span.
+BoundingBox bounds(VectorSpan points, ThreadPool& pool = ThreadPool::global());
+BoundingBox bounds(const VectorArray& points, ThreadPool& pool = ThreadPool::global());
+// a std::vector converts to both of the above
+inline BoundingBox bounds(const std::vector<Vector>& points, ThreadPool& pool = ThreadPool::global()) {
+    return bounds(VectorSpan(points), pool);
+}
+
+// population covariance about the centroid ( divides by n ). Computed in a
+// second pass over the data, which is more accurate than the one pass
+// sum of squares formula. Throws std::invalid_argument for an empty span.
+Covariance covariance(VectorSpan points, ThreadPool& pool = ThreadPool::global());
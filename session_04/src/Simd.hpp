@@ -0,0 +1,134 @@
+//
+// Simd.hpp
+//
+// Internal helper for the batch kernels in the vector library. Only
+// include it from .cpp files; the register type depends on the flags the
+// library was built with.
+//
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+// 2^52: adding it to a double in [0, 2^52) leaves the value, rounded to the
+// nearest integer, in the low mantissa bits
+const double twoTo52 = 4503599627370496.0;
+const std::uint64_t mantissaMask = (std::uint64_t(1) << 52) - 1;
+const std::uint64_t mask21 = (std::uint64_t(1) << 21) - 1;
+
+#if defined(__SSE2__)
+namespace detail {
+// bits [shift, shift + 21) of two packed words, converted to doubles
+inline __m128d u21Pair(const std::uint64_t* p, int shift) {
+    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    w = _mm_and_si128(_mm_srl_epi64(w, _mm_cvtsi32_si128(shift)),
+                      _mm_set1_epi64x(static_cast<long long>(mask21)));
+    const __m128d bias = _mm_set1_pd(twoTo52);
+    return _mm_sub_pd(_mm_or_pd(_mm_castsi128_pd(w), bias), bias);
+}
+} // namespace detail
+#endif
+
+//
+// Pack wraps the widest double register available at compile time, so the
+// kernels are written once. Build with -DVECTOR_AVX2=ON to get the 4 wide
+// AVX2 version; otherwise x86-64 gets 2 wide SSE2 and everything else gets
+// the plain scalar loop.
+//
+#if defined(__AVX__)
+struct Pack {
+    static const std::size_t width = 4;
+    __m256d v;
+};
+inline Pack load(const double* p) { return Pack{_mm256_loadu_pd(p)}; }
+inline void store(double* p, Pack a) { _mm256_storeu_pd(p, a.v); }
+inline Pack broadcast(double d) { return Pack{_mm256_set1_pd(d)}; }
+inline Pack operator+(Pack a, Pack b) { return Pack{_mm256_add_pd(a.v, b.v)}; }
+inline Pack operator-(Pack a, Pack b) { return Pack{_mm256_sub_pd(a.v, b.v)}; }
+inline Pack operator*(Pack a, Pack b) { return Pack{_mm256_mul_pd(a.v, b.v)}; }
+inline Pack operator/(Pack a, Pack b) { return Pack{_mm256_div_pd(a.v, b.v)}; }
+inline Pack sqrt(Pack a) { return Pack{_mm256_sqrt_pd(a.v)}; }
+inline Pack min(Pack a, Pack b) { return Pack{_mm256_min_pd(a.v, b.v)}; }
+inline Pack max(Pack a, Pack b) { return Pack{_mm256_max_pd(a.v, b.v)}; }
+// lane mask of a < b, and a blend taking a where the mask is set
+inline Pack less(Pack a, Pack b) { return Pack{_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+inline Pack select(Pack mask, Pack a, Pack b) { return Pack{_mm256_blendv_pd(b.v, a.v, mask.v)}; }
+// width uint16s widened to doubles
+inline Pack loadU16(const std::uint16_t* p) {
+    const __m128i w = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return Pack{_mm256_cvtepi32_pd(_mm_unpacklo_epi16(w, _mm_setzero_si128()))};
+}
+// bits [shift, shift + 21) of width packed words, as doubles
+inline Pack loadU21(const std::uint64_t* p, int shift) {
+    return Pack{_mm256_insertf128_pd(_mm256_castpd128_pd256(detail::u21Pair(p, shift)),
+                                     detail::u21Pair(p + 2, shift), 1)};
+}
+// round to the nearest integer and store as width uint64s. 0 <= a < 2^52
+inline void storeRounded(std::uint64_t* p, Pack a) {
+    const __m256d biased = _mm256_add_pd(a.v, _mm256_set1_pd(twoTo52));
+    const __m256d mask = _mm256_castsi256_pd(_mm256_set1_epi64x(static_cast<long long>(mantissaMask)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_castpd_si256(_mm256_and_pd(biased, mask)));
+}
+#elif defined(__SSE2__)
+struct Pack {
+    static const std::size_t width = 2;
+    __m128d v;
+};
+inline Pack load(const double* p) { return Pack{_mm_loadu_pd(p)}; }
+inline void store(double* p, Pack a) { _mm_storeu_pd(p, a.v); }
+inline Pack broadcast(double d) { return Pack{_mm_set1_pd(d)}; }
+inline Pack operator+(Pack a, Pack b) { return Pack{_mm_add_pd(a.v, b.v)}; }
+inline Pack operator-(Pack a, Pack b) { return Pack{_mm_sub_pd(a.v, b.v)}; }
+inline Pack operator*(Pack a, Pack b) { return Pack{_mm_mul_pd(a.v, b.v)}; }
+inline Pack operator/(Pack a, Pack b) { return Pack{_mm_div_pd(a.v, b.v)}; }
+inline Pack sqrt(Pack a) { return Pack{_mm_sqrt_pd(a.v)}; }
+inline Pack min(Pack a, Pack b) { return Pack{_mm_min_pd(a.v, b.v)}; }
+inline Pack max(Pack a, Pack b) { return Pack{_mm_max_pd(a.v, b.v)}; }
+inline Pack less(Pack a, Pack b) { return Pack{_mm_cmplt_pd(a.v, b.v)}; }
+inline Pack select(Pack mask, Pack a, Pack b) {
+    return Pack{_mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v))};
+}
+inline Pack loadU16(const std::uint16_t* p) {
+    const __m128i w = _mm_cvtsi32_si128(p[0] | (p[1] << 16));
+    return Pack{_mm_cvtepi32_pd(_mm_unpacklo_epi16(w, _mm_setzero_si128()))};
+}
+inline Pack loadU21(const std::uint64_t* p, int shift) { return Pack{detail::u21Pair(p, shift)}; }
+inline void storeRounded(std::uint64_t* p, Pack a) {
+    const __m128d biased = _mm_add_pd(a.v, _mm_set1_pd(twoTo52));
+    const __m128d mask = _mm_castsi128_pd(_mm_set1_epi64x(static_cast<long long>(mantissaMask)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_castpd_si128(_mm_and_pd(biased, mask)));
+}
+#else
+struct Pack {
+    static const std::size_t width = 1;
+    double v;
+};
+inline Pack load(const double* p) { return Pack{*p}; }
+inline void store(double* p, Pack a) { *p = a.v; }
+inline Pack broadcast(double d) { return Pack{d}; }
+inline Pack operator+(Pack a, Pack b) { return Pack{a.v + b.v}; }
+inline Pack operator-(Pack a, Pack b) { return Pack{a.v - b.v}; }
+inline Pack operator*(Pack a, Pack b) { return Pack{a.v * b.v}; }
+inline Pack operator/(Pack a, Pack b) { return Pack{a.v / b.v}; }
+inline Pack sqrt(Pack a) { return Pack{std::sqrt(a.v)}; }
+inline Pack min(Pack a, Pack b) { return Pack{a.v < b.v ? a.v : b.v}; }
+inline Pack max(Pack a, Pack b) { return Pack{a.v > b.v ? a.v : b.v}; }
+inline Pack less(Pack a, Pack b) { return Pack{a.v < b.v ? 1.0 : 0.0}; }
+inline Pack select(Pack mask, Pack a, Pack b) { return mask.v != 0 ? a : b; }
+inline Pack loadU16(const std::uint16_t* p) { return Pack{static_cast<double>(*p)}; }
+inline Pack loadU21(const std::uint64_t* p, int shift) {
+    return Pack{static_cast<double>((*p >> shift) & mask21)};
+}
+inline void storeRounded(std::uint64_t* p, Pack a) {
+    *p = static_cast<std::uint64_t>(std::nearbyint(a.v));
+}
+#endif
+
+} // namespace simd
@@ -0,0 +1,165 @@
+//
+// SpaceFillingCurve.cpp
+//
+
+#include "SpaceFillingCurve.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "RadixSort.hpp"
+
+namespace {
+
+const int bitsPerAxis = 21;
+const std::uint32_t cells = 1u << bitsPerAxis;
+
+// points per parallelFor chunk
+const std::size_t grain = 64 * 1024;
+
+// spread the low 21 bits of v out to every third bit
+inline std::uint64_t spread(std::uint32_t v) {
+    std::uint64_t x = v & 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffull;
+    x = (x | x << 16) & 0x1f0000ff0000ffull;
+    x = (x | x << 8)  & 0x100f00f00f00f00full;
+    x = (x | x << 4)  & 0x10c30c30c30c30c3ull;
+    x = (x | x << 2)  & 0x1249249249249249ull;
+    return x;
+}
+
+// snaps coordinates to the grid over a box
+struct Snap {
+    double lo[3], scale[3];
+
+    explicit Snap(const BoundingBox& box) {
+        const double min[3] = {box.min.x, box.min.y, box.min.z};
+        const double max[3] = {box.max.x, box.max.y, box.max.z};
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = min[a];
+            const double extent = max[a] - min[a];
+            scale[a] = extent > 0 && extent < std::numeric_limits<double>::infinity() ? cells / extent : 0.0;
+        }
+    }
+
+    std::uint32_t operator()(double c, int axis) const {
+        const double v = (c - lo[axis]) * scale[axis];
+        // written so NaN lands in cell 0
+        if (!(v > 0))
+            return 0;
+        return v >= cells - 1 ? cells - 1 : static_cast<std::uint32_t>(v);
+    }
+};
+
+// codes for n points, where point(i) returns the ith
+template <typename Point>
+void codesOf(std::size_t n, Point point, const BoundingBox& box, Curve curve,
+             std::vector<std::uint64_t>& codes, ThreadPool& pool) {
+    const Snap snap(box);
+    codes.resize(n);
+    pool.parallelFor(n, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const Vector p = point(i);
+            const std::uint32_t x = snap(p.x, 0), y = snap(p.y, 1), z = snap(p.z, 2);
+            codes[i] = curve == Curve::Morton ? mortonCode(x, y, z) : hilbertCode(x, y, z);
+        }
+    });
+}
+
+std::vector<std::uint32_t> orderOf(std::vector<std::uint64_t>& codes, ThreadPool& pool) {
+    std::vector<std::uint32_t> order(codes.size());
+    pool.parallelFor(order.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            order[i] = static_cast<std::uint32_t>(i);
+    });
+    radixSort(codes, order, 3 * bitsPerAxis, pool);
+    return order;
+}
+
+void checkSize(std::size_t n) {
+    if (n >= 0xffffffffu)
+        throw std::length_error("curve orders hold at most 2^32 - 1 points");
+}
+
+} // namespace
+
+std::uint64_t mortonCode(std::uint32_t x, std::uint32_t y, std::uint32_t z) {
+    return spread(x) | spread(y) << 1 | spread(z) << 2;
+}
+
+// Skilling's method ( "Programming the Hilbert curve", 2004 ): turn the
+// coordinates into the transposed Hilbert index in place, then interleave
+// it like a Morton code.
+std::uint64_t hilbertCode(std::uint32_t x, std::uint32_t y, std::uint32_t z) {
+    std::uint32_t X[3] = {x & (cells - 1), y & (cells - 1), z & (cells - 1)};
+
+    // undo the rotations and reflections of each level: if bit q of X[i]
+    // is set invert the low bits of X[0], else swap them with X[i]'s. Done
+    // with masks, as the branch would be a coin toss.
+    for (std::uint32_t q = cells >> 1; q > 1; q >>= 1) {
+        const std::uint32_t p = q - 1;
+        for (int i = 0; i < 3; ++i) {
+            const std::uint32_t set = 0u - ((X[i] & q) != 0);
+            const std::uint32_t t = (X[0] ^ X[i]) & p & ~set;
+            X[0] ^= (p & set) | t;
+            X[i] ^= t;
+        }
+    }
+
+    // gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    std::uint32_t t = 0;
+    for (std::uint32_t q = cells >> 1; q > 1; q >>= 1)
+        if (X[2] & q)
+            t ^= q - 1;
+    for (int i = 0; i < 3; ++i)
+        X[i] ^= t;
+
+    return spread(X[2]) | spread(X[1]) << 1 | spread(X[0]) << 2;
+}
+
+void curveCodes(VectorSpan points, const BoundingBox& box, Curve curve,
+                std::vector<std::uint64_t>& codes, ThreadPool& pool) {
+    codesOf(points.size(), [&points](std::size_t i) { return points[i]; }, box, curve, codes, pool);
+}
+
+std::vector<std::uint32_t> curveOrder(VectorSpan points, Curve curve, ThreadPool& pool) {
+    checkSize(points.size());
+    std::vector<std::uint64_t> codes;
+    curveCodes(points, bounds(points, pool), curve, codes, pool);
+    return orderOf(codes, pool);
+}
+
+std::vector<std::uint32_t> curveOrder(const std::vector<Vector>& points, Curve curve, ThreadPool& pool) {
+    return curveOrder(VectorSpan(points), curve, pool);
+}
+
+std::vector<std::uint32_t> curveOrder(const VectorArray& points, Curve curve, ThreadPool& pool) {
+    checkSize(points.size());
+    std::vector<std::uint64_t> codes;
+    codesOf(points.size(), [&points](std::size_t i) { return points[i]; },
+            bounds(points, pool), curve, codes, pool);
+    return orderOf(codes, pool);
+}
+
+std::vector<std::uint32_t> sortAlongCurve(std::vector<Vector>& points, Curve curve, ThreadPool& pool) {
+    auto order = curveOrder(points, curve, pool);
+    permute(points, order, pool);
+    return order;
+}
+
+std::vector<std::uint32_t> sortAlongCurve(VectorArray& points, Curve curve, ThreadPool& pool) {
+    auto order = curveOrder(points, curve, pool);
+    VectorArray sorted(points.size());
+    pool.parallelFor(order.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            sorted.x()[i] = points.x()[order[i]];
+            sorted.y()[i] = points.y()[order[i]];
+            sorted.z()[i] = points.z()[order[i]];
+        }
+    });
+    points = std::move(sorted);
+    return order;
+}
@@ -0,0 +1,66 @@
+//
+// SpaceFillingCurve.hpp
+//
+// Reordering of point sets along a space filling curve, so points which are
+// close in space are close in memory and neighbourhood passes stop missing
+// the cache.
+//
+// Each point is snapped to a 2^21 grid over the bounds of the set, and the
+// three 21 bit cell coordinates become one 63 bit position along the curve,
+// which is then radix sorted. The Morton ( Z order ) curve just interleaves
+// the coordinate bits. The Hilbert curve costs a little more to compute but
+// never jumps: consecutive cells are always neighbours.
+//
+// The sorts hand back the permutation they applied, so attributes stored
+// alongside the points ( normals, colours, ids ) can follow with permute().
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Reduce.hpp"
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+#include "VectorArray.hpp"
+#include "VectorSpan.hpp"
+
+enum class Curve { Morton, Hilbert };
+
+// position along the curve of grid cell ( x, y, z ). Only the low 21 bits
+// of each coordinate are used.
+std::uint64_t mortonCode(std::uint32_t x, std::uint32_t y, std::uint32_t z);
+std::uint64_t hilbertCode(std::uint32_t x, std::uint32_t y, std::uint32_t z);
+
+// codes[i] = position along the curve of points[i], on a 2^21 grid over box.
+// Points outside box are clamped to it.
+void curveCodes(VectorSpan points, const BoundingBox& box, Curve curve,
+                std::vector<std::uint64_t>& codes, ThreadPool& pool = ThreadPool::global());
+
+// order[i] = index of the point which comes ith along the curve. Points in
+// the same grid cell keep their input order.
+std::vector<std::uint32_t> curveOrder(VectorSpan points, Curve curve = Curve::Morton,
+                                      ThreadPool& pool = ThreadPool::global());
+std::vector<std::uint32_t> curveOrder(const std::vector<Vector>& points, Curve curve = Curve::Morton,
+                                      ThreadPool& pool = ThreadPool::global());
+std::vector<std::uint32_t> curveOrder(const VectorArray& points, Curve curve = Curve::Morton,
+                                      ThreadPool& pool = ThreadPool::global());
+
+// reorder points along the curve, returning the order used ( as curveOrder )
+std::vector<std::uint32_t> sortAlongCurve(std::vector<Vector>& points, Curve curve = Curve::Morton,
+                                          ThreadPool& pool = ThreadPool::global());
+std::vector<std::uint32_t> sortAlongCurve(VectorArray& points, Curve curve = Curve::Morton,
+                                          ThreadPool& pool = ThreadPool::global());
+
+// values becomes { values[order[0]], values[order[1]], ... }
+template <typename T>
+void permute(std::vector<T>& values, const std::vector<std::uint32_t>& order,
+             ThreadPool& pool = ThreadPool::global()) {
+    std::vector<T> result(order.size());
+    pool.parallelFor(order.size(), 64 * 1024, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            result[i] = values[order[i]];
+    });
+    values.swap(result);
+}
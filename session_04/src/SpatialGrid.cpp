@@ -0,0 +1,292 @@
+//
+// SpatialGrid.cpp
+//
+
+#include "SpatialGrid.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Reduce.hpp"
+
+namespace {
+
+// points per chunk of the bucket sort
+const std::size_t buildGrain = 256 * 1024;
+
+// queries per parallelFor chunk
+const std::size_t queryGrain = 256;
+
+// points per parallelFor chunk while welding
+const std::size_t weldGrain = 4096;
+
+// the sort first partitions on this many top bits of the bucket, then
+// counting sorts each partition on its own
+const int partitionBits = 11;
+
+// partitions per parallelFor chunk
+const std::size_t partitionGrain = 16;
+
+// widest a grid may be, in cells, so cell coordinates stay exact
+const double maxCells = 1e15;
+
+} // namespace
+
+SpatialGrid::SpatialGrid() :
+    cell{1.0}, inverse{1.0}, origin{0, 0, 0}, lastCell{0, 0, 0}, mask{0}, start{0, 0}
+{}
+
+SpatialGrid::SpatialGrid(VectorSpan points, double cellSize, ThreadPool& pool) : SpatialGrid() {
+    if (!(cellSize > 0) || std::isinf(cellSize))
+        throw std::invalid_argument("SpatialGrid cell size must be positive and finite");
+    const std::size_t n = points.size();
+    if (n >= 0xffffffffu)
+        throw std::length_error("SpatialGrid holds at most 2^32 - 1 points");
+    cell = cellSize;
+    inverse = 1.0 / cellSize;
+    if (n == 0)
+        return;
+
+    const BoundingBox box = bounds(points, pool);
+    const double lo[3] = {box.min.x, box.min.y, box.min.z};
+    const double hi[3] = {box.max.x, box.max.y, box.max.z};
+    for (int a = 0; a < 3; ++a) {
+        if (!std::isfinite(lo[a]) || !std::isfinite(hi[a]))
+            throw std::invalid_argument("SpatialGrid points must be finite");
+        if ((hi[a] - lo[a]) * inverse > maxCells)
+            throw std::invalid_argument("SpatialGrid cell size is too small for the extent of the points");
+        origin[a] = lo[a];
+    }
+    for (int a = 0; a < 3; ++a)
+        lastCell[a] = cellOf(hi[a], a);
+
+    int bits = 0;
+    while ((std::size_t(1) << bits) < n)
+        ++bits;
+    const std::size_t buckets = std::size_t(1) << bits;
+    mask = buckets - 1;
+    const int shift = bits - std::min(bits, partitionBits);
+    const std::size_t parts = buckets >> shift;
+    const std::size_t sub = std::size_t(1) << shift;
+
+    // pass 1: bucket every point, and count per chunk how many land in each
+    // partition ( the top bits of the bucket )
+    const std::size_t chunks = (n + buildGrain - 1) / buildGrain;
+    std::vector<std::uint32_t> keys(n);
+    std::vector<std::size_t> offsets(chunks * parts, 0);
+    pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            std::size_t* count = &offsets[c * parts];
+            for (std::size_t i = c * buildGrain, e = std::min(n, i + buildGrain); i < e; ++i) {
+                const Vector& p = points[i];
+                if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z))
+                    throw std::invalid_argument("SpatialGrid points must be finite");
+                keys[i] = static_cast<std::uint32_t>(bucketOf(cellOf(p.x, 0), cellOf(p.y, 1), cellOf(p.z, 2)));
+                ++count[keys[i] >> shift];
+            }
+        }
+    });
+
+    // exclusive prefix, partition major, so the scatter keeps input order
+    std::vector<std::size_t> partStart(parts + 1);
+    std::size_t total = 0;
+    for (std::size_t p = 0; p < parts; ++p) {
+        partStart[p] = total;
+        for (std::size_t c = 0; c < chunks; ++c) {
+            const std::size_t count = offsets[c * parts + p];
+            offsets[c * parts + p] = total;
+            total += count;
+        }
+    }
+    partStart[parts] = n;
+
+    std::vector<std::uint32_t> partIds(n), partKeys(n);
+    pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            std::size_t* next = &offsets[c * parts];
+            for (std::size_t i = c * buildGrain, e = std::min(n, i + buildGrain); i < e; ++i) {
+                const std::size_t at = next[keys[i] >> shift]++;
+                partIds[at] = static_cast<std::uint32_t>(i);
+                partKeys[at] = keys[i];
+            }
+        }
+    });
+    std::vector<std::uint32_t>().swap(keys);
+
+    // pass 2: counting sort each partition on the rest of the bucket bits.
+    // Partitions own disjoint ranges of start and ids.
+    start.assign(buckets + 1, 0);
+    ids.resize(n);
+    pool.parallelFor(parts, partitionGrain, [&](std::size_t begin, std::size_t end) {
+        std::vector<std::uint32_t> next(sub);
+        for (std::size_t p = begin; p < end; ++p) {
+            const std::size_t first = partStart[p], last = partStart[p + 1];
+            std::uint32_t* count = &start[p * sub];
+            for (std::size_t k = first; k < last; ++k)
+                ++count[partKeys[k] & (sub - 1)];
+            std::uint32_t at = static_cast<std::uint32_t>(first);
+            for (std::size_t s = 0; s < sub; ++s) {
+                const std::uint32_t c = count[s];
+                count[s] = at;
+                at += c;
+            }
+            if (first == last)
+                continue;
+            std::copy(count, count + sub, next.begin());
+            for (std::size_t k = first; k < last; ++k)
+                ids[next[partKeys[k] & (sub - 1)]++] = partIds[k];
+        }
+    });
+    start[buckets] = static_cast<std::uint32_t>(n);
+
+    xs.resize(n);
+    ys.resize(n);
+    zs.resize(n);
+    pool.parallelFor(n, buildGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const Vector& p = points[ids[i]];
+            xs[i] = p.x;
+            ys[i] = p.y;
+            zs[i] = p.z;
+        }
+    });
+}
+
+bool SpatialGrid::cellRange(const Vector& q, double radius, std::int64_t lo[3], std::int64_t hi[3]) const {
+    if (empty() || !(radius >= 0))
+        return false;
+    // a little wider than radius, so rounding in the distance test cannot
+    // accept a point in a cell that was not visited
+    const double r = radius + radius * 1e-9;
+    const double c[3] = {q.x, q.y, q.z};
+    for (int a = 0; a < 3; ++a) {
+        const double l = std::floor((c[a] - r - origin[a]) * inverse);
+        const double h = std::floor((c[a] + r - origin[a]) * inverse);
+        // written so a NaN query fails too
+        if (!(h >= 0) || !(l <= static_cast<double>(lastCell[a])))
+            return false;
+        lo[a] = l < 0 ? 0 : static_cast<std::int64_t>(l);
+        hi[a] = h > static_cast<double>(lastCell[a]) ? lastCell[a] : static_cast<std::int64_t>(h);
+    }
+    return true;
+}
+
+std::vector<SpatialGrid::Neighbour> SpatialGrid::withinRadius(const Vector& q, double radius) const {
+    std::vector<Neighbour> result;
+    forEachWithin(q, radius, [&result](std::uint32_t index, double d2) {
+        result.push_back(Neighbour{index, d2});
+    });
+    std::sort(result.begin(), result.end(), [](const Neighbour& a, const Neighbour& b) {
+        return a.distanceSquared < b.distanceSquared ||
+               (a.distanceSquared == b.distanceSquared && a.index < b.index);
+    });
+    return result;
+}
+
+void SpatialGrid::withinRadius(const Vector* queries, std::size_t n, double radius,
+                               std::vector<std::vector<Neighbour>>& out, ThreadPool& pool) const {
+    out.resize(n);
+    pool.parallelFor(n, queryGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            out[i] = withinRadius(queries[i], radius);
+    });
+}
+
+WeldResult weld(VectorSpan points, double epsilon, ThreadPool& pool) {
+    if (!(epsilon >= 0) || std::isinf(epsilon))
+        throw std::invalid_argument("weld epsilon must be zero or positive, and finite");
+    const std::size_t n = points.size();
+    WeldResult result;
+    if (n == 0)
+        return result;
+
+    // With epsilon 0 a query visits only the point's own cell, and the finer
+    // the cells the fewer other points share it. Otherwise cells at least
+    // 2 epsilon wide keep a query to 8 cells, and cells about as wide as the
+    // spacing of points on a surface ( widest / sqrt(n) ) keep a query with
+    // a small epsilon to one or two cells of a point or so each.
+    const Vector extent = bounds(points, pool).size();
+    const double widest = std::max(extent.x, std::max(extent.y, extent.z));
+    double cellSize = epsilon > 0 ? 2 * epsilon : 1.0;
+    if (std::isfinite(widest) && widest > 0) {
+        const double spacing = epsilon > 0 ? widest / std::sqrt(static_cast<double>(n)) : 0.0;
+        cellSize = std::max(std::max(epsilon > 0 ? cellSize : 0.0, spacing), widest / maxCells * 4);
+    }
+    const SpatialGrid grid(points, cellSize, pool);
+
+    // rep[i] = lowest index within epsilon of point i, which is i itself
+    // if nothing came before it. Such points are always kept, and a point
+    // whose lowest neighbour is one of them maps straight to it, since
+    // nothing kept comes earlier.
+    std::vector<std::uint32_t> rep(n);
+    pool.parallelFor(n, weldGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            std::uint32_t first = static_cast<std::uint32_t>(i);
+            grid.forEachWithin(points[i], epsilon, [&first](std::uint32_t j, double) {
+                first = std::min(first, j);
+            });
+            rep[i] = first;
+        }
+    });
+
+    // the rest depend on which earlier points were kept, so they are
+    // decided in order
+    std::vector<char> pending(n);
+    pool.parallelFor(n, weldGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            pending[i] = rep[i] != i && rep[rep[i]] != rep[i];
+    });
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!pending[i])
+            continue;
+        std::uint32_t best = static_cast<std::uint32_t>(i);
+        grid.forEachWithin(points[i], epsilon, [&](std::uint32_t j, double) {
+            if (j < best && rep[j] == j)
+                best = j;
+        });
+        rep[i] = best;
+    }
+
+    // number the kept points in input order
+    const std::size_t chunks = (n + weldGrain - 1) / weldGrain;
+    std::vector<std::uint32_t> kept(chunks + 1, 0);
+    pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c)
+            for (std::size_t i = c * weldGrain, e = std::min(n, i + weldGrain); i < e; ++i)
+                kept[c + 1] += rep[i] == i;
+    });
+    for (std::size_t c = 0; c < chunks; ++c)
+        kept[c + 1] += kept[c];
+
+    std::vector<std::uint32_t> slot(n);
+    result.points.resize(kept[chunks]);
+    pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            std::uint32_t next = kept[c];
+            for (std::size_t i = c * weldGrain, e = std::min(n, i + weldGrain); i < e; ++i) {
+                if (rep[i] == i) {
+                    result.points[next] = points[i];
+                    slot[i] = next++;
+                }
+            }
+        }
+    });
+
+    result.remap.resize(n);
+    pool.parallelFor(n, weldGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            result.remap[i] = slot[rep[i]];
+    });
+    return result;
+}
+
+void remapIndices(std::vector<std::uint32_t>& indices, const std::vector<std::uint32_t>& remap,
+                  ThreadPool& pool) {
+    pool.parallelFor(indices.size(), 64 * 1024, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (indices[i] >= remap.size())
+                throw std::out_of_range("remapIndices: index past the end of the remap table");
+            indices[i] = remap[indices[i]];
+        }
+    });
+}
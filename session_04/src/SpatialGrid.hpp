@@ -0,0 +1,127 @@
+//
+// SpatialGrid.hpp
+//
+// Uniform grid over a set of Vectors for fixed radius neighbour queries,
+// and vertex welding built on it.
+//
+// Space is cut into cubic cells of cellSize, and each cell is hashed into
+// one of a power of two number of buckets ( at least as many as there are
+// points ). The points are counting sorted by bucket, so every bucket is a
+// contiguous run and the grid is just a table of bucket start offsets plus
+// the points in bucket order. Cells which collide in the hash share a run;
+// queries filter them apart.
+//
+// Queries are cheapest with a radius at most cellSize, when they visit no
+// more than 27 cells. Query results refer to points by their index in the
+// input the grid was built from.
+//
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+#include "VectorSpan.hpp"
+
+class SpatialGrid {
+public:
+    struct Neighbour {
+        std::uint32_t index;        // position in the input points
+        double distanceSquared;
+    };
+
+    SpatialGrid();
+    // builds in parallel on pool. Points must be finite and cellSize
+    // positive; throws std::invalid_argument otherwise.
+    SpatialGrid(VectorSpan points, double cellSize, ThreadPool& pool = ThreadPool::global());
+
+    std::size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+    double cellSize() const { return cell; }
+
+    // every point within radius of q, closest first
+    std::vector<Neighbour> withinRadius(const Vector& q, double radius) const;
+
+    // out[i] = withinRadius(queries[i], radius), spread over pool
+    void withinRadius(const Vector* queries, std::size_t n, double radius,
+                      std::vector<std::vector<Neighbour>>& out,
+                      ThreadPool& pool = ThreadPool::global()) const;
+
+    // calls fn(index, distanceSquared) for every point within radius of q,
+    // in no particular order. Allocates nothing.
+    template <typename Fn>
+    void forEachWithin(const Vector& q, double radius, Fn fn) const;
+
+private:
+    std::int64_t cellOf(double c, int axis) const {
+        return static_cast<std::int64_t>(std::floor((c - origin[axis]) * inverse));
+    }
+
+    std::size_t bucketOf(std::int64_t ix, std::int64_t iy, std::int64_t iz) const {
+        std::uint64_t h = static_cast<std::uint64_t>(ix) * 0x9e3779b97f4a7c15ull +
+                          static_cast<std::uint64_t>(iy) * 0xc2b2ae3d27d4eb4full +
+                          static_cast<std::uint64_t>(iz) * 0x165667b19e3779f9ull;
+        h ^= h >> 29;
+        return static_cast<std::size_t>(h & mask);
+    }
+
+    // the cells a query sphere touches, clipped to the occupied ones.
+    // false if there are none.
+    bool cellRange(const Vector& q, double radius, std::int64_t lo[3], std::int64_t hi[3]) const;
+
+    double cell;
+    double inverse;                     // 1 / cell
+    double origin[3];                   // corner of cell ( 0, 0, 0 )
+    std::int64_t lastCell[3];           // highest occupied cell on each axis
+    std::uint64_t mask;                 // buckets - 1
+    std::vector<std::uint32_t> start;   // first point of each bucket, plus size()
+    std::vector<double> xs, ys, zs;     // points in bucket order
+    std::vector<std::uint32_t> ids;     // input index of each point in bucket order
+};
+
+template <typename Fn>
+void SpatialGrid::forEachWithin(const Vector& q, double radius, Fn fn) const {
+    std::int64_t lo[3], hi[3];
+    if (!cellRange(q, radius, lo, hi))
+        return;
+    const double r2 = radius * radius;
+    for (std::int64_t iz = lo[2]; iz <= hi[2]; ++iz) {
+        for (std::int64_t iy = lo[1]; iy <= hi[1]; ++iy) {
+            for (std::int64_t ix = lo[0]; ix <= hi[0]; ++ix) {
+                const std::size_t b = bucketOf(ix, iy, iz);
+                for (std::size_t i = start[b], e = start[b + 1]; i < e; ++i) {
+                    const double dx = xs[i] - q.x, dy = ys[i] - q.y, dz = zs[i] - q.z;
+                    const double d2 = dx * dx + dy * dy + dz * dz;
+                    // the cell test stops a bucket shared by two visited
+                    // cells from reporting its points twice
+                    if (d2 <= r2 && cellOf(xs[i], 0) == ix && cellOf(ys[i], 1) == iy &&
+                        cellOf(zs[i], 2) == iz)
+                        fn(ids[i], d2);
+                }
+            }
+        }
+    }
+}
+
+//
+// welding: merging points closer together than some epsilon
+//
+struct WeldResult {
+    std::vector<std::uint32_t> remap;   // input index -> index in points
+    std::vector<Vector> points;         // the surviving points, in input order
+};
+
+// Points are taken in input order: each one is kept unless it is within
+// epsilon of a point already kept, in which case it maps to the first such
+// point. Every point ends up within epsilon of the point it maps to, and no
+// two kept points are within epsilon of each other. An epsilon of 0 merges
+// only exact duplicates, the same test as Vector::operator==.
+WeldResult weld(VectorSpan points, double epsilon, ThreadPool& pool = ThreadPool::global());
+
+// indices[i] = remap[indices[i]], e.g. to rewrite a mesh's index buffer
+// after welding its vertices
+void remapIndices(std::vector<std::uint32_t>& indices, const std::vector<std::uint32_t>& remap,
+                  ThreadPool& pool = ThreadPool::global());
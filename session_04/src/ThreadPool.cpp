@@ -0,0 +1,128 @@
+//
+// ThreadPool.cpp
+//
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace {
+
+// bookkeeping for one parallelFor call. Helpers hold it by shared_ptr, so
+// a helper which only gets scheduled after the call returned finds no work
+// left and never touches the caller's stack.
+struct ForState {
+    std::function<void(std::size_t, std::size_t)> body;
+    std::size_t n, grain, chunks;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+
+    // claim and run chunks until none are left
+    void work() {
+        std::size_t chunk;
+        while ((chunk = next.fetch_add(1)) < chunks) {
+            const std::size_t begin = chunk * grain;
+            const std::size_t end = std::min(n, begin + grain);
+            try {
+                body(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+            if (done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threads) : stopping{false} {
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        workers.emplace_back([this] { run(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+std::size_t ThreadPool::defaultThreads() {
+    const std::size_t hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    available.notify_one();
+}
+
+void ThreadPool::run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t n, std::size_t grain,
+                             const std::function<void(std::size_t, std::size_t)>& body) {
+    if (n == 0)
+        return;
+    grain = std::max<std::size_t>(grain, 1);
+    const std::size_t chunks = (n + grain - 1) / grain;
+
+    // nothing to share; skip the bookkeeping
+    if (chunks == 1 || workers.empty()) {
+        for (std::size_t begin = 0; begin < n; begin += grain)
+            body(begin, std::min(n, begin + grain));
+        return;
+    }
+
+    auto state = std::make_shared<ForState>();
+    state->body = body;
+    state->n = n;
+    state->grain = grain;
+    state->chunks = chunks;
+
+    const std::size_t helpers = std::min(workers.size(), chunks - 1);
+    for (std::size_t i = 0; i < helpers; ++i)
+        submit([state] { state->work(); });
+
+    state->work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done.load() == chunks; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
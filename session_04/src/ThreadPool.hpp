@@ -0,0 +1,54 @@
+//
+// ThreadPool.hpp
+//
+// A fixed set of worker threads fed from a single task queue. The batch
+// algorithms in this library split their input with parallelFor, which
+// also runs chunks on the calling thread, so a pool with no workers simply
+// runs everything serially and nested parallelFor calls cannot deadlock.
+//
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads worker threads in addition to whichever thread calls
+    // parallelFor. The default leaves one hardware thread for the caller.
+    explicit ThreadPool(std::size_t threads = defaultThreads());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // shared pool used when an algorithm is not handed one explicitly
+    static ThreadPool& global();
+    static std::size_t defaultThreads();
+
+    // number of threads which may run chunks, including the caller
+    std::size_t concurrency() const { return workers.size() + 1; }
+
+    // queue a task for a worker thread
+    void submit(std::function<void()> task);
+
+    // run body(begin, end) over [0, n) in chunks of at most grain elements,
+    // and return once every chunk has finished. Chunk boundaries depend only
+    // on n and grain, never on the number of threads. The first exception
+    // thrown by body is rethrown here.
+    void parallelFor(std::size_t n, std::size_t grain,
+                     const std::function<void(std::size_t, std::size_t)>& body);
+
+private:
+    void run();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping;
+};
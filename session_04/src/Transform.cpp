@@ -0,0 +1,146 @@
+//
+// Transform.cpp
+//
+
+#include "Transform.hpp"
+#include "Simd.hpp"
+
+#include <type_traits>
+
+static_assert(sizeof(Vector) == 3 * sizeof(double) && std::is_standard_layout<Vector>::value,
+              "the array of Vector kernels assume x, y, z are packed");
+
+namespace {
+
+using namespace simd;
+
+// points per parallelFor chunk; large enough to amortize scheduling,
+// small enough to balance across cores
+const std::size_t grain = 16 * 1024;
+
+//
+// array of structures: one Vector per iteration, with the matrix columns
+// held in registers and each component of the input broadcast across them.
+// w is 1 for points and 0 for directions.
+//
+template <bool point>
+void transformChunk(const Matrix4& m, const Vector* in, Vector* out, std::size_t n) {
+    const double (&a)[4][4] = m.m;
+#if defined(__AVX__)
+    const __m256d c0 = _mm256_setr_pd(a[0][0], a[1][0], a[2][0], 0.0);
+    const __m256d c1 = _mm256_setr_pd(a[0][1], a[1][1], a[2][1], 0.0);
+    const __m256d c2 = _mm256_setr_pd(a[0][2], a[1][2], a[2][2], 0.0);
+    const __m256d c3 = point ? _mm256_setr_pd(a[0][3], a[1][3], a[2][3], 0.0)
+                             : _mm256_setzero_pd();
+    // write x, y, z but not the lane past the end of the Vector
+    const __m256i xyz = _mm256_setr_epi64x(-1, -1, -1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double* p = &in[i].x;
+        __m256d r = _mm256_add_pd(_mm256_mul_pd(c0, _mm256_broadcast_sd(p)), c3);
+        r = _mm256_add_pd(r, _mm256_mul_pd(c1, _mm256_broadcast_sd(p + 1)));
+        r = _mm256_add_pd(r, _mm256_mul_pd(c2, _mm256_broadcast_sd(p + 2)));
+        _mm256_maskstore_pd(&out[i].x, xyz, r);
+    }
+#elif defined(__SSE2__)
+    // x and y share one register, z is done in the low lane of another
+    const __m128d c0xy = _mm_setr_pd(a[0][0], a[1][0]), c0z = _mm_set_sd(a[2][0]);
+    const __m128d c1xy = _mm_setr_pd(a[0][1], a[1][1]), c1z = _mm_set_sd(a[2][1]);
+    const __m128d c2xy = _mm_setr_pd(a[0][2], a[1][2]), c2z = _mm_set_sd(a[2][2]);
+    const __m128d c3xy = point ? _mm_setr_pd(a[0][3], a[1][3]) : _mm_setzero_pd();
+    const __m128d c3z = point ? _mm_set_sd(a[2][3]) : _mm_setzero_pd();
+    for (std::size_t i = 0; i < n; ++i) {
+        const __m128d pxy = _mm_loadu_pd(&in[i].x);
+        const __m128d pz = _mm_load_sd(&in[i].z);
+        const __m128d x = _mm_unpacklo_pd(pxy, pxy);
+        const __m128d y = _mm_unpackhi_pd(pxy, pxy);
+        const __m128d z = _mm_unpacklo_pd(pz, pz);
+        __m128d rxy = _mm_add_pd(_mm_mul_pd(c0xy, x), c3xy);
+        rxy = _mm_add_pd(rxy, _mm_mul_pd(c1xy, y));
+        rxy = _mm_add_pd(rxy, _mm_mul_pd(c2xy, z));
+        __m128d rz = _mm_add_sd(_mm_mul_sd(c0z, x), c3z);
+        rz = _mm_add_sd(rz, _mm_mul_sd(c1z, y));
+        rz = _mm_add_sd(rz, _mm_mul_sd(c2z, z));
+        _mm_storeu_pd(&out[i].x, rxy);
+        _mm_store_sd(&out[i].z, rz);
+    }
+#else
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = point ? m.transformPoint(in[i]) : m.transformDirection(in[i]);
+#endif
+}
+
+//
+// structure of arrays: Pack::width Vectors per iteration
+//
+template <bool point>
+void transformChunk(const Matrix4& m, const double* ix, const double* iy, const double* iz,
+                    double* ox, double* oy, double* oz, std::size_t n) {
+    const double (&a)[4][4] = m.m;
+    const double tx = point ? a[0][3] : 0.0;
+    const double ty = point ? a[1][3] : 0.0;
+    const double tz = point ? a[2][3] : 0.0;
+    const Pack m00 = broadcast(a[0][0]), m01 = broadcast(a[0][1]), m02 = broadcast(a[0][2]);
+    const Pack m10 = broadcast(a[1][0]), m11 = broadcast(a[1][1]), m12 = broadcast(a[1][2]);
+    const Pack m20 = broadcast(a[2][0]), m21 = broadcast(a[2][1]), m22 = broadcast(a[2][2]);
+    const Pack t0 = broadcast(tx), t1 = broadcast(ty), t2 = broadcast(tz);
+
+    const std::size_t W = Pack::width;
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const Pack x = load(ix + i), y = load(iy + i), z = load(iz + i);
+        store(ox + i, m00 * x + m01 * y + m02 * z + t0);
+        store(oy + i, m10 * x + m11 * y + m12 * z + t1);
+        store(oz + i, m20 * x + m21 * y + m22 * z + t2);
+    }
+    for (; i < n; ++i) {
+        const double x = ix[i], y = iy[i], z = iz[i];
+        ox[i] = a[0][0] * x + a[0][1] * y + a[0][2] * z + tx;
+        oy[i] = a[1][0] * x + a[1][1] * y + a[1][2] * z + ty;
+        oz[i] = a[2][0] * x + a[2][1] * y + a[2][2] * z + tz;
+    }
+}
+
+template <bool point>
+void transformAll(const Matrix4& m, const Vector* in, Vector* out, std::size_t n, ThreadPool& pool) {
+    pool.parallelFor(n, grain, [&](std::size_t begin, std::size_t end) {
+        transformChunk<point>(m, in + begin, out + begin, end - begin);
+    });
+}
+
+template <bool point>
+void transformAll(const Matrix4& m, const VectorArray& in, VectorArray& out, ThreadPool& pool) {
+    out.resize(in.size());
+    const double* ix = in.x(); const double* iy = in.y(); const double* iz = in.z();
+    double* ox = out.x(); double* oy = out.y(); double* oz = out.z();
+    pool.parallelFor(in.size(), grain, [&](std::size_t begin, std::size_t end) {
+        transformChunk<point>(m, ix + begin, iy + begin, iz + begin,
+                              ox + begin, oy + begin, oz + begin, end - begin);
+    });
+}
+
+} // namespace
+
+void transformPoints(const Matrix4& m, const Vector* in, Vector* out, std::size_t n, ThreadPool& pool) {
+    transformAll<true>(m, in, out, n, pool);
+}
+
+void transformDirections(const Matrix4& m, const Vector* in, Vector* out, std::size_t n, ThreadPool& pool) {
+    transformAll<false>(m, in, out, n, pool);
+}
+
+void rotate(const Quaternion& q, const Vector* in, Vector* out, std::size_t n, ThreadPool& pool) {
+    // converting once costs less than rotating each Vector by the quaternion
+    transformAll<false>(Matrix4::rotation(q), in, out, n, pool);
+}
+
+void transformPoints(const Matrix4& m, const VectorArray& in, VectorArray& out, ThreadPool& pool) {
+    transformAll<true>(m, in, out, pool);
+}
+
+void transformDirections(const Matrix4& m, const VectorArray& in, VectorArray& out, ThreadPool& pool) {
+    transformAll<false>(m, in, out, pool);
+}
+
+void rotate(const Quaternion& q, const VectorArray& in, VectorArray& out, ThreadPool& pool) {
+    transformAll<false>(Matrix4::rotation(q), in, out, pool);
+}
@@ -0,0 +1,39 @@
+//
+// Transform.hpp
+//
+// Batch affine transforms and rotations over contiguous runs of Vectors.
+// Each call splits its input into chunks which run on a ThreadPool ( the
+// global one unless a pool is passed in ), and each chunk uses the SIMD
+// kernels from Simd.hpp. out may be the same memory as in.
+//
+#pragma once
+
+#include <cstddef>
+
+#include "Matrix4.hpp"
+#include "Quaternion.hpp"
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+#include "VectorArray.hpp"
+
+// out[i] = m.transformPoint(in[i]) for n Vectors
+void transformPoints(const Matrix4& m, const Vector* in, Vector* out, std::size_t n,
+                     ThreadPool& pool = ThreadPool::global());
+
+// out[i] = m.transformDirection(in[i]) for n Vectors
+void transformDirections(const Matrix4& m, const Vector* in, Vector* out, std::size_t n,
+                         ThreadPool& pool = ThreadPool::global());
+
+// out[i] = q.rotate(in[i]) for n Vectors
+void rotate(const Quaternion& q, const Vector* in, Vector* out, std::size_t n,
+            ThreadPool& pool = ThreadPool::global());
+
+// structure-of-arrays versions. out is resized to match in.
+void transformPoints(const Matrix4& m, const VectorArray& in, VectorArray& out,
+                     ThreadPool& pool = ThreadPool::global());
+
+void transformDirections(const Matrix4& m, const VectorArray& in, VectorArray& out,
+                         ThreadPool& pool = ThreadPool::global());
+
+void rotate(const Quaternion& q, const VectorArray& in, VectorArray& out,
+            ThreadPool& pool = ThreadPool::global());
@@ -0,0 +1,172 @@
+//
+// TriangleMesh.cpp
+//
+
+#include "TriangleMesh.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "RadixSort.hpp"
+#include "SpatialGrid.hpp"
+
+namespace {
+
+// triangles per chunk. Part of the definition of area and volume: changing
+// it changes the rounding, so keep it fixed.
+const std::size_t chunkSize = 8192;
+
+// vertices per parallelFor chunk
+const std::size_t vertexGrain = 16 * 1024;
+
+// indices per parallelFor chunk
+const std::size_t cornerGrain = 64 * 1024;
+
+// sum of chunkFn(begin, end) over fixed chunks of [0, n), combined pairwise
+// in chunk order as Reduce.cpp does
+template <typename ChunkFn>
+double reduceChunks(std::size_t n, ThreadPool& pool, ChunkFn chunkFn) {
+    const std::size_t chunks = (n + chunkSize - 1) / chunkSize;
+    if (chunks == 0)
+        return 0.0;
+    std::vector<double> partial(chunks);
+    pool.parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c)
+            partial[c] = chunkFn(c * chunkSize, std::min(n, (c + 1) * chunkSize));
+    });
+    for (std::size_t step = 1; step < chunks; step *= 2)
+        for (std::size_t i = 0; i + step < chunks; i += 2 * step)
+            partial[i] += partial[i + step];
+    return partial[0];
+}
+
+inline Vector unitOrZero(const Vector& v) {
+    const double length = v.length();
+    return length > 0 ? v * (1.0 / length) : Vector(0, 0, 0);
+}
+
+} // namespace
+
+TriangleMesh::TriangleMesh() : aroundStart{0} {}
+
+TriangleMesh::TriangleMesh(VectorArray vertices, std::vector<std::uint32_t> indices, ThreadPool& pool) :
+    positions(std::move(vertices)), corners(std::move(indices))
+{
+    if (corners.size() % 3 != 0)
+        throw std::invalid_argument("TriangleMesh indices must come in threes");
+    if (corners.size() >= 0xffffffffu)
+        throw std::length_error("TriangleMesh holds at most 2^32 - 1 indices");
+    const std::size_t n = vertexCount(), nc = corners.size();
+    pool.parallelFor(nc, cornerGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            if (corners[i] >= n)
+                throw std::invalid_argument("TriangleMesh index past the last vertex");
+    });
+
+    // group the corners by vertex, in corner order within each group
+    std::vector<std::uint64_t> keys(nc);
+    around.resize(nc);
+    pool.parallelFor(nc, cornerGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            keys[i] = corners[i];
+            around[i] = static_cast<std::uint32_t>(i);
+        }
+    });
+    int bits = 0;
+    while ((std::uint64_t(1) << bits) < n)
+        ++bits;
+    radixSort(keys, around, bits, pool);
+
+    // where the key changes, every vertex after the old one up to the new
+    // one starts here; each range belongs to a single position
+    aroundStart.resize(n + 1);
+    pool.parallelFor(nc, cornerGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (i > 0 && keys[i] == keys[i - 1])
+                continue;
+            const std::uint64_t first = i == 0 ? 0 : keys[i - 1] + 1;
+            for (std::uint64_t v = first; v <= keys[i]; ++v)
+                aroundStart[v] = static_cast<std::uint32_t>(i);
+        }
+    });
+    for (std::size_t v = nc == 0 ? 0 : keys[nc - 1] + 1; v <= n; ++v)
+        aroundStart[v] = static_cast<std::uint32_t>(nc);
+}
+
+Vector TriangleMesh::areaNormal(std::size_t t) const {
+    const Vector a = vertex(t, 0);
+    return (vertex(t, 1) - a).cross(vertex(t, 2) - a);
+}
+
+void TriangleMesh::faceNormals(VectorArray& out, ThreadPool& pool) const {
+    out.resize(triangleCount());
+    double* x = out.x();
+    double* y = out.y();
+    double* z = out.z();
+    pool.parallelFor(triangleCount(), chunkSize, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            const Vector n = unitOrZero(areaNormal(t));
+            x[t] = n.x;
+            y[t] = n.y;
+            z[t] = n.z;
+        }
+    });
+}
+
+void TriangleMesh::vertexNormals(VectorArray& out, ThreadPool& pool) const {
+    // the length of the cross product is twice the area, which is the
+    // weighting wanted
+    std::vector<Vector> weighted(triangleCount());
+    pool.parallelFor(triangleCount(), chunkSize, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t)
+            weighted[t] = areaNormal(t);
+    });
+
+    out.resize(vertexCount());
+    double* x = out.x();
+    double* y = out.y();
+    double* z = out.z();
+    pool.parallelFor(vertexCount(), vertexGrain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t v = begin; v < end; ++v) {
+            Vector sum(0, 0, 0);
+            for (std::size_t j = aroundStart[v]; j < aroundStart[v + 1]; ++j)
+                sum += weighted[around[j] / 3];
+            const Vector normal = unitOrZero(sum);
+            x[v] = normal.x;
+            y[v] = normal.y;
+            z[v] = normal.z;
+        }
+    });
+}
+
+double TriangleMesh::surfaceArea(ThreadPool& pool) const {
+    return 0.5 * reduceChunks(triangleCount(), pool, [this](std::size_t begin, std::size_t end) {
+        double total = 0;
+        for (std::size_t t = begin; t < end; ++t)
+            total += areaNormal(t).length();
+        return total;
+    });
+}
+
+// sum of the signed volumes of the tetrahedra from a fixed apex to each
+// face. Any apex gives the same answer for a closed mesh; one on the mesh
+// keeps the terms small when the mesh is far from the origin.
+double TriangleMesh::volume(ThreadPool& pool) const {
+    if (triangleCount() == 0)
+        return 0.0;
+    const Vector apex = positions[0];
+    return reduceChunks(triangleCount(), pool, [this, &apex](std::size_t begin, std::size_t end) {
+        double total = 0;
+        for (std::size_t t = begin; t < end; ++t)
+            total += (vertex(t, 0) - apex) * (vertex(t, 1) - apex).cross(vertex(t, 2) - apex);
+        return total;
+    }) / 6.0;
+}
+
+TriangleMesh weldMesh(VectorSpan soup, double epsilon, ThreadPool& pool) {
+    if (soup.size() % 3 != 0)
+        throw std::invalid_argument("weldMesh needs 3 points per triangle");
+    WeldResult welded = weld(soup, epsilon, pool);
+    return TriangleMesh(VectorArray(welded.points), std::move(welded.remap), pool);
+}
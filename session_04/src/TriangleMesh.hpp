@@ -0,0 +1,69 @@
+//
+// TriangleMesh.hpp
+//
+// Indexed triangle mesh: the vertex positions as a VectorArray, and three
+// 32 bit indices into it per triangle.
+//
+// Everything that walks the triangles runs in parallel over fixed size
+// chunks, so results are bit for bit the same on any ThreadPool. Vertex
+// normals sum the faces around each vertex without atomics or per thread
+// copies of the output: the constructor radix sorts the corners by vertex
+// once, and each vertex then gathers its own faces in a fixed order.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+#include "VectorArray.hpp"
+#include "VectorSpan.hpp"
+
+class TriangleMesh {
+public:
+    TriangleMesh();
+    // throws std::invalid_argument unless indices holds whole triangles
+    // which all refer to vertices that exist
+    TriangleMesh(VectorArray vertices, std::vector<std::uint32_t> indices,
+                 ThreadPool& pool = ThreadPool::global());
+
+    std::size_t vertexCount() const { return positions.size(); }
+    std::size_t triangleCount() const { return corners.size() / 3; }
+
+    const VectorArray& vertices() const { return positions; }
+    const std::vector<std::uint32_t>& indices() const { return corners; }
+
+    // vertex k ( 0, 1 or 2 ) of triangle t
+    Vector vertex(std::size_t t, int k) const { return positions[corners[3 * t + k]]; }
+
+    // unit normal of each triangle, by the right hand rule on its winding.
+    // ( 0, 0, 0 ) for a degenerate triangle.
+    void faceNormals(VectorArray& out, ThreadPool& pool = ThreadPool::global()) const;
+
+    // unit normal of each vertex: the sum of the normals of the triangles
+    // using it, weighted by their area. ( 0, 0, 0 ) for a vertex no
+    // triangle uses.
+    void vertexNormals(VectorArray& out, ThreadPool& pool = ThreadPool::global()) const;
+
+    double surfaceArea(ThreadPool& pool = ThreadPool::global()) const;
+
+    // signed volume enclosed, positive when the triangles wind counter
+    // clockwise seen from outside. Only meaningful for a closed mesh.
+    double volume(ThreadPool& pool = ThreadPool::global()) const;
+
+private:
+    // twice the area times the unit normal of triangle t
+    Vector areaNormal(std::size_t t) const;
+
+    VectorArray positions;
+    std::vector<std::uint32_t> corners;       // 3 per triangle
+    std::vector<std::uint32_t> around;        // corners sorted by vertex
+    std::vector<std::uint32_t> aroundStart;   // first entry in around of each vertex, plus one
+};
+
+// indexed mesh from a triangle soup ( every 3 points are a triangle ),
+// merging corners within epsilon of each other as weld() does. Triangles
+// which welding collapses are kept, with no area.
+TriangleMesh weldMesh(VectorSpan soup, double epsilon, ThreadPool& pool = ThreadPool::global());
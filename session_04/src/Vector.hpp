@@ -3,32 +3,141 @@
 //
 #pragma once
 
+#include <cmath>
 
-struct Vector {
-    double x, y, z;
-    Vector();
-    Vector(double x_, double y_, double z_);
-    Vector operator+(const Vector& rhs) const;
-    Vector operator-(const Vector& rhs) const;
+#include "VectorExpr.hpp"
 
-    Vector& operator+=(const Vector& rhs);
-    Vector& operator-=(const Vector& rhs);
+//
+// BasicVector is header only and every operator is constexpr, so the
+// compiler can inline ( and often vectorize ) operator heavy loops instead
+// of calling into the vector shared library for each +, -, * and cross.
+// Vector stays a BasicVector<double>; Vectorf stores floats, which halves
+// the memory traffic for large point sets.
+//
+template <typename T>
+struct BasicVector {
+    using value_type = T;
+
+    T x, y, z;
+
+    constexpr BasicVector() : x{0}, y{0}, z{1} {}
+    constexpr BasicVector(T x_, T y_, T z_) : x{x_}, y{y_}, z{z_} {}
 
-    Vector operator*(const double d) const;
+    constexpr BasicVector operator+(const BasicVector& rhs) const {
+        return BasicVector(x + rhs.x, y + rhs.y, z + rhs.z);
+    }
+    constexpr BasicVector operator-(const BasicVector& rhs) const {
+        return BasicVector(x - rhs.x, y - rhs.y, z - rhs.z);
+    }
 
-    //friend Vector operator*(const Vector& v, const double  d);
-    friend Vector operator*(const double d, const Vector& v);
+    constexpr BasicVector& operator+=(const BasicVector& rhs) {
+        x += rhs.x;
+        y += rhs.y;
+        z += rhs.z;
+        return *this;
+    }
+    constexpr BasicVector& operator-=(const BasicVector& rhs) {
+        x -= rhs.x;
+        y -= rhs.y;
+        z -= rhs.z;
+        return *this;
+    }
+
+    constexpr BasicVector operator*(const T d) const {
+        return BasicVector(x * d, y * d, z * d);
+    }
+
+    friend constexpr BasicVector operator*(const T d, const BasicVector& v) {
+        return BasicVector(v.x * d, v.y * d, v.z * d);
+    }
 
     // dot product
-    double operator*(const Vector& rhs) const;
+    constexpr T operator*(const BasicVector& rhs) const {
+        return x * rhs.x + y * rhs.y + z * rhs.z;
+    }
 
     // cross product
-    Vector cross(const Vector& rhs) const;
+    constexpr BasicVector cross(const BasicVector& rhs) const {
+        return BasicVector(y * rhs.z - z * rhs.y,
+                           z * rhs.x - x * rhs.z,
+                           x * rhs.y - y * rhs.x);
+    }
+
+    constexpr bool operator==(const BasicVector& rhs) const {
+        return x == rhs.x && y == rhs.y && z == rhs.z;
+    }
+
+    // std::sqrt is not constexpr, so these two are merely inline
+    T length() const {
+        return std::sqrt(x * x + y * y + z * z);
+    }
 
-    bool operator==(const Vector& rhs) const;
+    void normalize() {
+        T len = length();
+        x /= len;
+        y /= len;
+        z /= len;
+    }
 
-    double length() const;
+    // evaluate an expression built with lazy() in a single pass
+    // ( see VectorExpr.hpp )
+    template <typename E>
+    BasicVector(const VectorExpr<E>& e);
+    template <typename E>
+    BasicVector& operator=(const VectorExpr<E>& e);
+};
+
+using Vector = BasicVector<double>;
+using Vectorf = BasicVector<float>;
+
+namespace vector_expr {
+
+// leaf node holding a copy of a single Vector. It broadcasts the same value
+// for every index, so it can be mixed with VectorArrays.
+struct VectorLeaf : VectorExpr<VectorLeaf> {
+    double vx, vy, vz;
+    static const bool array = false;
+    explicit VectorLeaf(const Vector& v) : vx(v.x), vy(v.y), vz(v.z) {}
+    double x(std::size_t) const { return vx; }
+    double y(std::size_t) const { return vy; }
+    double z(std::size_t) const { return vz; }
+    std::size_t size() const { return 0; }
+};
 
-    void normalize();
+template <>
+struct ExprTraits<Vector> {
+    static const bool operand = true;
+    using type = VectorLeaf;
+    static VectorLeaf wrap(const Vector& v) { return VectorLeaf(v); }
 };
 
+} // namespace vector_expr
+
+// opt a Vector into lazy evaluation: lazy(a) + lazy(b) * 2.0 - lazy(c)
+inline vector_expr::VectorLeaf lazy(const Vector& v) {
+    return vector_expr::VectorLeaf(v);
+}
+
+template <typename T>
+template <typename E>
+BasicVector<T>::BasicVector(const VectorExpr<E>& e) :
+    x{static_cast<T>(e.self().x(0))},
+    y{static_cast<T>(e.self().y(0))},
+    z{static_cast<T>(e.self().z(0))}
+{
+    static_assert(!E::array, "assign VectorArray expressions to a VectorArray");
+}
+
+template <typename T>
+template <typename E>
+BasicVector<T>& BasicVector<T>::operator=(const VectorExpr<E>& e) {
+    static_assert(!E::array, "assign VectorArray expressions to a VectorArray");
+    // evaluate before writing, e may refer to *this
+    T x_ = static_cast<T>(e.self().x(0));
+    T y_ = static_cast<T>(e.self().y(0));
+    T z_ = static_cast<T>(e.self().z(0));
+    x = x_;
+    y = y_;
+    z = z_;
+    return *this;
+}
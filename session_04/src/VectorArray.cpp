@@ -0,0 +1,220 @@
+//
+// VectorArray.cpp
+//
+
+#include "VectorArray.hpp"
+#include "Simd.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+using namespace simd;
+
+const std::size_t W = Pack::width;
+
+void checkSizes(const VectorArray& a, const VectorArray& b) {
+    if (a.size() != b.size())
+        throw std::invalid_argument("VectorArray size mismatch");
+}
+
+} // namespace
+
+VectorArray::VectorArray() {}
+
+VectorArray::VectorArray(std::size_t n) :
+    xs(n, 0.0),
+    ys(n, 0.0),
+    zs(n, 1.0)
+{}
+
+VectorArray::VectorArray(const std::vector<Vector>& vectors) :
+    xs(vectors.size()),
+    ys(vectors.size()),
+    zs(vectors.size())
+{
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        xs[i] = vectors[i].x;
+        ys[i] = vectors[i].y;
+        zs[i] = vectors[i].z;
+    }
+}
+
+std::vector<Vector> VectorArray::toVectors() const {
+    std::vector<Vector> result;
+    result.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i)
+        result.emplace_back(xs[i], ys[i], zs[i]);
+    return result;
+}
+
+void VectorArray::resize(std::size_t n) {
+    xs.resize(n, 0.0);
+    ys.resize(n, 0.0);
+    zs.resize(n, 1.0);
+}
+
+void VectorArray::reserve(std::size_t n) {
+    xs.reserve(n);
+    ys.reserve(n);
+    zs.reserve(n);
+}
+
+void VectorArray::clear() {
+    xs.clear();
+    ys.clear();
+    zs.clear();
+}
+
+void VectorArray::push_back(const Vector& v) {
+    xs.push_back(v.x);
+    ys.push_back(v.y);
+    zs.push_back(v.z);
+}
+
+void VectorArray::set(std::size_t i, const Vector& v) {
+    xs[i] = v.x;
+    ys[i] = v.y;
+    zs[i] = v.z;
+}
+
+void add(const VectorArray& a, const VectorArray& b, VectorArray& out) {
+    checkSizes(a, b);
+    const std::size_t n = a.size();
+    out.resize(n);
+    const double* ax = a.x(); const double* ay = a.y(); const double* az = a.z();
+    const double* bx = b.x(); const double* by = b.y(); const double* bz = b.z();
+    double* ox = out.x(); double* oy = out.y(); double* oz = out.z();
+
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        store(ox + i, load(ax + i) + load(bx + i));
+        store(oy + i, load(ay + i) + load(by + i));
+        store(oz + i, load(az + i) + load(bz + i));
+    }
+    for (; i < n; ++i) {
+        ox[i] = ax[i] + bx[i];
+        oy[i] = ay[i] + by[i];
+        oz[i] = az[i] + bz[i];
+    }
+}
+
+void sub(const VectorArray& a, const VectorArray& b, VectorArray& out) {
+    checkSizes(a, b);
+    const std::size_t n = a.size();
+    out.resize(n);
+    const double* ax = a.x(); const double* ay = a.y(); const double* az = a.z();
+    const double* bx = b.x(); const double* by = b.y(); const double* bz = b.z();
+    double* ox = out.x(); double* oy = out.y(); double* oz = out.z();
+
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        store(ox + i, load(ax + i) - load(bx + i));
+        store(oy + i, load(ay + i) - load(by + i));
+        store(oz + i, load(az + i) - load(bz + i));
+    }
+    for (; i < n; ++i) {
+        ox[i] = ax[i] - bx[i];
+        oy[i] = ay[i] - by[i];
+        oz[i] = az[i] - bz[i];
+    }
+}
+
+void scale(const VectorArray& a, double d, VectorArray& out) {
+    const std::size_t n = a.size();
+    out.resize(n);
+    const double* ax = a.x(); const double* ay = a.y(); const double* az = a.z();
+    double* ox = out.x(); double* oy = out.y(); double* oz = out.z();
+
+    const Pack dd = broadcast(d);
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        store(ox + i, load(ax + i) * dd);
+        store(oy + i, load(ay + i) * dd);
+        store(oz + i, load(az + i) * dd);
+    }
+    for (; i < n; ++i) {
+        ox[i] = ax[i] * d;
+        oy[i] = ay[i] * d;
+        oz[i] = az[i] * d;
+    }
+}
+
+void dot(const VectorArray& a, const VectorArray& b, std::vector<double>& out) {
+    checkSizes(a, b);
+    const std::size_t n = a.size();
+    out.resize(n);
+    const double* ax = a.x(); const double* ay = a.y(); const double* az = a.z();
+    const double* bx = b.x(); const double* by = b.y(); const double* bz = b.z();
+    double* o = out.data();
+
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        store(o + i, load(ax + i) * load(bx + i)
+                   + load(ay + i) * load(by + i)
+                   + load(az + i) * load(bz + i));
+    }
+    for (; i < n; ++i)
+        o[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+}
+
+void cross(const VectorArray& a, const VectorArray& b, VectorArray& out) {
+    checkSizes(a, b);
+    const std::size_t n = a.size();
+    out.resize(n);
+    const double* ax = a.x(); const double* ay = a.y(); const double* az = a.z();
+    const double* bx = b.x(); const double* by = b.y(); const double* bz = b.z();
+    double* ox = out.x(); double* oy = out.y(); double* oz = out.z();
+
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        // load everything first; out may alias a or b
+        Pack x1 = load(ax + i), y1 = load(ay + i), z1 = load(az + i);
+        Pack x2 = load(bx + i), y2 = load(by + i), z2 = load(bz + i);
+        store(ox + i, y1 * z2 - z1 * y2);
+        store(oy + i, z1 * x2 - x1 * z2);
+        store(oz + i, x1 * y2 - y1 * x2);
+    }
+    for (; i < n; ++i) {
+        double x1 = ax[i], y1 = ay[i], z1 = az[i];
+        double x2 = bx[i], y2 = by[i], z2 = bz[i];
+        ox[i] = y1 * z2 - z1 * y2;
+        oy[i] = z1 * x2 - x1 * z2;
+        oz[i] = x1 * y2 - y1 * x2;
+    }
+}
+
+void length(const VectorArray& a, std::vector<double>& out) {
+    const std::size_t n = a.size();
+    out.resize(n);
+    const double* ax = a.x(); const double* ay = a.y(); const double* az = a.z();
+    double* o = out.data();
+
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        Pack x = load(ax + i), y = load(ay + i), z = load(az + i);
+        store(o + i, sqrt(x * x + y * y + z * z));
+    }
+    for (; i < n; ++i)
+        o[i] = std::sqrt(ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i]);
+}
+
+void normalize(VectorArray& a) {
+    const std::size_t n = a.size();
+    double* ax = a.x(); double* ay = a.y(); double* az = a.z();
+
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        Pack x = load(ax + i), y = load(ay + i), z = load(az + i);
+        Pack len = sqrt(x * x + y * y + z * z);
+        store(ax + i, x / len);
+        store(ay + i, y / len);
+        store(az + i, z / len);
+    }
+    for (; i < n; ++i) {
+        double len = std::sqrt(ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i]);
+        ax[i] /= len;
+        ay[i] /= len;
+        az[i] /= len;
+    }
+}
@@ -0,0 +1,142 @@
+//
+// VectorArray.hpp
+//
+// Structure-of-arrays storage for large numbers of Vectors. Rather than
+// storing x,y,z,x,y,z,... the way std::vector<Vector> does, VectorArray
+// keeps three separate, 32 byte aligned streams (all the x's, then all the
+// y's, then all the z's). That layout lets the batch kernels below process
+// 2 (SSE2) or 4 (AVX2) Vectors per instruction.
+//
+// VectorArrays also take part in the expressions from VectorExpr.hpp, so
+// out = a + k * b runs as a single streaming pass with no temporaries.
+//
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "AlignedAllocator.hpp"
+#include "Vector.hpp"
+
+class VectorArray {
+public:
+    static const std::size_t alignment = 32;
+    using Stream = std::vector<double, AlignedAllocator<double, alignment>>;
+
+    VectorArray();
+    // n default constructed Vectors ( 0, 0, 1 )
+    explicit VectorArray(std::size_t n);
+    VectorArray(const std::vector<Vector>& vectors);
+
+    // evaluate an expression element by element ( see VectorExpr.hpp )
+    template <typename E>
+    VectorArray(const VectorExpr<E>& e);
+    template <typename E>
+    VectorArray& operator=(const VectorExpr<E>& e);
+
+    std::vector<Vector> toVectors() const;
+
+    std::size_t size() const { return xs.size(); }
+    bool empty() const { return xs.empty(); }
+
+    void resize(std::size_t n);
+    void reserve(std::size_t n);
+    void clear();
+    void push_back(const Vector& v);
+
+    Vector operator[](std::size_t i) const { return Vector(xs[i], ys[i], zs[i]); }
+    void set(std::size_t i, const Vector& v);
+
+    // raw access to the individual streams
+    double* x() { return xs.data(); }
+    double* y() { return ys.data(); }
+    double* z() { return zs.data(); }
+    const double* x() const { return xs.data(); }
+    const double* y() const { return ys.data(); }
+    const double* z() const { return zs.data(); }
+
+private:
+    Stream xs, ys, zs;
+};
+
+namespace vector_expr {
+
+// leaf node reading element i straight out of a VectorArray's streams
+struct ArrayLeaf : VectorExpr<ArrayLeaf> {
+    const double* px;
+    const double* py;
+    const double* pz;
+    std::size_t n;
+    static const bool array = true;
+    explicit ArrayLeaf(const VectorArray& a) : px(a.x()), py(a.y()), pz(a.z()), n(a.size()) {}
+    double x(std::size_t i) const { return px[i]; }
+    double y(std::size_t i) const { return py[i]; }
+    double z(std::size_t i) const { return pz[i]; }
+    std::size_t size() const { return n; }
+};
+
+template <>
+struct ExprTraits<VectorArray> {
+    static const bool operand = true;
+    using type = ArrayLeaf;
+    static ArrayLeaf wrap(const VectorArray& a) { return ArrayLeaf(a); }
+};
+
+} // namespace vector_expr
+
+template <typename E>
+VectorArray::VectorArray(const VectorExpr<E>& e) {
+    *this = e;
+}
+
+template <typename E>
+VectorArray& VectorArray::operator=(const VectorExpr<E>& expr) {
+    static_assert(E::array, "expression contains no VectorArray");
+    const E& e = expr.self();
+    const std::size_t n = e.size();
+    // if *this is one of the operands it already has n elements, so this
+    // never reallocates a stream the expression is reading from
+    resize(n);
+    // one pass per stream; element i only depends on element i of the
+    // operands, so evaluating in place ( a = a + b ) is safe
+    double* ox = xs.data();
+    double* oy = ys.data();
+    double* oz = zs.data();
+    for (std::size_t i = 0; i < n; ++i)
+        ox[i] = e.x(i);
+    for (std::size_t i = 0; i < n; ++i)
+        oy[i] = e.y(i);
+    for (std::size_t i = 0; i < n; ++i)
+        oz[i] = e.z(i);
+    return *this;
+}
+
+//
+// batch kernels
+//
+// Each kernel applies the matching Vector operation element by element.
+// The output array is resized to match the input, and may be the same
+// object as one of the inputs. Binary kernels throw std::invalid_argument
+// if the inputs differ in size.
+//
+
+// out[i] = a[i] + b[i]
+void add(const VectorArray& a, const VectorArray& b, VectorArray& out);
+
+// out[i] = a[i] - b[i]
+void sub(const VectorArray& a, const VectorArray& b, VectorArray& out);
+
+// out[i] = a[i] * d
+void scale(const VectorArray& a, double d, VectorArray& out);
+
+// out[i] = a[i] * b[i]  ( dot product )
+void dot(const VectorArray& a, const VectorArray& b, std::vector<double>& out);
+
+// out[i] = a[i].cross(b[i])
+void cross(const VectorArray& a, const VectorArray& b, VectorArray& out);
+
+// out[i] = a[i].length()
+void length(const VectorArray& a, std::vector<double>& out);
+
+// a[i].normalize() for every element
+void normalize(VectorArray& a);
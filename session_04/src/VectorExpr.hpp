@@ -0,0 +1,144 @@
+//
+// VectorExpr.hpp
+//
+// Expression templates for Vector arithmetic. Instead of computing a + b
+// into a temporary Vector and then adding c to that, operators on
+// expressions return a lightweight node describing the computation. The
+// whole tree is evaluated in one pass when it is assigned to a Vector or a
+// VectorArray:
+//
+//     VectorArray out = a + k * b;       // one streaming loop, no temporaries
+//     Vector v = lazy(a) + lazy(b) * 2.0 - lazy(c);
+//
+// Vector's own member operators are left alone ( Vector + Vector still
+// returns a Vector ), so lazy() is how a single Vector opts in. As soon as
+// one operand is an expression or a VectorArray, the operators below take
+// over.
+//
+// Nodes capture their operands by reference, so an expression must not
+// outlive the Vectors and VectorArrays it was built from. Assign it
+// straight away rather than keeping it around in an auto variable.
+//
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+template <typename T>
+struct BasicVector;
+using Vector = BasicVector<double>;
+
+//
+// CRTP base for every expression node. E must provide
+//   double x(std::size_t i) const; ( and y, z )
+//   std::size_t size() const;      elements covered, when array is true
+//   static const bool array;       true if any leaf is a VectorArray; a
+//                                  node without one is a single Vector,
+//                                  which broadcasts
+//
+template <typename E>
+struct VectorExpr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+namespace vector_expr {
+
+// number of elements l op r covers. Only a side without a VectorArray
+// broadcasts; two arrays must match, an empty one included.
+template <typename L, typename R>
+std::size_t combineSizes(const L& l, const R& r) {
+    if (!L::array)
+        return r.size();
+    if (!R::array || l.size() == r.size())
+        return l.size();
+    throw std::invalid_argument("VectorArray size mismatch in expression");
+}
+
+// ExprTraits<T> maps an operand type to the expression node which wraps it.
+// Vector and VectorArray specialize it in their own headers.
+template <typename T, typename Enable = void>
+struct ExprTraits {
+    static const bool operand = false;
+};
+
+template <typename T>
+struct ExprTraits<T, typename std::enable_if<std::is_base_of<VectorExpr<T>, T>::value>::type> {
+    static const bool operand = true;
+    using type = T;
+    static const T& wrap(const T& t) { return t; }
+};
+
+template <typename T>
+using ExprType = typename ExprTraits<T>::type;
+
+// true when the operators below should handle (L, R). Vector op Vector is
+// left to Vector's own operators.
+template <typename L, typename R>
+struct UseExpr : std::integral_constant<bool,
+        ExprTraits<L>::operand && ExprTraits<R>::operand &&
+        !(std::is_same<L, Vector>::value && std::is_same<R, Vector>::value)> {};
+
+template <typename L, typename R>
+struct Sum : VectorExpr<Sum<L, R>> {
+    L l;
+    R r;
+    static const bool array = L::array || R::array;
+    Sum(const L& l_, const R& r_) : l(l_), r(r_) {}
+    double x(std::size_t i) const { return l.x(i) + r.x(i); }
+    double y(std::size_t i) const { return l.y(i) + r.y(i); }
+    double z(std::size_t i) const { return l.z(i) + r.z(i); }
+    std::size_t size() const { return combineSizes(l, r); }
+};
+
+template <typename L, typename R>
+struct Difference : VectorExpr<Difference<L, R>> {
+    L l;
+    R r;
+    static const bool array = L::array || R::array;
+    Difference(const L& l_, const R& r_) : l(l_), r(r_) {}
+    double x(std::size_t i) const { return l.x(i) - r.x(i); }
+    double y(std::size_t i) const { return l.y(i) - r.y(i); }
+    double z(std::size_t i) const { return l.z(i) - r.z(i); }
+    std::size_t size() const { return combineSizes(l, r); }
+};
+
+template <typename E>
+struct Scaled : VectorExpr<Scaled<E>> {
+    E e;
+    double d;
+    static const bool array = E::array;
+    Scaled(const E& e_, double d_) : e(e_), d(d_) {}
+    double x(std::size_t i) const { return e.x(i) * d; }
+    double y(std::size_t i) const { return e.y(i) * d; }
+    double z(std::size_t i) const { return e.z(i) * d; }
+    std::size_t size() const { return e.size(); }
+};
+
+} // namespace vector_expr
+
+template <typename L, typename R,
+          typename = typename std::enable_if<vector_expr::UseExpr<L, R>::value>::type>
+vector_expr::Sum<vector_expr::ExprType<L>, vector_expr::ExprType<R>>
+operator+(const L& l, const R& r) {
+    return {vector_expr::ExprTraits<L>::wrap(l), vector_expr::ExprTraits<R>::wrap(r)};
+}
+
+template <typename L, typename R,
+          typename = typename std::enable_if<vector_expr::UseExpr<L, R>::value>::type>
+vector_expr::Difference<vector_expr::ExprType<L>, vector_expr::ExprType<R>>
+operator-(const L& l, const R& r) {
+    return {vector_expr::ExprTraits<L>::wrap(l), vector_expr::ExprTraits<R>::wrap(r)};
+}
+
+template <typename E,
+          typename = typename std::enable_if<vector_expr::UseExpr<E, E>::value>::type>
+vector_expr::Scaled<vector_expr::ExprType<E>> operator*(const E& e, double d) {
+    return {vector_expr::ExprTraits<E>::wrap(e), d};
+}
+
+template <typename E,
+          typename = typename std::enable_if<vector_expr::UseExpr<E, E>::value>::type>
+vector_expr::Scaled<vector_expr::ExprType<E>> operator*(double d, const E& e) {
+    return {vector_expr::ExprTraits<E>::wrap(e), d};
+}
@@ -0,0 +1,38 @@
+//
+// VectorSpan.hpp
+//
+// Non owning view of a contiguous run of Vectors, for memory the caller
+// does not hold in a std::vector ( a mapped file, part of a bigger array ).
+//
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Vector.hpp"
+
+struct VectorSpan {
+    const Vector* ptr;
+    std::size_t count;
+
+    VectorSpan() : ptr{nullptr}, count{0} {}
+    VectorSpan(const Vector* p, std::size_t n) : ptr{p}, count{n} {}
+    VectorSpan(const std::vector<Vector>& v) : ptr{v.data()}, count{v.size()} {}
+
+    const Vector* data() const { return ptr; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const Vector* begin() const { return ptr; }
+    const Vector* end() const { return ptr + count; }
+    const Vector& operator[](std::size_t i) const { return ptr[i]; }
+
+    // elements [offset, offset + n), clamped to the end of the span
+    VectorSpan subspan(std::size_t offset, std::size_t n) const {
+        if (offset > count)
+            offset = count;
+        if (n > count - offset)
+            n = count - offset;
+        return VectorSpan(ptr + offset, n);
+    }
+};
@@ -0,0 +1,126 @@
+//
+// Tests for convexHull
+//
+
+#include "gtest/gtest.h"
+#include "../src/ConvexHull.hpp"
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::vector<Vector> cubeCloud(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<Vector> points(n);
+    for (Vector& p : points)
+        p = Vector(dist(rng), dist(rng), dist(rng));
+    return points;
+}
+
+std::vector<Vector> ballCloud(std::size_t n, unsigned seed) {
+    std::vector<Vector> points;
+    for (const Vector& p : cubeCloud(2 * n, seed))
+        if (p * p <= 1 && points.size() < n)
+            points.push_back(p);
+    return points;
+}
+
+// every point ( or every stride'th ) is on or below every face, and every
+// edge is shared by exactly two faces, running opposite ways
+void expectHull(const std::vector<Vector>& points, const std::vector<std::uint32_t>& indices,
+                std::size_t stride = 1) {
+    ASSERT_EQ(0u, indices.size() % 3);
+    ASSERT_GE(indices.size(), 12u);
+    std::map<std::pair<std::uint32_t, std::uint32_t>, int> edges;
+    for (std::size_t t = 0; t < indices.size(); t += 3) {
+        const Vector& a = points[indices[t]];
+        Vector normal = (points[indices[t + 1]] - a).cross(points[indices[t + 2]] - a);
+        normal = normal * (1.0 / normal.length());
+        for (std::size_t i = 0; i < points.size(); i += stride)
+            ASSERT_LE(normal * (points[i] - a), 1e-9);
+        for (int k = 0; k < 3; ++k)
+            ++edges[std::make_pair(indices[t + k], indices[t + (k + 1) % 3])];
+    }
+    for (const auto& e : edges) {
+        EXPECT_EQ(1, e.second);
+        EXPECT_EQ(1u, edges.count(std::make_pair(e.first.second, e.first.first)));
+    }
+}
+
+}
+
+TEST(ConvexHull, tetrahedron) {
+    const std::vector<Vector> points{Vector(0, 0, 0), Vector(1, 0, 0), Vector(0, 1, 0), Vector(0, 0, 1),
+                                     Vector(0.1, 0.1, 0.1)};
+    const auto indices = convexHullIndices(points);
+    EXPECT_EQ(12u, indices.size());
+    expectHull(points, indices);
+    const TriangleMesh mesh = convexHull(points);
+    EXPECT_EQ(4u, mesh.vertexCount());
+    EXPECT_NEAR(1.0 / 6.0, mesh.volume(), 1e-15);
+}
+
+TEST(ConvexHull, cube) {
+    // corners of a cube, with points inside and on its faces
+    auto points = cubeCloud(5000, 1);
+    for (int i = 0; i < 8; ++i)
+        points.push_back(Vector(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1));
+    for (int i = 0; i < 100; ++i)
+        points.push_back(Vector(1, points[i].y, points[i].z));
+    const TriangleMesh mesh = convexHull(points);
+    EXPECT_EQ(8u, mesh.vertexCount());
+    EXPECT_EQ(12u, mesh.triangleCount());
+    EXPECT_NEAR(8.0, mesh.volume(), 1e-12);
+    EXPECT_NEAR(24.0, mesh.surfaceArea(), 1e-12);
+}
+
+TEST(ConvexHull, randomClouds) {
+    for (unsigned seed = 1; seed <= 3; ++seed) {
+        const auto cube = cubeCloud(3000, seed);
+        expectHull(cube, convexHullIndices(cube));
+        const auto ball = ballCloud(3000, seed);
+        expectHull(ball, convexHullIndices(ball));
+    }
+}
+
+TEST(ConvexHull, sphere) {
+    // every point of a sphere is on the hull
+    std::mt19937 rng(7);
+    std::normal_distribution<double> normal;
+    std::vector<Vector> points(2000);
+    for (Vector& p : points) {
+        p = Vector(normal(rng), normal(rng), normal(rng));
+        p.normalize();
+    }
+    const TriangleMesh mesh = convexHull(points);
+    EXPECT_EQ(points.size(), mesh.vertexCount());
+    EXPECT_EQ(2 * points.size() - 4, mesh.triangleCount());
+    EXPECT_GT(mesh.volume(), 4.1);
+    EXPECT_LT(mesh.volume(), 4.0 / 3.0 * M_PI);
+}
+
+TEST(ConvexHull, manyChunks) {
+    // enough points for the cull and the per chunk hulls to matter
+    const auto points = ballCloud(300000, 11);
+    const auto indices = convexHullIndices(points);
+    expectHull(points, indices, 101);
+
+    ThreadPool one(0), four(4);
+    EXPECT_EQ(convexHullIndices(points, one), convexHullIndices(points, four));
+    EXPECT_EQ(indices, convexHullIndices(points, one));
+}
+
+TEST(ConvexHull, flat) {
+    std::vector<Vector> plane;
+    for (int i = 0; i < 100; ++i)
+        plane.push_back(Vector(i % 10, i / 10, 2.0));
+    EXPECT_THROW(convexHull(plane), std::invalid_argument);
+    EXPECT_THROW(convexHull(std::vector<Vector>(3, Vector(1, 2, 3))), std::invalid_argument);
+    EXPECT_THROW(convexHull(std::vector<Vector>()), std::invalid_argument);
+}
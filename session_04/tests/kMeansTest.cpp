@@ -0,0 +1,179 @@
+//
+// Tests for kMeans
+//
+
+#include "gtest/gtest.h"
+#include "../src/KMeans.hpp"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::vector<Vector> randomPoints(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<Vector> points(n);
+    for (Vector& p : points)
+        p = Vector(dist(rng), dist(rng), dist(rng));
+    return points;
+}
+
+// plain Lloyd iterations, scanning every center for every point
+KMeansResult lloyd(const std::vector<Vector>& points, std::vector<Vector> centers, std::size_t maxIterations) {
+    KMeansResult result;
+    result.labels.assign(points.size(), 0);
+    result.converged = false;
+    for (std::size_t iteration = 0; iteration < maxIterations; ++iteration) {
+        std::size_t changed = 0;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            std::uint32_t best = 0;
+            for (std::uint32_t j = 1; j < centers.size(); ++j) {
+                const Vector a = points[i] - centers[j], b = points[i] - centers[best];
+                if (a * a < b * b)
+                    best = j;
+            }
+            changed += best != result.labels[i];
+            result.labels[i] = best;
+        }
+        result.iterations = iteration + 1;
+        if (iteration > 0 && changed == 0) {
+            result.converged = true;
+            break;
+        }
+        if (iteration + 1 == maxIterations)
+            break;
+        std::vector<Vector> sums(centers.size(), Vector(0, 0, 0));
+        std::vector<double> counts(centers.size());
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            sums[result.labels[i]] += points[i];
+            counts[result.labels[i]] += 1;
+        }
+        for (std::size_t j = 0; j < centers.size(); ++j)
+            if (counts[j] > 0)
+                centers[j] = sums[j] * (1.0 / counts[j]);
+    }
+    result.centers = centers;
+    return result;
+}
+
+}
+
+TEST(KMeans, separatedClusters) {
+    const std::vector<Vector> middles{Vector(0, 0, 0), Vector(10, 0, 0), Vector(0, 10, 0), Vector(0, 0, 10)};
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> dist(-0.5, 0.5);
+    std::vector<Vector> points;
+    for (int i = 0; i < 1000; ++i)
+        points.push_back(middles[i % 4] + Vector(dist(rng), dist(rng), dist(rng)));
+
+    const KMeansResult result = kMeans(points, 4);
+    EXPECT_TRUE(result.converged);
+    ASSERT_EQ(4u, result.centers.size());
+    // every cluster is exactly one of the blobs
+    for (std::size_t i = 4; i < points.size(); ++i)
+        EXPECT_EQ(result.labels[i % 4], result.labels[i]);
+    for (const Vector& m : middles) {
+        double closest = 1e300;
+        for (const Vector& c : result.centers)
+            closest = std::min(closest, (c - m).length());
+        EXPECT_LT(closest, 0.1);
+    }
+}
+
+TEST(KMeans, matchesLloyd) {
+    const auto points = randomPoints(5000, 1);
+    for (std::size_t k : {2u, 7u, 33u}) {
+        const auto seeds = kMeansPlusPlus(points, k, 5);
+        const KMeansResult fast = kMeans(points, seeds);
+        const KMeansResult slow = lloyd(points, seeds, 100);
+        EXPECT_EQ(slow.iterations, fast.iterations);
+        EXPECT_EQ(slow.converged, fast.converged);
+        EXPECT_EQ(slow.labels, fast.labels);
+        for (std::size_t j = 0; j < k; ++j)
+            EXPECT_NEAR(0.0, (slow.centers[j] - fast.centers[j]).length(), 1e-12);
+        // and the bounds saved most of the work
+        EXPECT_LT(fast.distances, fast.iterations * points.size() * k / 2);
+    }
+}
+
+TEST(KMeans, inertia) {
+    const auto points = randomPoints(3000, 2);
+    const KMeansResult result = kMeans(points, 5);
+    double inertia = 0;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const Vector d = points[i] - result.centers[result.labels[i]];
+        inertia += d * d;
+    }
+    EXPECT_NEAR(inertia, result.inertia, 1e-9 * inertia);
+}
+
+TEST(KMeans, sameOnAnyPool) {
+    const auto points = randomPoints(100000, 4);
+    ThreadPool one(0), four(4);
+    KMeansOptions options;
+    options.seedSample = 20000;
+    const KMeansResult a = kMeans(points, 24, options, one);
+    const KMeansResult b = kMeans(points, 24, options, four);
+    EXPECT_EQ(a.labels, b.labels);
+    EXPECT_EQ(a.iterations, b.iterations);
+    EXPECT_EQ(a.inertia, b.inertia);
+    for (std::size_t j = 0; j < a.centers.size(); ++j) {
+        EXPECT_EQ(a.centers[j].x, b.centers[j].x);
+        EXPECT_EQ(a.centers[j].y, b.centers[j].y);
+        EXPECT_EQ(a.centers[j].z, b.centers[j].z);
+    }
+}
+
+TEST(KMeans, maxIterations) {
+    const auto points = randomPoints(2000, 5);
+    KMeansOptions options;
+    options.maxIterations = 2;
+    const KMeansResult result = kMeans(points, 50, options);
+    EXPECT_EQ(2u, result.iterations);
+    EXPECT_FALSE(result.converged);
+    // the labels belong to the centers returned
+    options.maxIterations = 1;
+    const KMeansResult again = kMeans(points, result.centers, options);
+    EXPECT_EQ(result.labels, again.labels);
+}
+
+TEST(KMeans, edgeCases) {
+    const auto points = randomPoints(50, 6);
+
+    const KMeansResult one = kMeans(points, 1);
+    Vector mean(0, 0, 0);
+    for (const Vector& p : points)
+        mean += p;
+    mean = mean * (1.0 / points.size());
+    EXPECT_NEAR(0.0, (one.centers[0] - mean).length(), 1e-12);
+
+    // a center per point: every point is its own cluster
+    const KMeansResult all = kMeans(points, points.size());
+    EXPECT_NEAR(0.0, all.inertia, 1e-24);
+
+    // duplicated points leave clusters empty, which keep their center
+    const std::vector<Vector> same(10, Vector(1, 2, 3));
+    const KMeansResult dup = kMeans(same, 3);
+    EXPECT_EQ(0.0, dup.inertia);
+    EXPECT_TRUE(dup.converged);
+
+    EXPECT_THROW(kMeans(points, 0), std::invalid_argument);
+    EXPECT_THROW(kMeans(points, points.size() + 1), std::invalid_argument);
+    EXPECT_THROW(kMeansPlusPlus(points, 0), std::invalid_argument);
+}
+
+TEST(KMeans, seedsAreSpread) {
+    // k-means++ never picks a point already covered by a center
+    std::vector<Vector> points;
+    for (int i = 0; i < 6; ++i)
+        for (int j = 0; j < 100; ++j)
+            points.push_back(Vector(100.0 * i, 0, 0));
+    const auto seeds = kMeansPlusPlus(points, 6, 9);
+    std::vector<bool> seen(6);
+    for (const Vector& s : seeds)
+        seen[static_cast<int>(s.x / 100.0)] = true;
+    EXPECT_EQ(std::vector<bool>(6, true), seen);
+}
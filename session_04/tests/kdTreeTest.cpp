@@ -0,0 +1,121 @@
+//
+// Tests for KdTree, checked against brute force search
+//
+
+#include "gtest/gtest.h"
+#include "../src/KdTree.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<Vector> randomCloud(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    std::vector<Vector> result;
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(Vector(dist(rng), dist(rng), dist(rng)));
+    return result;
+}
+
+std::vector<KdTree::Neighbour> bruteForce(const std::vector<Vector>& points, const Vector& q) {
+    std::vector<KdTree::Neighbour> result;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        Vector d = points[i] - q;
+        result.push_back(KdTree::Neighbour{static_cast<std::uint32_t>(i), d * d});
+    }
+    std::sort(result.begin(), result.end(), [](const KdTree::Neighbour& a, const KdTree::Neighbour& b) {
+        return a.distanceSquared < b.distanceSquared;
+    });
+    return result;
+}
+
+}
+
+TEST(KdTree, empty) {
+    KdTree tree(std::vector<Vector>{});
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(KdTree::none, tree.nearest(Vector{}).index);
+    EXPECT_TRUE(tree.kNearest(Vector{}, 3).empty());
+}
+
+TEST(KdTree, nearest_matches_brute_force) {
+    ThreadPool pool(3);
+    auto points = randomCloud(5000, 1);
+    KdTree tree(points, pool, 8);
+    ASSERT_EQ(points.size(), tree.size());
+
+    for (const auto& q : randomCloud(200, 2)) {
+        auto expect = bruteForce(points, q)[0];
+        auto found = tree.nearest(q);
+        EXPECT_EQ(expect.index, found.index);
+        EXPECT_DOUBLE_EQ(expect.distanceSquared, found.distanceSquared);
+    }
+}
+
+TEST(KdTree, k_nearest_matches_brute_force) {
+    auto points = randomCloud(3000, 3);
+    KdTree tree(points);
+
+    for (const auto& q : randomCloud(50, 4)) {
+        auto expect = bruteForce(points, q);
+        auto found = tree.kNearest(q, 10);
+        ASSERT_EQ(10u, found.size());
+        for (std::size_t i = 0; i < found.size(); ++i)
+            EXPECT_DOUBLE_EQ(expect[i].distanceSquared, found[i].distanceSquared);
+    }
+}
+
+TEST(KdTree, k_larger_than_tree) {
+    auto points = randomCloud(5, 5);
+    KdTree tree(points);
+    EXPECT_EQ(5u, tree.kNearest(Vector{}, 10).size());
+}
+
+TEST(KdTree, radius_matches_brute_force) {
+    auto points = randomCloud(4000, 6);
+    KdTree tree(points);
+    const double radius = 2.5;
+
+    for (const auto& q : randomCloud(50, 7)) {
+        auto expect = bruteForce(points, q);
+        auto count = std::count_if(expect.begin(), expect.end(), [&](const KdTree::Neighbour& n) {
+            return n.distanceSquared <= radius * radius;
+        });
+        auto found = tree.withinRadius(q, radius);
+        ASSERT_EQ(static_cast<std::size_t>(count), found.size());
+        for (std::size_t i = 0; i < found.size(); ++i)
+            EXPECT_DOUBLE_EQ(expect[i].distanceSquared, found[i].distanceSquared);
+    }
+}
+
+TEST(KdTree, duplicate_points) {
+    std::vector<Vector> points(100, Vector{1, 2, 3});
+    KdTree tree(points, ThreadPool::global(), 4);
+    EXPECT_EQ(100u, tree.withinRadius(Vector{1, 2, 3}, 0.0).size());
+    EXPECT_DOUBLE_EQ(0.0, tree.nearest(Vector{1, 2, 3}).distanceSquared);
+}
+
+TEST(KdTree, batched_queries) {
+    ThreadPool pool(2);
+    auto points = randomCloud(2000, 8);
+    auto queries = randomCloud(1000, 9);
+    KdTree tree(points, pool);
+
+    std::vector<KdTree::Neighbour> nearest, k;
+    std::vector<std::vector<KdTree::Neighbour>> within;
+    tree.nearest(queries.data(), queries.size(), nearest, pool);
+    tree.kNearest(queries.data(), queries.size(), 4, k, pool);
+    tree.withinRadius(queries.data(), queries.size(), 1.0, within, pool);
+
+    ASSERT_EQ(queries.size(), nearest.size());
+    ASSERT_EQ(queries.size() * 4, k.size());
+    ASSERT_EQ(queries.size(), within.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        EXPECT_EQ(tree.nearest(queries[i]).index, nearest[i].index);
+        EXPECT_EQ(nearest[i].index, k[i * 4].index);
+        EXPECT_EQ(tree.withinRadius(queries[i], 1.0).size(), within[i].size());
+    }
+}
@@ -0,0 +1,165 @@
+//
+// Tests for PointCloudWriter / PointCloudReader
+//
+
+#include "gtest/gtest.h"
+#include "../src/PointCloudFile.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+// a unique path in the temp directory, removed at the end of the test
+struct TempFile {
+    std::string path;
+    TempFile() {
+        char name[] = "/tmp/pointcloudXXXXXX";
+        int fd = mkstemp(name);
+        ::close(fd);
+        path = name;
+    }
+    ~TempFile() { std::remove(path.c_str()); }
+};
+
+std::vector<Vector> cloud(std::size_t n) {
+    std::vector<Vector> result;
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(Vector(i, -0.5 * i, 1.0 / (i + 1)));
+    return result;
+}
+
+}
+
+TEST(PointCloudFile, round_trip) {
+    TempFile tmp;
+    auto points = cloud(1000);
+    {
+        PointCloudWriter writer(tmp.path, true, 64);
+        // uneven appends, so some straddle checksum blocks
+        writer.append(points.data(), 10);
+        writer.append(points.data() + 10, 500);
+        writer.append(VectorSpan(points).subspan(510, 490));
+        EXPECT_EQ(1000u, writer.size());
+    }
+
+    PointCloudReader reader(tmp.path);
+    ASSERT_EQ(points.size(), reader.size());
+    EXPECT_EQ(1u, reader.header().version);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(reader.vectors().data()) % 4096);
+    for (std::size_t i = 0; i < points.size(); ++i)
+        EXPECT_TRUE(points[i] == reader.vectors()[i]);
+
+    EXPECT_TRUE(reader.hasChecksums());
+    EXPECT_EQ(16u, reader.blockCount());
+    EXPECT_EQ(1000u - 15 * 64, reader.block(15).size());
+    ThreadPool pool(2);
+    EXPECT_TRUE(reader.verify(pool));
+}
+
+TEST(PointCloudFile, empty) {
+    TempFile tmp;
+    PointCloudWriter(tmp.path).close();
+    PointCloudReader reader(tmp.path);
+    EXPECT_EQ(0u, reader.size());
+    EXPECT_TRUE(reader.verify());
+}
+
+TEST(PointCloudFile, moved_from) {
+    TempFile tmp;
+    auto points = cloud(100);
+    {
+        PointCloudWriter writer(tmp.path, true, 16);
+        writer.append(points.data(), points.size());
+    }
+
+    PointCloudReader reader(tmp.path);
+    PointCloudReader moved(std::move(reader));
+    EXPECT_EQ(100u, moved.size());
+    EXPECT_EQ(0u, reader.size());
+    EXPECT_EQ(0u, reader.vectors().size());
+    EXPECT_EQ(0u, reader.blockCount());
+    EXPECT_FALSE(reader.hasChecksums());
+    EXPECT_TRUE(reader.verify());
+
+    PointCloudReader assigned(tmp.path);
+    assigned = std::move(moved);
+    EXPECT_EQ(100u, assigned.size());
+    EXPECT_EQ(0u, moved.size());
+    EXPECT_TRUE(assigned.verify());
+}
+
+TEST(PointCloudFile, verify_block_out_of_range) {
+    TempFile tmp;
+    auto points = cloud(100);
+    {
+        PointCloudWriter writer(tmp.path, true, 16);
+        writer.append(points.data(), points.size());
+    }
+    PointCloudReader reader(tmp.path);
+    ASSERT_EQ(7u, reader.blockCount());
+    EXPECT_TRUE(reader.verifyBlock(6));
+    EXPECT_THROW(reader.verifyBlock(7), std::out_of_range);
+    EXPECT_THROW(reader.verifyBlock(1000), std::out_of_range);
+}
+
+TEST(PointCloudFile, without_checksums) {
+    TempFile tmp;
+    auto points = cloud(100);
+    {
+        PointCloudWriter writer(tmp.path, false);
+        writer.append(points.data(), points.size());
+    }
+    PointCloudReader reader(tmp.path);
+    EXPECT_FALSE(reader.hasChecksums());
+    EXPECT_TRUE(reader.verify());
+    EXPECT_TRUE(points.back() == reader.vectors()[99]);
+}
+
+TEST(PointCloudFile, detects_corruption) {
+    TempFile tmp;
+    auto points = cloud(300);
+    {
+        PointCloudWriter writer(tmp.path, true, 100);
+        writer.append(points.data(), points.size());
+    }
+    {
+        // flip a byte inside the second block
+        std::fstream f(tmp.path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(4096 + 150 * sizeof(Vector) + 3);
+        f.put('\x7f');
+    }
+    PointCloudReader reader(tmp.path);
+    EXPECT_TRUE(reader.verifyBlock(0));
+    EXPECT_FALSE(reader.verifyBlock(1));
+    EXPECT_TRUE(reader.verifyBlock(2));
+    EXPECT_FALSE(reader.verify());
+}
+
+TEST(PointCloudFile, rejects_bad_files) {
+    TempFile tmp;
+    {
+        std::ofstream f(tmp.path, std::ios::binary);
+        f << "this is not a point cloud, but it is longer than a header is....";
+    }
+    EXPECT_THROW(PointCloudReader{tmp.path}, std::runtime_error);
+    EXPECT_THROW(PointCloudReader{tmp.path + ".missing"}, std::runtime_error);
+}
+
+TEST(PointCloudFile, rejects_truncated) {
+    TempFile tmp;
+    auto points = cloud(200);
+    {
+        PointCloudWriter writer(tmp.path);
+        writer.append(points.data(), points.size());
+    }
+    ASSERT_EQ(0, ::truncate(tmp.path.c_str(), 4096 + 100 * sizeof(Vector)));
+    EXPECT_THROW(PointCloudReader{tmp.path}, std::runtime_error);
+}
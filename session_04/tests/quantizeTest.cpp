@@ -0,0 +1,143 @@
+//
+// Tests for QuantizedPoints and OctNormals
+//
+
+#include "gtest/gtest.h"
+#include "../src/Quantize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<Vector> randomCloud(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-50.0, 250.0);
+    std::vector<Vector> result;
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(Vector(dist(rng), dist(rng) * 0.1, dist(rng) * 3));
+    return result;
+}
+
+std::vector<Vector> randomNormals(std::size_t n) {
+    std::mt19937 rng(5);
+    std::normal_distribution<double> dist;
+    std::vector<Vector> result;
+    for (std::size_t i = 0; i < n; ++i) {
+        Vector v(dist(rng), dist(rng), dist(rng));
+        v.normalize();
+        result.push_back(v);
+    }
+    // the poles and the fold edges
+    result.push_back(Vector(0, 0, 1));
+    result.push_back(Vector(0, 0, -1));
+    result.push_back(Vector(1, 0, 0));
+    result.push_back(Vector(0, -1, 0));
+    return result;
+}
+
+void checkPoints(QuantizedPoints::Precision precision, std::size_t bytesPerPoint) {
+    ThreadPool pool(3);
+    auto points = randomCloud(70001, 1);
+    QuantizedPoints q(points, precision, pool);
+    ASSERT_EQ(points.size(), q.size());
+    EXPECT_EQ(points.size() * bytesPerPoint, q.bytes());
+
+    const Vector bound = q.maxError();
+    // allow for rounding in the decode arithmetic
+    const double slack = 1e-12;
+    auto decoded = q.toVectors(pool);
+    VectorArray soa;
+    q.decode(soa, pool);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        EXPECT_LE(std::abs(points[i].x - decoded[i].x), bound.x + slack);
+        EXPECT_LE(std::abs(points[i].y - decoded[i].y), bound.y + slack);
+        EXPECT_LE(std::abs(points[i].z - decoded[i].z), bound.z + slack);
+        EXPECT_TRUE(decoded[i] == q[i]);
+        EXPECT_TRUE(decoded[i] == soa[i]);
+    }
+}
+
+}
+
+TEST(QuantizedPoints, bits16) {
+    checkPoints(QuantizedPoints::Precision::Bits16, 6);
+}
+
+TEST(QuantizedPoints, bits21) {
+    checkPoints(QuantizedPoints::Precision::Bits21, 8);
+}
+
+TEST(QuantizedPoints, error_bound) {
+    std::vector<Vector> points{ {0, 0, 0}, {65535, 1, 2097151} };
+    QuantizedPoints q16(points, QuantizedPoints::Precision::Bits16);
+    EXPECT_DOUBLE_EQ(0.5, q16.maxError().x);
+    QuantizedPoints q21(points, QuantizedPoints::Precision::Bits21);
+    EXPECT_DOUBLE_EQ(0.5, q21.maxError().z);
+}
+
+TEST(QuantizedPoints, box_corners_exact) {
+    std::vector<Vector> points{ {-1, 2, 3}, {4, 5, 6}, {1.5, 3.5, 4.5} };
+    QuantizedPoints q(points, QuantizedPoints::Precision::Bits21);
+    EXPECT_TRUE(points[0] == q[0]);
+    EXPECT_DOUBLE_EQ(points[1].x, q[1].x);
+    EXPECT_DOUBLE_EQ(points[1].y, q[1].y);
+    EXPECT_DOUBLE_EQ(points[1].z, q[1].z);
+}
+
+TEST(QuantizedPoints, flat_axis_and_clamping) {
+    std::vector<Vector> points{ {0, 7, 0}, {1, 7, 1}, {2, 7, 9} };
+    BoundingBox box{Vector(0, 7, 0), Vector(2, 7, 2)};
+    QuantizedPoints q(points, box, QuantizedPoints::Precision::Bits16);
+    EXPECT_DOUBLE_EQ(7, q[1].y);
+    // outside the box, so clamped to it
+    EXPECT_DOUBLE_EQ(2, q[2].z);
+}
+
+TEST(QuantizedPoints, empty) {
+    QuantizedPoints q(std::vector<Vector>{}, QuantizedPoints::Precision::Bits16);
+    EXPECT_EQ(0u, q.size());
+    EXPECT_TRUE(q.toVectors().empty());
+}
+
+TEST(OctNormals, within_error_bound) {
+    ThreadPool pool(2);
+    auto normals = randomNormals(100000);
+    OctNormals oct(normals, pool);
+    EXPECT_EQ(normals.size() * 4, oct.bytes());
+
+    std::vector<Vector> decoded(normals.size());
+    oct.decode(decoded.data(), pool);
+    double worst = 0;
+    for (std::size_t i = 0; i < normals.size(); ++i) {
+        EXPECT_NEAR(1.0, decoded[i].length(), 1e-12);
+        const double c = std::min(1.0, normals[i] * decoded[i]);
+        worst = std::max(worst, std::acos(c));
+        EXPECT_TRUE(decoded[i] == oct[i]);
+    }
+    EXPECT_LE(worst, OctNormals::maxAngularError());
+}
+
+TEST(OctNormals, both_decodes_agree) {
+    // an odd count, so the bulk loops have a scalar tail
+    auto normals = randomNormals(1001);
+    OctNormals oct(normals);
+    VectorArray streams;
+    oct.decode(streams);
+    ASSERT_EQ(normals.size(), streams.size());
+    for (std::size_t i = 0; i < normals.size(); ++i) {
+        EXPECT_TRUE(streams[i] == oct[i]);
+        EXPECT_LE(std::acos(std::min(1.0, normals[i] * oct[i])), OctNormals::maxAngularError());
+    }
+}
+
+TEST(OctNormals, poles) {
+    std::vector<Vector> normals{ {0, 0, 1}, {0, 0, -1} };
+    OctNormals oct(normals);
+    // 0 falls between two codes, so the poles are only exact to the bound
+    const double e = OctNormals::maxAngularError();
+    EXPECT_NEAR(1.0, oct[0].z, e * e);
+    EXPECT_NEAR(-1.0, oct[1].z, e * e);
+}
@@ -0,0 +1,124 @@
+//
+// Tests for the parallel reductions in Reduce.hpp
+//
+
+#include "gtest/gtest.h"
+#include "../src/Reduce.hpp"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::vector<Vector> randomCloud(std::size_t n) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> dist(-1e3, 1e3);
+    std::vector<Vector> result;
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(Vector(dist(rng), 0.5 * dist(rng) + 10, dist(rng) * 1e-3));
+    return result;
+}
+
+void expectIdentical(const Vector& a, const Vector& b) {
+    EXPECT_EQ(a.x, b.x);
+    EXPECT_EQ(a.y, b.y);
+    EXPECT_EQ(a.z, b.z);
+}
+
+}
+
+TEST(Reduce, sum_and_centroid) {
+    std::vector<Vector> points{ {1, 2, 3}, {4, 5, 6}, {-2, 2, 0} };
+    auto s = sum(points);
+    EXPECT_DOUBLE_EQ( 3, s.x);
+    EXPECT_DOUBLE_EQ( 9, s.y);
+    EXPECT_DOUBLE_EQ( 9, s.z);
+
+    auto c = centroid(points);
+    EXPECT_DOUBLE_EQ(1, c.x);
+    EXPECT_DOUBLE_EQ(3, c.y);
+    EXPECT_DOUBLE_EQ(3, c.z);
+}
+
+TEST(Reduce, empty) {
+    std::vector<Vector> none;
+    expectIdentical(Vector(0, 0, 0), sum(none));
+    EXPECT_TRUE(bounds(none).empty());
+    EXPECT_THROW(centroid(none), std::invalid_argument);
+    EXPECT_THROW(covariance(none), std::invalid_argument);
+}
+
+TEST(Reduce, bounds) {
+    std::vector<Vector> points{ {1, -2, 3}, {4, 5, -6}, {-2, 2, 0} };
+    auto box = bounds(points);
+    EXPECT_FALSE(box.empty());
+    expectIdentical(Vector(-2, -2, -6), box.min);
+    expectIdentical(Vector(4, 5, 3), box.max);
+}
+
+TEST(Reduce, bounds_of_array) {
+    // several chunks, with the extremes in different ones
+    std::vector<Vector> points;
+    for (int i = 0; i < 30000; ++i)
+        points.push_back(Vector(i % 7, -0.5 * i, 1.0 / (i + 1)));
+    const VectorArray array(points);
+    ThreadPool pool(3);
+    auto span = bounds(points, pool), box = bounds(array, pool);
+    expectIdentical(span.min, box.min);
+    expectIdentical(span.max, box.max);
+    EXPECT_TRUE(bounds(VectorArray()).empty());
+}
+
+TEST(Reduce, covariance) {
+    // points spread along x only
+    std::vector<Vector> points{ {-1, 7, 7}, {1, 7, 7}, {-1, 7, 7}, {1, 7, 7} };
+    auto c = covariance(points);
+    EXPECT_DOUBLE_EQ(1, c.xx);
+    EXPECT_DOUBLE_EQ(0, c.yy);
+    EXPECT_DOUBLE_EQ(0, c.zz);
+    EXPECT_DOUBLE_EQ(0, c.xy);
+    EXPECT_DOUBLE_EQ(c(0, 1), c(1, 0));
+
+    // perfectly correlated x and y
+    std::vector<Vector> line{ {0, 0, 0}, {1, 2, 0}, {2, 4, 0} };
+    c = covariance(line);
+    EXPECT_DOUBLE_EQ(2.0 / 3.0, c.xx);
+    EXPECT_DOUBLE_EQ(4.0 / 3.0, c.xy);
+    EXPECT_DOUBLE_EQ(8.0 / 3.0, c.yy);
+}
+
+TEST(Reduce, matches_serial) {
+    auto points = randomCloud(100003);
+    long double x = 0, y = 0, z = 0;
+    for (const auto& p : points) {
+        x += p.x;
+        y += p.y;
+        z += p.z;
+    }
+    auto s = sum(points);
+    EXPECT_NEAR(static_cast<double>(x), s.x, 1e-6);
+    EXPECT_NEAR(static_cast<double>(y), s.y, 1e-6);
+    EXPECT_NEAR(static_cast<double>(z), s.z, 1e-6);
+}
+
+TEST(Reduce, identical_across_thread_counts) {
+    auto points = randomCloud(250007);
+    ThreadPool serial(0), two(2), five(5);
+
+    expectIdentical(sum(points, serial), sum(points, two));
+    expectIdentical(sum(points, serial), sum(points, five));
+    expectIdentical(centroid(points, serial), centroid(points, five));
+
+    auto b0 = bounds(points, serial), b1 = bounds(points, five);
+    expectIdentical(b0.min, b1.min);
+    expectIdentical(b0.max, b1.max);
+
+    auto c0 = covariance(points, serial), c1 = covariance(points, two);
+    EXPECT_EQ(c0.xx, c1.xx);
+    EXPECT_EQ(c0.xy, c1.xy);
+    EXPECT_EQ(c0.xz, c1.xz);
+    EXPECT_EQ(c0.yy, c1.yy);
+    EXPECT_EQ(c0.yz, c1.yz);
+    EXPECT_EQ(c0.zz, c1.zz);
+}
@@ -0,0 +1,153 @@
+//
+// Tests for RadixSort.hpp and SpaceFillingCurve.hpp
+//
+
+#include "gtest/gtest.h"
+#include "../src/RadixSort.hpp"
+#include "../src/SpaceFillingCurve.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::vector<Vector> randomCloud(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    std::vector<Vector> result;
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(Vector(dist(rng), dist(rng), dist(rng)));
+    return result;
+}
+
+std::vector<std::uint32_t> identity(std::size_t n) {
+    std::vector<std::uint32_t> result(n);
+    std::iota(result.begin(), result.end(), 0u);
+    return result;
+}
+
+}
+
+TEST(RadixSort, matches_stable_sort) {
+    ThreadPool pool(3);
+    std::mt19937_64 rng(1);
+    // enough keys for several chunks, few enough distinct ones for ties
+    std::vector<std::uint64_t> keys(300000);
+    for (auto& k : keys)
+        k = rng() % 100000 * 0x9e3779b97f4a7c15ull;
+    auto values = identity(keys.size());
+
+    std::vector<std::uint32_t> expect = values;
+    std::stable_sort(expect.begin(), expect.end(),
+                     [&keys](std::uint32_t a, std::uint32_t b) { return keys[a] < keys[b]; });
+
+    auto original = keys;
+    radixSort(keys, values, 64, pool);
+    EXPECT_EQ(expect, values);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        EXPECT_EQ(original[values[i]], keys[i]);
+}
+
+TEST(RadixSort, ignores_bits_above_key_bits) {
+    std::vector<std::uint64_t> keys{ 3 | 1ull << 40, 1, 2 | 1ull << 63, 0 };
+    auto values = identity(keys.size());
+    radixSort(keys, values, 8);
+    EXPECT_EQ((std::vector<std::uint32_t>{3, 1, 2, 0}), values);
+
+    std::vector<std::uint32_t> wrong(3);
+    EXPECT_THROW(radixSort(keys, wrong), std::invalid_argument);
+}
+
+TEST(SpaceFillingCurve, morton_interleaves_bits) {
+    EXPECT_EQ(0u, mortonCode(0, 0, 0));
+    EXPECT_EQ(1u, mortonCode(1, 0, 0));
+    EXPECT_EQ(2u, mortonCode(0, 1, 0));
+    EXPECT_EQ(4u, mortonCode(0, 0, 1));
+    EXPECT_EQ(7u << 3, mortonCode(2, 2, 2));
+    EXPECT_EQ((std::uint64_t(1) << 63) - 1, mortonCode(0x1fffff, 0x1fffff, 0x1fffff));
+    // only 21 bits of each coordinate count
+    EXPECT_EQ(mortonCode(5, 6, 7), mortonCode(5 | 1u << 21, 6, 7));
+}
+
+TEST(SpaceFillingCurve, hilbert_steps_to_neighbours) {
+    // the curve starts at the origin and fills each corner cube before
+    // leaving it, so the first 16^3 cells are codes 0 .. 4095
+    const std::uint32_t side = 16;
+    std::vector<std::int64_t> cell(side * side * side, -1);
+    for (std::uint32_t x = 0; x < side; ++x)
+        for (std::uint32_t y = 0; y < side; ++y)
+            for (std::uint32_t z = 0; z < side; ++z) {
+                const std::uint64_t code = hilbertCode(x, y, z);
+                ASSERT_LT(code, cell.size());
+                ASSERT_EQ(-1, cell[code]);
+                cell[code] = (x * side + y) * side + z;
+            }
+    for (std::size_t i = 1; i < cell.size(); ++i) {
+        const std::int64_t a = cell[i - 1], b = cell[i];
+        const std::int64_t step = std::abs(a / 256 - b / 256) + std::abs(a / 16 % 16 - b / 16 % 16) +
+                                  std::abs(a % 16 - b % 16);
+        EXPECT_EQ(1, step) << "between codes " << i - 1 << " and " << i;
+    }
+}
+
+TEST(SpaceFillingCurve, order_sorts_codes) {
+    ThreadPool pool(2);
+    auto points = randomCloud(20000, 1);
+    for (Curve curve : {Curve::Morton, Curve::Hilbert}) {
+        auto order = curveOrder(points, curve, pool);
+        std::vector<std::uint64_t> codes;
+        curveCodes(points, bounds(points), curve, codes);
+
+        auto sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+        EXPECT_EQ(identity(points.size()), sorted);
+        for (std::size_t i = 1; i < order.size(); ++i)
+            EXPECT_LE(codes[order[i - 1]], codes[order[i]]);
+    }
+}
+
+TEST(SpaceFillingCurve, sort_and_permute) {
+    auto points = randomCloud(5000, 2);
+    auto original = points;
+    std::vector<int> ids(points.size());
+    std::iota(ids.begin(), ids.end(), 0);
+
+    auto order = sortAlongCurve(points, Curve::Hilbert);
+    permute(ids, order);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        EXPECT_TRUE(original[order[i]] == points[i]);
+        EXPECT_EQ(static_cast<int>(order[i]), ids[i]);
+    }
+
+    VectorArray array(original);
+    EXPECT_EQ(curveOrder(original, Curve::Hilbert), sortAlongCurve(array, Curve::Hilbert));
+    for (std::size_t i = 0; i < points.size(); ++i)
+        EXPECT_TRUE(array[i] == points[i]);
+}
+
+TEST(SpaceFillingCurve, sorting_shortens_the_path) {
+    auto points = randomCloud(20000, 3);
+    auto pathLength = [](const std::vector<Vector>& p) {
+        double total = 0;
+        for (std::size_t i = 1; i < p.size(); ++i)
+            total += (p[i] - p[i - 1]).length();
+        return total;
+    };
+    const double random = pathLength(points);
+    auto morton = points, hilbert = points;
+    sortAlongCurve(morton, Curve::Morton);
+    sortAlongCurve(hilbert, Curve::Hilbert);
+    EXPECT_LT(pathLength(morton), random / 10);
+    EXPECT_LT(pathLength(hilbert), pathLength(morton));
+}
+
+TEST(SpaceFillingCurve, degenerate_sets) {
+    EXPECT_TRUE(curveOrder(std::vector<Vector>{}).empty());
+    // every point in one cell: input order is kept
+    std::vector<Vector> same(10, Vector(1, 2, 3));
+    EXPECT_EQ(identity(10), curveOrder(same));
+}
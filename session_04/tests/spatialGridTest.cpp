@@ -0,0 +1,164 @@
+//
+// Tests for SpatialGrid and weld, checked against brute force
+//
+
+#include "gtest/gtest.h"
+#include "../src/SpatialGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::vector<Vector> randomCloud(std::size_t n, unsigned seed, double extent = 10.0) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-extent, extent);
+    std::vector<Vector> result;
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(Vector(dist(rng), dist(rng), dist(rng)));
+    return result;
+}
+
+std::vector<std::uint32_t> bruteWithin(const std::vector<Vector>& points, const Vector& q, double r) {
+    std::vector<std::uint32_t> result;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const Vector d = points[i] - q;
+        if (d * d <= r * r)
+            result.push_back(static_cast<std::uint32_t>(i));
+    }
+    return result;
+}
+
+std::vector<std::uint32_t> indices(const std::vector<SpatialGrid::Neighbour>& found) {
+    std::vector<std::uint32_t> result;
+    for (const auto& n : found)
+        result.push_back(n.index);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// the definition of weld, one point at a time
+std::vector<std::uint32_t> bruteWeld(const std::vector<Vector>& points, double eps) {
+    std::vector<std::uint32_t> kept, remap;
+    for (const auto& p : points) {
+        std::uint32_t to = static_cast<std::uint32_t>(kept.size());
+        for (std::size_t k = 0; k < kept.size(); ++k) {
+            const Vector d = points[kept[k]] - p;
+            if (d * d <= eps * eps) {
+                to = static_cast<std::uint32_t>(k);
+                break;
+            }
+        }
+        if (to == kept.size())
+            kept.push_back(static_cast<std::uint32_t>(remap.size()));
+        remap.push_back(to);
+    }
+    return remap;
+}
+
+}
+
+TEST(SpatialGrid, empty) {
+    SpatialGrid grid(std::vector<Vector>{}, 1.0);
+    EXPECT_TRUE(grid.empty());
+    EXPECT_TRUE(grid.withinRadius(Vector{}, 5.0).empty());
+}
+
+TEST(SpatialGrid, within_radius_matches_brute_force) {
+    ThreadPool pool(3);
+    auto points = randomCloud(20000, 1);
+    SpatialGrid grid(points, 0.5, pool);
+    ASSERT_EQ(points.size(), grid.size());
+
+    // radii below, at and well above the cell size
+    for (double r : {0.2, 0.5, 1.7}) {
+        for (const auto& q : randomCloud(100, 2, 11.0)) {
+            auto found = grid.withinRadius(q, r);
+            EXPECT_EQ(bruteWithin(points, q, r), indices(found));
+            for (std::size_t i = 1; i < found.size(); ++i)
+                EXPECT_LE(found[i - 1].distanceSquared, found[i].distanceSquared);
+        }
+    }
+}
+
+TEST(SpatialGrid, query_outside_and_nan) {
+    auto points = randomCloud(1000, 3);
+    SpatialGrid grid(points, 1.0);
+    EXPECT_TRUE(grid.withinRadius(Vector(100, 0, 0), 5.0).empty());
+    EXPECT_EQ(points.size(), grid.withinRadius(Vector(100, 0, 0), 1000.0).size());
+    EXPECT_TRUE(grid.withinRadius(Vector(std::nan(""), 0, 0), 5.0).empty());
+    EXPECT_TRUE(grid.withinRadius(Vector(), -1.0).empty());
+}
+
+TEST(SpatialGrid, batched_matches_single) {
+    ThreadPool pool(2);
+    auto points = randomCloud(5000, 4);
+    SpatialGrid grid(points, 1.0, pool);
+    auto queries = randomCloud(500, 5);
+    std::vector<std::vector<SpatialGrid::Neighbour>> out;
+    grid.withinRadius(queries.data(), queries.size(), 0.75, out, pool);
+    ASSERT_EQ(queries.size(), out.size());
+    for (std::size_t i = 0; i < queries.size(); ++i)
+        EXPECT_EQ(indices(grid.withinRadius(queries[i], 0.75)), indices(out[i]));
+}
+
+TEST(SpatialGrid, bad_input) {
+    std::vector<Vector> points{ {0, 0, 0}, {1, 1, 1} };
+    EXPECT_THROW(SpatialGrid(points, 0.0), std::invalid_argument);
+    EXPECT_THROW(SpatialGrid(points, -1.0), std::invalid_argument);
+    EXPECT_THROW(SpatialGrid(points, 1e-300), std::invalid_argument);
+    points.push_back(Vector(std::nan(""), 0, 0));
+    EXPECT_THROW(SpatialGrid(points, 1.0), std::invalid_argument);
+}
+
+TEST(Weld, exact_duplicates) {
+    std::vector<Vector> points{ {0, 0, 0}, {1, 2, 3}, {0, 0, 0}, {1, 2, 3}, {1, 2, 3.5}, {-0.0, 0, 0} };
+    auto welded = weld(points, 0.0);
+    EXPECT_EQ((std::vector<std::uint32_t>{0, 1, 0, 1, 2, 0}), welded.remap);
+    ASSERT_EQ(3u, welded.points.size());
+    EXPECT_TRUE(welded.points[2] == points[4]);
+    for (std::size_t i = 0; i < points.size(); ++i)
+        EXPECT_TRUE(welded.points[welded.remap[i]] == points[i]);
+}
+
+TEST(Weld, matches_definition) {
+    ThreadPool pool(3);
+    // clustered, so chains of near points are common
+    auto points = randomCloud(3000, 6, 2.0);
+    for (double eps : {0.05, 0.2, 0.6}) {
+        auto welded = weld(points, eps, pool);
+        EXPECT_EQ(bruteWeld(points, eps), welded.remap);
+
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            const Vector d = welded.points[welded.remap[i]] - points[i];
+            EXPECT_LE(d * d, eps * eps);
+        }
+    }
+}
+
+TEST(Weld, same_result_for_any_thread_count) {
+    auto points = randomCloud(300000, 7, 5.0);
+    ThreadPool one(0), four(4);
+    auto a = weld(points, 0.1, one);
+    auto b = weld(points, 0.1, four);
+    EXPECT_EQ(a.remap, b.remap);
+    ASSERT_EQ(a.points.size(), b.points.size());
+}
+
+TEST(Weld, remap_mesh_indices) {
+    // two triangles sharing an edge, stored unindexed
+    std::vector<Vector> corners{ {0, 0, 0}, {1, 0, 0}, {0, 1, 0},
+                                 {1, 0, 0}, {1, 1, 0}, {0, 1, 0} };
+    std::vector<std::uint32_t> triangles{0, 1, 2, 3, 4, 5};
+    auto welded = weld(corners, 1e-9);
+    remapIndices(triangles, welded.remap);
+    EXPECT_EQ(4u, welded.points.size());
+    EXPECT_EQ((std::vector<std::uint32_t>{0, 1, 2, 1, 3, 2}), triangles);
+
+    std::vector<std::uint32_t> bad{7};
+    EXPECT_THROW(remapIndices(bad, welded.remap), std::out_of_range);
+    EXPECT_THROW(weld(corners, -1.0), std::invalid_argument);
+}
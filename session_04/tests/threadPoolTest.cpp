@@ -0,0 +1,61 @@
+//
+// Tests for ThreadPool::parallelFor
+//
+
+#include "gtest/gtest.h"
+#include "../src/ThreadPool.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST(ThreadPool, covers_every_index_once) {
+    ThreadPool pool(3);
+    std::vector<std::atomic<int>> hits(10007);
+    for (auto& h : hits)
+        h = 0;
+
+    pool.parallelFor(hits.size(), 100, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            hits[i]++;
+    });
+
+    for (auto& h : hits)
+        EXPECT_EQ(1, h.load());
+}
+
+TEST(ThreadPool, chunks_respect_grain) {
+    ThreadPool pool(2);
+    std::atomic<int> chunks{0};
+    pool.parallelFor(1000, 300, [&](std::size_t begin, std::size_t end) {
+        EXPECT_EQ(0u, begin % 300);
+        EXPECT_LE(end - begin, 300u);
+        chunks++;
+    });
+    EXPECT_EQ(4, chunks.load());
+}
+
+TEST(ThreadPool, no_workers_runs_inline) {
+    ThreadPool pool(0);
+    EXPECT_EQ(1u, pool.concurrency());
+    std::size_t total = 0;
+    pool.parallelFor(50, 7, [&](std::size_t begin, std::size_t end) { total += end - begin; });
+    EXPECT_EQ(50u, total);
+}
+
+TEST(ThreadPool, nested) {
+    ThreadPool pool(2);
+    std::atomic<int> total{0};
+    pool.parallelFor(8, 1, [&](std::size_t, std::size_t) {
+        pool.parallelFor(8, 1, [&](std::size_t, std::size_t) { total++; });
+    });
+    EXPECT_EQ(64, total.load());
+}
+
+TEST(ThreadPool, rethrows) {
+    ThreadPool pool(2);
+    EXPECT_THROW(pool.parallelFor(100, 1, [](std::size_t begin, std::size_t) {
+        if (begin == 42)
+            throw std::runtime_error("boom");
+    }), std::runtime_error);
+}
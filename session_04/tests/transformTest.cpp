@@ -0,0 +1,111 @@
+//
+// Tests for Matrix4, Quaternion and the batch transforms
+//
+
+#include "gtest/gtest.h"
+#include "../src/Transform.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const double halfPi = std::acos(0.0);
+
+void expectNear(const Vector& expect, const Vector& actual) {
+    EXPECT_NEAR(expect.x, actual.x, 1e-12);
+    EXPECT_NEAR(expect.y, actual.y, 1e-12);
+    EXPECT_NEAR(expect.z, actual.z, 1e-12);
+}
+
+std::vector<Vector> cloud(std::size_t n) {
+    std::vector<Vector> result;
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(Vector(std::sin(i * 0.1), std::cos(i * 0.3), 0.001 * i));
+    return result;
+}
+
+}
+
+TEST(Quaternion, rotate_about_z) {
+    auto q = Quaternion::fromAxisAngle(Vector{0, 0, 2}, halfPi);
+    expectNear(Vector(0, 1, 0), q.rotate(Vector(1, 0, 0)));
+    expectNear(Vector(-1, 0, 0), q.rotate(Vector(0, 1, 0)));
+}
+
+TEST(Quaternion, product_composes) {
+    auto qz = Quaternion::fromAxisAngle(Vector{0, 0, 1}, halfPi);
+    auto qx = Quaternion::fromAxisAngle(Vector{1, 0, 0}, halfPi);
+    Vector v{1, 2, 3};
+    expectNear(qx.rotate(qz.rotate(v)), (qx * qz).rotate(v));
+}
+
+TEST(Matrix4, identity) {
+    Matrix4 m;
+    Vector v{1.2, 3.4, 7};
+    EXPECT_TRUE(v == m.transformPoint(v));
+    EXPECT_TRUE(m == m.transpose());
+}
+
+TEST(Matrix4, rotation_matches_quaternion) {
+    auto q = Quaternion::fromAxisAngle(Vector{1, 2, 3}, 0.7);
+    auto m = Matrix4::rotation(q);
+    Vector v{2, -4.5, 7.2};
+    expectNear(q.rotate(v), m.transformDirection(v));
+}
+
+TEST(Matrix4, translation_only_moves_points) {
+    auto m = Matrix4::translation(Vector{1, 2, 3});
+    expectNear(Vector(2, 3, 4), m.transformPoint(Vector(1, 1, 1)));
+    expectNear(Vector(1, 1, 1), m.transformDirection(Vector(1, 1, 1)));
+}
+
+TEST(Matrix4, product_composes) {
+    auto r = Matrix4::rotation(Quaternion::fromAxisAngle(Vector{0, 1, 0}, 0.3));
+    auto t = Matrix4::translation(Vector{1, 2, 3});
+    auto s = Matrix4::scaling(Vector{2, 2, 2});
+    Vector v{2, -4.5, 7.2};
+    expectNear(t.transformPoint(r.transformPoint(s.transformPoint(v))),
+               (t * r * s).transformPoint(v));
+}
+
+TEST(Transform, points_match_scalar) {
+    ThreadPool pool(3);
+    auto m = Matrix4::rigid(Quaternion::fromAxisAngle(Vector{1, 1, 0}, 1.1), Vector{4, 5, 6});
+    // more than one chunk, plus a ragged tail
+    auto in = cloud(40001);
+    std::vector<Vector> out(in.size());
+
+    transformPoints(m, in.data(), out.data(), in.size(), pool);
+    for (std::size_t i = 0; i < in.size(); ++i)
+        expectNear(m.transformPoint(in[i]), out[i]);
+
+    transformDirections(m, in.data(), out.data(), in.size(), pool);
+    for (std::size_t i = 0; i < in.size(); ++i)
+        expectNear(m.transformDirection(in[i]), out[i]);
+}
+
+TEST(Transform, rotate_in_place) {
+    auto q = Quaternion::fromAxisAngle(Vector{0, 1, 1}, -0.4);
+    auto in = cloud(1003);
+    auto points = in;
+    rotate(q, points.data(), points.data(), points.size());
+    for (std::size_t i = 0; i < in.size(); ++i)
+        expectNear(q.rotate(in[i]), points[i]);
+}
+
+TEST(Transform, vector_array) {
+    ThreadPool pool(2);
+    auto m = Matrix4::rigid(Quaternion::fromAxisAngle(Vector{1, 0, 1}, 2.0), Vector{-1, 0, 1});
+    auto points = cloud(20003);
+    VectorArray in(points), out;
+
+    transformPoints(m, in, out, pool);
+    ASSERT_EQ(in.size(), out.size());
+    for (std::size_t i = 0; i < in.size(); ++i)
+        expectNear(m.transformPoint(points[i]), out[i]);
+
+    rotate(Quaternion::fromAxisAngle(Vector{0, 0, 1}, halfPi), in, in, pool);
+    for (std::size_t i = 0; i < in.size(); ++i)
+        expectNear(Vector(-points[i].y, points[i].x, points[i].z), in[i]);
+}
@@ -0,0 +1,159 @@
+//
+// Tests for TriangleMesh
+//
+
+#include "gtest/gtest.h"
+#include "../src/TriangleMesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// unit cube, every face wound counter clockwise seen from outside
+TriangleMesh cube(const Vector& offset = Vector(0, 0, 0)) {
+    std::vector<Vector> corners;
+    for (int i = 0; i < 8; ++i)
+        corners.push_back(Vector(i & 1, (i >> 1) & 1, (i >> 2) & 1) + offset);
+    std::vector<std::uint32_t> indices{
+        0, 2, 1,  1, 2, 3,      // z = 0
+        4, 5, 6,  5, 7, 6,      // z = 1
+        0, 1, 4,  1, 5, 4,      // y = 0
+        2, 6, 3,  3, 6, 7,      // y = 1
+        0, 4, 2,  2, 4, 6,      // x = 0
+        1, 3, 5,  3, 7, 5 };    // x = 1
+    return TriangleMesh(VectorArray(corners), indices);
+}
+
+// bumpy height field of side x side vertices, stored in shuffled order
+TriangleMesh randomMesh(std::size_t side, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-0.3, 0.3);
+    std::vector<std::uint32_t> slot(side * side);
+    std::iota(slot.begin(), slot.end(), 0u);
+    std::shuffle(slot.begin(), slot.end(), rng);
+
+    std::vector<Vector> vertices(side * side);
+    for (std::size_t i = 0; i < side; ++i)
+        for (std::size_t j = 0; j < side; ++j)
+            vertices[slot[i * side + j]] = Vector(i + dist(rng), j + dist(rng), dist(rng));
+    std::vector<std::uint32_t> indices;
+    for (std::uint32_t i = 0; i + 1 < side; ++i) {
+        for (std::uint32_t j = 0; j + 1 < side; ++j) {
+            const std::uint32_t a = i * side + j, b = a + side;
+            for (std::uint32_t v : {a, b, a + 1, a + 1, b, b + 1})
+                indices.push_back(slot[v]);
+        }
+    }
+    return TriangleMesh(VectorArray(vertices), indices);
+}
+
+}
+
+TEST(TriangleMesh, empty) {
+    TriangleMesh mesh;
+    EXPECT_EQ(0u, mesh.triangleCount());
+    EXPECT_EQ(0.0, mesh.surfaceArea());
+    EXPECT_EQ(0.0, mesh.volume());
+    VectorArray normals;
+    mesh.vertexNormals(normals);
+    EXPECT_EQ(0u, normals.size());
+}
+
+TEST(TriangleMesh, bad_indices) {
+    VectorArray three(std::vector<Vector>{ {0, 0, 0}, {1, 0, 0}, {0, 1, 0} });
+    EXPECT_THROW(TriangleMesh(three, {0, 1}), std::invalid_argument);
+    EXPECT_THROW(TriangleMesh(three, {0, 1, 3}), std::invalid_argument);
+    EXPECT_NO_THROW(TriangleMesh(three, {0, 1, 2}));
+}
+
+TEST(TriangleMesh, cube_area_and_volume) {
+    auto mesh = cube();
+    EXPECT_EQ(8u, mesh.vertexCount());
+    EXPECT_EQ(12u, mesh.triangleCount());
+    EXPECT_DOUBLE_EQ(6.0, mesh.surfaceArea());
+    EXPECT_DOUBLE_EQ(1.0, mesh.volume());
+    // far from the origin too
+    EXPECT_DOUBLE_EQ(1.0, cube(Vector(1e6, -2e6, 3e6)).volume());
+}
+
+TEST(TriangleMesh, cube_normals_point_out) {
+    auto mesh = cube();
+    VectorArray faces, vertices;
+    mesh.faceNormals(faces);
+    mesh.vertexNormals(vertices);
+    ASSERT_EQ(12u, faces.size());
+    ASSERT_EQ(8u, vertices.size());
+
+    const Vector center(0.5, 0.5, 0.5);
+    for (std::size_t t = 0; t < 12; ++t) {
+        const Vector n = faces[t];
+        EXPECT_DOUBLE_EQ(1.0, n.length());
+        // axis aligned, and facing away from the middle
+        EXPECT_DOUBLE_EQ(1.0, std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+        EXPECT_GT(n * (mesh.vertex(t, 0) - center), 0);
+    }
+    for (std::size_t v = 0; v < 8; ++v) {
+        EXPECT_NEAR(1.0, vertices[v].length(), 1e-15);
+        EXPECT_GT(vertices[v] * (mesh.vertices()[v] - center), 0.5);
+    }
+}
+
+TEST(TriangleMesh, vertex_normals_match_serial_sum) {
+    auto mesh = randomMesh(120, 1);
+    std::vector<Vector> expect(mesh.vertexCount(), Vector(0, 0, 0));
+    for (std::size_t t = 0; t < mesh.triangleCount(); ++t) {
+        const Vector a = mesh.vertex(t, 0);
+        const Vector n = (mesh.vertex(t, 1) - a).cross(mesh.vertex(t, 2) - a);
+        for (int k = 0; k < 3; ++k)
+            expect[mesh.indices()[3 * t + k]] += n;
+    }
+    VectorArray normals;
+    mesh.vertexNormals(normals);
+    for (std::size_t v = 0; v < expect.size(); ++v) {
+        Vector e = expect[v];
+        e.normalize();
+        EXPECT_NEAR(0.0, (normals[v] - e).length(), 1e-12);
+    }
+}
+
+TEST(TriangleMesh, unused_vertex_and_degenerate_face) {
+    VectorArray vertices(std::vector<Vector>{ {0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {5, 5, 5} });
+    TriangleMesh mesh(vertices, {0, 1, 2});
+    VectorArray faces, normals;
+    mesh.faceNormals(faces);
+    mesh.vertexNormals(normals);
+    EXPECT_TRUE(faces[0] == Vector(0, 0, 0));
+    EXPECT_TRUE(normals[3] == Vector(0, 0, 0));
+    EXPECT_EQ(0.0, mesh.surfaceArea());
+}
+
+TEST(TriangleMesh, same_result_for_any_thread_count) {
+    auto mesh = randomMesh(300, 2);
+    ThreadPool one(0), four(4);
+    EXPECT_EQ(mesh.surfaceArea(one), mesh.surfaceArea(four));
+    EXPECT_EQ(mesh.volume(one), mesh.volume(four));
+    VectorArray a, b;
+    mesh.vertexNormals(a, one);
+    mesh.vertexNormals(b, four);
+    for (std::size_t v = 0; v < a.size(); ++v)
+        EXPECT_TRUE(a[v] == b[v]);
+}
+
+TEST(TriangleMesh, weld_triangle_soup) {
+    auto indexed = cube();
+    std::vector<Vector> soup;
+    for (std::size_t t = 0; t < indexed.triangleCount(); ++t)
+        for (int k = 0; k < 3; ++k)
+            soup.push_back(indexed.vertex(t, k));
+    auto mesh = weldMesh(soup, 1e-9);
+    EXPECT_EQ(8u, mesh.vertexCount());
+    EXPECT_EQ(12u, mesh.triangleCount());
+    EXPECT_DOUBLE_EQ(1.0, mesh.volume());
+    soup.pop_back();
+    EXPECT_THROW(weldMesh(soup, 1e-9), std::invalid_argument);
+}
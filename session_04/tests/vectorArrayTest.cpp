@@ -0,0 +1,161 @@
+//
+// Tests for the structure-of-arrays VectorArray and its batch kernels.
+// The cases mirror the ones in test.cpp, but run each operation over an
+// array long enough to exercise both the SIMD body and the scalar tail.
+//
+
+#include "gtest/gtest.h"
+#include "../src/VectorArray.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+const std::size_t count = 11;
+
+// v offset a little by index, so that the lanes differ
+Vector shifted(const Vector& v, std::size_t i) {
+    return Vector{v.x + i, v.y - i, v.z + 0.5 * i};
+}
+
+VectorArray filled(const Vector& v) {
+    VectorArray result;
+    for (std::size_t i = 0; i < count; ++i)
+        result.push_back(shifted(v, i));
+    return result;
+}
+
+}
+
+TEST(VectorArray, default_constructor) {
+    VectorArray va(count);
+    ASSERT_EQ(count, va.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        EXPECT_DOUBLE_EQ(0.0, va[i].x);
+        EXPECT_DOUBLE_EQ(0.0, va[i].y);
+        EXPECT_DOUBLE_EQ(1.0, va[i].z);
+    }
+}
+
+TEST(VectorArray, aligned_streams) {
+    VectorArray va(count);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(va.x()) % VectorArray::alignment);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(va.y()) % VectorArray::alignment);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(va.z()) % VectorArray::alignment);
+}
+
+TEST(VectorArray, round_trip) {
+    std::vector<Vector> vs{ {1.2, 3.4, 7}, {2, -4.5, 7.2}, {0, 0, 1} };
+    VectorArray va(vs);
+    auto result = va.toVectors();
+    ASSERT_EQ(vs.size(), result.size());
+    for (std::size_t i = 0; i < vs.size(); ++i)
+        EXPECT_TRUE(vs[i] == result[i]);
+}
+
+TEST(VectorArray, add) {
+    auto a = filled(Vector{1.2, 3.4, 7});
+    auto b = filled(Vector{2, -4.5, 7.2});
+    VectorArray result;
+    add(a, b, result);
+
+    ASSERT_EQ(count, result.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        auto expect = shifted(Vector{1.2, 3.4, 7}, i) + shifted(Vector{2, -4.5, 7.2}, i);
+        EXPECT_DOUBLE_EQ(expect.x, result[i].x);
+        EXPECT_DOUBLE_EQ(expect.y, result[i].y);
+        EXPECT_DOUBLE_EQ(expect.z, result[i].z);
+    }
+}
+
+TEST(VectorArray, add_in_place) {
+    auto result = filled(Vector{1.2, 3.4, 7});
+    auto b = filled(Vector{2, -4.5, 7.2});
+    add(result, b, result);
+
+    EXPECT_DOUBLE_EQ( 3.2, result[0].x);
+    EXPECT_DOUBLE_EQ(-1.1, result[0].y);
+    EXPECT_DOUBLE_EQ(14.2, result[0].z);
+}
+
+TEST(VectorArray, sub) {
+    auto a = filled(Vector{1.2, 3.4, 14});
+    auto b = filled(Vector{3, -4.5, 7.2});
+    VectorArray result;
+    sub(a, b, result);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        EXPECT_DOUBLE_EQ(-1.8, result[i].x);
+        EXPECT_DOUBLE_EQ( 7.9, result[i].y);
+        EXPECT_DOUBLE_EQ( 6.8, result[i].z);
+    }
+}
+
+TEST(VectorArray, size_mismatch) {
+    VectorArray a(3), b(4), result;
+    EXPECT_THROW(add(a, b, result), std::invalid_argument);
+}
+
+TEST(VectorArray, scale) {
+    auto a = filled(Vector{2, 4, -6});
+    VectorArray result;
+    scale(a, 2.0, result);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        auto expect = shifted(Vector{2, 4, -6}, i) * 2.0;
+        EXPECT_DOUBLE_EQ(expect.x, result[i].x);
+        EXPECT_DOUBLE_EQ(expect.y, result[i].y);
+        EXPECT_DOUBLE_EQ(expect.z, result[i].z);
+    }
+}
+
+TEST(VectorArray, dot_product) {
+    auto a = filled(Vector{2, 3, 4});
+    auto b = filled(Vector{6, 3, 8});
+    std::vector<double> result;
+    dot(a, b, result);
+
+    ASSERT_EQ(count, result.size());
+    EXPECT_DOUBLE_EQ((2 * 6) + (3 * 3) + (4 * 8), result[0]);
+    for (std::size_t i = 0; i < count; ++i)
+        EXPECT_DOUBLE_EQ(a[i] * b[i], result[i]);
+}
+
+TEST(VectorArray, cross_product) {
+    auto a = filled(Vector{2, 3, 4});
+    auto b = filled(Vector{3, 8, -2});
+    VectorArray result;
+    cross(a, b, result);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        auto expect = a[i].cross(b[i]);
+        EXPECT_DOUBLE_EQ(expect.x, result[i].x);
+        EXPECT_DOUBLE_EQ(expect.y, result[i].y);
+        EXPECT_DOUBLE_EQ(expect.z, result[i].z);
+    }
+}
+
+TEST(VectorArray, length) {
+    auto a = filled(Vector{2.0, 3.0, 4.0});
+    std::vector<double> result;
+    length(a, result);
+
+    // sqrt (29)
+    EXPECT_DOUBLE_EQ(5.385164807134504, result[0]);
+    for (std::size_t i = 0; i < count; ++i)
+        EXPECT_DOUBLE_EQ(a[i].length(), result[i]);
+}
+
+TEST(VectorArray, normalize) {
+    auto a = filled(Vector{2.0, 3.0, -4.0});
+    auto expect = a.toVectors();
+    normalize(a);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        expect[i].normalize();
+        EXPECT_DOUBLE_EQ(expect[i].x, a[i].x);
+        EXPECT_DOUBLE_EQ(expect[i].y, a[i].y);
+        EXPECT_DOUBLE_EQ(expect[i].z, a[i].z);
+    }
+}
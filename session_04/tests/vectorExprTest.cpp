@@ -0,0 +1,100 @@
+//
+// Tests for the expression template layer in VectorExpr.hpp
+//
+
+#include "gtest/gtest.h"
+#include "../src/Vector.hpp"
+#include "../src/VectorArray.hpp"
+
+#include <type_traits>
+
+TEST(VectorExpr, vector_operators_unchanged) {
+    Vector v1{1.2, 3.4, 7};
+    Vector v2{2, -4.5, 7.2};
+
+    // the plain operators still return Vectors
+    static_assert(std::is_same<decltype(v1 + v2), Vector>::value, "");
+    static_assert(std::is_same<decltype(v1 - v2), Vector>::value, "");
+    static_assert(std::is_same<decltype(v1 * 2.0), Vector>::value, "");
+    static_assert(std::is_same<decltype(2.0 * v1), Vector>::value, "");
+    static_assert(std::is_same<decltype(v1 * v2), double>::value, "");
+}
+
+TEST(VectorExpr, lazy_chain) {
+    Vector a{1, 2, 3};
+    Vector b{4, 5, 6};
+    Vector c{0.5, 0.5, 0.5};
+
+    Vector result = lazy(a) + lazy(b) * 2.0 - lazy(c);
+    Vector expect = a + b * 2.0 - c;
+
+    EXPECT_DOUBLE_EQ(expect.x, result.x);
+    EXPECT_DOUBLE_EQ(expect.y, result.y);
+    EXPECT_DOUBLE_EQ(expect.z, result.z);
+}
+
+TEST(VectorExpr, mixed_vector_and_expression) {
+    Vector a{1, 2, 3};
+    Vector b{4, 5, 6};
+
+    Vector result = a + 2.0 * lazy(b);
+    EXPECT_DOUBLE_EQ( 9, result.x);
+    EXPECT_DOUBLE_EQ(12, result.y);
+    EXPECT_DOUBLE_EQ(15, result.z);
+
+    result = lazy(result) - a;
+    EXPECT_DOUBLE_EQ( 8, result.x);
+    EXPECT_DOUBLE_EQ(10, result.y);
+    EXPECT_DOUBLE_EQ(12, result.z);
+}
+
+TEST(VectorExpr, array_streaming) {
+    VectorArray a, b;
+    for (int i = 0; i < 9; ++i) {
+        a.push_back(Vector(i, 2 * i, 3 * i));
+        b.push_back(Vector(1, -i, 0.5));
+    }
+    const double k = 3.0;
+
+    VectorArray out = a + k * b;
+
+    ASSERT_EQ(a.size(), out.size());
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        Vector expect = a[i] + b[i] * k;
+        EXPECT_DOUBLE_EQ(expect.x, out[i].x);
+        EXPECT_DOUBLE_EQ(expect.y, out[i].y);
+        EXPECT_DOUBLE_EQ(expect.z, out[i].z);
+    }
+}
+
+TEST(VectorExpr, array_in_place_with_broadcast) {
+    VectorArray a(5);
+    Vector offset{1, 1, 1};
+
+    a = a - offset + a * 2.0;
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        EXPECT_DOUBLE_EQ(-1, a[i].x);
+        EXPECT_DOUBLE_EQ(-1, a[i].y);
+        EXPECT_DOUBLE_EQ( 2, a[i].z);
+    }
+}
+
+TEST(VectorExpr, array_size_mismatch) {
+    VectorArray a(3), b(4), out;
+    EXPECT_THROW(out = a + b, std::invalid_argument);
+}
+
+TEST(VectorExpr, empty_array_operand) {
+    VectorArray empty, five(5), out;
+    EXPECT_THROW(out = empty + five, std::invalid_argument);
+    EXPECT_THROW(out = five - empty * 2.0, std::invalid_argument);
+    EXPECT_EQ(0u, out.size());
+
+    // two empty arrays, or an empty one and a Vector, make an empty result
+    out = five;
+    out = empty + empty;
+    EXPECT_EQ(0u, out.size());
+    out = empty - Vector{1, 2, 3};
+    EXPECT_EQ(0u, out.size());
+}
@@ -0,0 +1,280 @@
+//
+// EmployeeRegistry.cpp
+//
+
+#include "EmployeeRegistry.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+const std::size_t maxEmployees = 0xfffffffeu;
+
+// below this, one thread does it all
+const std::size_t grain = std::size_t(1) << 16;
+
+// f(t) for t in [0, threads), on that many threads
+void parallel(unsigned threads, const std::function<void(unsigned)>& f) {
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(f, t);
+    f(0);
+    for (std::thread& w : workers)
+        w.join();
+}
+
+// capacity for one more element, grown geometrically, so that the next
+// push_back or insert cannot throw
+template <typename T>
+void roomForOneMore(std::vector<T>& v) {
+    if (v.size() == v.capacity())
+        v.reserve(std::max<std::size_t>(2 * v.capacity(), 16));
+}
+
+unsigned threadsFor(std::size_t n, unsigned threads) {
+    if (threads < 1)
+        threads = 1;
+    return n / grain < threads ? static_cast<unsigned>(std::max<std::size_t>(n / grain, 1)) : threads;
+}
+
+// ids as unsigned, in the same order: flip the sign bit
+std::uint32_t ordered(int id) { return static_cast<std::uint32_t>(id) ^ 0x80000000u; }
+int unordered(std::uint32_t key) { return static_cast<int>(key ^ 0x80000000u); }
+
+// sort by the top 32 bits, a byte at a time from the lowest, each pass's
+// counts and scatter split between threads. Stable, so rows stay in
+// order within an id.
+void radixSort(std::vector<std::uint64_t>& keys, unsigned threads) {
+    const std::size_t n = keys.size();
+    threads = threadsFor(n, threads);
+    std::vector<std::uint64_t> tmp(n);
+    std::vector<std::size_t> begins(threads + 1);
+    for (unsigned t = 0; t <= threads; ++t)
+        begins[t] = n * t / threads;
+    std::vector<std::vector<std::size_t>> counts(threads, std::vector<std::size_t>(256));
+
+    for (int shift = 32; shift < 64; shift += 8) {
+        parallel(threads, [&](unsigned t) {
+            std::fill(counts[t].begin(), counts[t].end(), 0);
+            for (std::size_t i = begins[t]; i < begins[t + 1]; ++i)
+                ++counts[t][(keys[i] >> shift) & 0xff];
+        });
+        // ids sharing this byte, as dense ranges of ids do, need no pass
+        bool shared = false;
+        for (int b = 0; b < 256 && !shared; ++b) {
+            std::size_t total = 0;
+            for (unsigned t = 0; t < threads; ++t)
+                total += counts[t][b];
+            shared = total == n;
+        }
+        if (shared)
+            continue;
+        std::size_t at = 0;
+        for (int b = 0; b < 256; ++b)
+            for (unsigned t = 0; t < threads; ++t) {
+                const std::size_t c = counts[t][b];
+                counts[t][b] = at;
+                at += c;
+            }
+        parallel(threads, [&](unsigned t) {
+            for (std::size_t i = begins[t]; i < begins[t + 1]; ++i)
+                tmp[counts[t][(keys[i] >> shift) & 0xff]++] = keys[i];
+        });
+        keys.swap(tmp);
+    }
+}
+
+}
+
+const std::uint64_t EmployeeRegistry::emptySlot;
+
+std::size_t EmployeeRegistry::home(int id) const {
+    return homeIn(id, tableBits);
+}
+
+std::size_t EmployeeRegistry::homeIn(int id, int bits) {
+    // Fibonacci hashing: the top bits of the product mix in every bit of id
+    return static_cast<std::size_t>((ordered(id) * 0x9e3779b97f4a7c15ull) >> (64 - bits));
+}
+
+void EmployeeRegistry::rebuildTable(std::size_t n, unsigned threads) {
+    int bits = 4;
+    while ((std::size_t(1) << bits) < 2 * n)
+        ++bits;
+    const std::size_t capacity = std::size_t(1) << bits;
+    std::vector<std::uint64_t> next(capacity, emptySlot);
+
+    // The table is cut into one share per thread, and share p holds the
+    // homes h with h * threads / capacity == p. One pass counts the rows
+    // homed in each share, a second sorts the rows by share, stably, and
+    // then each thread inserts its own share's rows. Probes running off
+    // the end of a share are left for afterwards, when the next share is
+    // done.
+    const std::size_t rows = employees.size();
+    threads = threadsFor(rows, threads);
+    auto shareOf = [&](std::uint32_t row) {
+        return static_cast<unsigned>((homeIn(employees[row].getId(), bits) * threads) >> bits);
+    };
+    std::vector<std::size_t> begins(threads + 1);
+    for (unsigned t = 0; t <= threads; ++t)
+        begins[t] = rows * t / threads;
+    std::vector<std::vector<std::size_t>> counts(threads, std::vector<std::size_t>(threads));
+    parallel(threads, [&](unsigned t) {
+        for (std::size_t row = begins[t]; row < begins[t + 1]; ++row)
+            ++counts[t][shareOf(static_cast<std::uint32_t>(row))];
+    });
+    std::vector<std::size_t> shareBegins(threads + 1);
+    std::size_t at = 0;
+    for (unsigned p = 0; p < threads; ++p) {
+        shareBegins[p] = at;
+        for (unsigned t = 0; t < threads; ++t) {
+            const std::size_t c = counts[t][p];
+            counts[t][p] = at;
+            at += c;
+        }
+    }
+    shareBegins[threads] = rows;
+    std::vector<std::uint32_t> byShare(rows);
+    parallel(threads, [&](unsigned t) {
+        for (std::size_t row = begins[t]; row < begins[t + 1]; ++row) {
+            const std::uint32_t r = static_cast<std::uint32_t>(row);
+            byShare[counts[t][shareOf(r)]++] = r;
+        }
+    });
+
+    std::vector<std::vector<std::uint32_t>> spilled(threads);
+    parallel(threads, [&](unsigned p) {
+        // one past the last home in share p
+        const std::size_t hi = (capacity * (p + 1) + threads - 1) / threads;
+        for (std::size_t i = shareBegins[p]; i < shareBegins[p + 1]; ++i) {
+            const std::uint32_t row = byShare[i];
+            const int id = employees[row].getId();
+            std::size_t slot = homeIn(id, bits);
+            while (slot < hi && next[slot] != emptySlot)
+                ++slot;
+            if (slot == hi)
+                spilled[p].push_back(row);
+            else
+                next[slot] = std::uint64_t(ordered(id)) << 32 | row;
+        }
+    });
+    for (const std::vector<std::uint32_t>& share : spilled)
+        for (std::uint32_t row : share) {
+            const int id = employees[row].getId();
+            std::size_t slot = homeIn(id, bits);
+            while (next[slot] != emptySlot)
+                slot = (slot + 1) & (capacity - 1);
+            next[slot] = std::uint64_t(ordered(id)) << 32 | row;
+        }
+
+    table.swap(next);
+    tableBits = bits;
+}
+
+const Employee* EmployeeRegistry::find(int id) const {
+    if (table.empty())
+        return nullptr;
+    const std::uint32_t key = ordered(id);
+    for (std::size_t slot = home(id);; slot = (slot + 1) & (table.size() - 1)) {
+        const std::uint64_t s = table[slot];
+        if (s == emptySlot)
+            return nullptr;
+        if (static_cast<std::uint32_t>(s >> 32) == key)
+            return &employees[static_cast<std::uint32_t>(s)];
+    }
+}
+
+void EmployeeRegistry::add(const Employee& employee) {
+    const int id = employee.getId();
+    if (contains(id))
+        throw std::invalid_argument("EmployeeRegistry already has id " + std::to_string(id));
+    if (size() >= maxEmployees)
+        throw std::length_error("EmployeeRegistry over 2^32 - 2 employees");
+
+    // room first, so that only the copy and a new table can throw, and a
+    // throw from the new table takes the copy back out
+    roomForOneMore(sortedIds);
+    roomForOneMore(sortedRows);
+    roomForOneMore(employees);
+    const std::size_t at = std::lower_bound(sortedIds.begin(), sortedIds.end(), id) - sortedIds.begin();
+    const std::uint32_t row = static_cast<std::uint32_t>(employees.size());
+    employees.push_back(employee);
+    if (2 * employees.size() > table.size()) {
+        try {
+            rebuildTable(employees.size(), 1);
+        } catch (...) {
+            employees.pop_back();
+            throw;
+        }
+        sortedIds.insert(sortedIds.begin() + at, id);
+        sortedRows.insert(sortedRows.begin() + at, row);
+        return;
+    }
+    sortedIds.insert(sortedIds.begin() + at, id);
+    sortedRows.insert(sortedRows.begin() + at, row);
+    std::size_t slot = home(id);
+    while (table[slot] != emptySlot)
+        slot = (slot + 1) & (table.size() - 1);
+    table[slot] = std::uint64_t(ordered(id)) << 32 | row;
+}
+
+void EmployeeRegistry::bulkLoad(const std::vector<Employee>& more, unsigned threads) {
+    if (more.empty())
+        return;
+    if (more.size() > maxEmployees - size())
+        throw std::length_error("EmployeeRegistry over 2^32 - 2 employees");
+
+    // the new ids sorted, with the rows they will have
+    const std::size_t base = size();
+    std::vector<std::uint64_t> keys(more.size());
+    const unsigned fill = threadsFor(more.size(), threads);
+    parallel(fill, [&](unsigned t) {
+        for (std::size_t i = more.size() * t / fill; i < more.size() * (t + 1) / fill; ++i)
+            keys[i] = std::uint64_t(ordered(more[i].getId())) << 32 | (base + i);
+    });
+    radixSort(keys, threads);
+
+    // merged with the ids already here, refusing any id twice
+    std::vector<int> ids;
+    std::vector<std::uint32_t> rows;
+    ids.reserve(base + keys.size());
+    rows.reserve(base + keys.size());
+    std::size_t old = 0;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        const int id = unordered(static_cast<std::uint32_t>(keys[i] >> 32));
+        while (old < base && sortedIds[old] < id) {
+            ids.push_back(sortedIds[old]);
+            rows.push_back(sortedRows[old++]);
+        }
+        if ((old < base && sortedIds[old] == id) || (!ids.empty() && ids.back() == id))
+            throw std::invalid_argument("EmployeeRegistry already has id " + std::to_string(id));
+        ids.push_back(id);
+        rows.push_back(static_cast<std::uint32_t>(keys[i]));
+    }
+    ids.insert(ids.end(), sortedIds.begin() + old, sortedIds.end());
+    rows.insert(rows.end(), sortedRows.begin() + old, sortedRows.end());
+
+    employees.insert(employees.end(), more.begin(), more.end());
+    try {
+        rebuildTable(employees.size(), threads);
+    } catch (...) {
+        employees.erase(employees.begin() + base, employees.end());
+        throw;
+    }
+    sortedIds.swap(ids);
+    sortedRows.swap(rows);
+}
+
+std::vector<const Employee*> EmployeeRegistry::range(int lo, int hi) const {
+    std::vector<const Employee*> result;
+    if (lo > hi)
+        return result;
+    const std::size_t begin = std::lower_bound(sortedIds.begin(), sortedIds.end(), lo) - sortedIds.begin();
+    const std::size_t end = std::upper_bound(sortedIds.begin(), sortedIds.end(), hi) - sortedIds.begin();
+    result.reserve(end - begin);
+    for (std::size_t i = begin; i < end; ++i)
+        result.push_back(&employees[sortedRows[i]]);
+    return result;
+}
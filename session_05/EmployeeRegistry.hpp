@@ -0,0 +1,73 @@
+//
+// EmployeeRegistry.hpp
+//
+// A collection of Employees, for millions of them, indexed two ways by
+// employee id:
+//
+//   find(id)       an open addressing hash table of (id, row) pairs, one
+//                  word each, probed linearly: usually one cache line
+//   range(lo, hi)  the ids in ascending order, beside the rows they name,
+//                  so a range is a binary search and then a straight read
+//
+// bulkLoad() is the way in for many employees at once: it sorts the ids
+// with a parallel radix sort, which also finds duplicates before anything
+// changes, and fills the hash table from several threads. add() is for the
+// odd one, and shifts the sorted ids to make room.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "templatesEg.hpp"
+
+class EmployeeRegistry {
+public:
+    static unsigned defaultThreads() {
+        const unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+    std::size_t size() const { return employees.size(); }
+    bool empty() const { return employees.empty(); }
+
+    // throws std::invalid_argument if the id is already taken, and
+    // std::length_error past 2^32 - 1 employees
+    void add(const Employee& employee);
+
+    // adds every one of more, or, if any id is taken or repeated, throws
+    // std::invalid_argument and adds none
+    void bulkLoad(const std::vector<Employee>& more, unsigned threads = defaultThreads());
+
+    // the employee with id, or nullptr
+    const Employee* find(int id) const;
+    bool contains(int id) const { return find(id) != nullptr; }
+
+    // employees with lo <= id <= hi, by id
+    std::vector<const Employee*> range(int lo, int hi) const;
+
+    // the lowest and highest ids, or nullptr when empty
+    const Employee* lowestId() const { return empty() ? nullptr : &employees[sortedRows.front()]; }
+    const Employee* highestId() const { return empty() ? nullptr : &employees[sortedRows.back()]; }
+
+private:
+    static const std::uint64_t emptySlot = ~std::uint64_t(0);
+
+    // where id's probe starts, in this table or in one of 2^bits slots
+    std::size_t home(int id) const;
+    static std::size_t homeIn(int id, int bits);
+    // room for n employees at most half full, rebuilt from employees.
+    // Leaves the table as it was if it throws.
+    void rebuildTable(std::size_t n, unsigned threads);
+
+    std::vector<Employee> employees;
+    // the id in the top 32 bits, the row in employees in the bottom
+    std::vector<std::uint64_t> table;
+    int tableBits = 0;
+    // ids ascending, and the row of each
+    std::vector<int> sortedIds;
+    std::vector<std::uint32_t> sortedRows;
+};
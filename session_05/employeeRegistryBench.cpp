@@ -0,0 +1,128 @@
+//
+// EmployeeRegistry against the standard containers a collection of
+// Employees would otherwise be: a std::unordered_map from id for lookups,
+// and a std::map for ranges.
+//
+//   load        everyone at once: bulkLoad on 1 and on all threads, beside
+//               inserting each into the unordered_map, then into the map
+//   find hit    look up ids that are there, in random order
+//   find miss   and ids that are not
+//   range       the employees in random ranges of about 1000 ids
+//
+// Times are per employee, or per lookup, or per employee in a range.
+//
+// usage: employeeRegistryBench [employees]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "EmployeeRegistry.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double nsPer(Clock::time_point start, std::size_t n) {
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / n;
+}
+
+void line(const std::string& what, double registry, double standard) {
+    std::cout << std::setw(16) << what << std::setw(14) << registry << std::setw(14) << standard << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+
+    // ids spread over four times as many numbers, shuffled
+    std::mt19937 random(1);
+    std::vector<int> ids(n);
+    for (std::size_t i = 0; i < n; ++i)
+        ids[i] = static_cast<int>(4 * i) - static_cast<int>(2 * n);
+    std::shuffle(ids.begin(), ids.end(), random);
+    std::vector<Employee> all;
+    all.reserve(n);
+    for (int id : ids)
+        all.emplace_back("employee", id);
+
+    std::cout << n << " employees, " << EmployeeRegistry::defaultThreads() << " threads" << std::endl;
+    std::cout << std::setw(16) << "" << std::setw(14) << "registry" << std::setw(14) << "std" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    Clock::time_point start = Clock::now();
+    std::unordered_map<int, Employee> hashed;
+    hashed.reserve(n);
+    for (const Employee& e : all)
+        hashed.emplace(e.getId(), e);
+    const double hashedLoad = nsPer(start, n);
+    start = Clock::now();
+    std::map<int, Employee> ordered;
+    for (const Employee& e : all)
+        ordered.emplace(e.getId(), e);
+    const double orderedLoad = nsPer(start, n);
+
+    EmployeeRegistry registry1;
+    start = Clock::now();
+    registry1.bulkLoad(all, 1);
+    line("load ns, 1", nsPer(start, n), hashedLoad);
+    EmployeeRegistry registry;
+    start = Clock::now();
+    registry.bulkLoad(all);
+    line("load ns, all", nsPer(start, n), orderedLoad);
+
+    std::vector<int> hits(ids), misses(ids);
+    std::shuffle(hits.begin(), hits.end(), random);
+    for (int& id : misses)
+        id += 1;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        const std::vector<int>& lookups = pass ? misses : hits;
+        start = Clock::now();
+        std::size_t registryFound = 0;
+        for (int id : lookups)
+            registryFound += registry.find(id) != nullptr;
+        const double registryFind = nsPer(start, n);
+        start = Clock::now();
+        std::size_t hashedFound = 0;
+        for (int id : lookups)
+            hashedFound += hashed.find(id) != hashed.end();
+        line(pass ? "find miss ns" : "find hit ns", registryFind, nsPer(start, n));
+        if (registryFound != hashedFound)
+            std::cout << "finds differ!" << std::endl;
+    }
+
+    std::uniform_int_distribution<int> low(-2 * static_cast<int>(n), 2 * static_cast<int>(n));
+    std::vector<int> lows(10000);
+    for (int& lo : lows)
+        lo = low(random);
+    start = Clock::now();
+    std::size_t registryCount = 0, registryNames = 0;
+    for (int lo : lows)
+        for (const Employee* e : registry.range(lo, lo + 4000)) {
+            ++registryCount;
+            registryNames += e->getName().size();
+        }
+    const double registryRange = nsPer(start, registryCount ? registryCount : 1);
+    start = Clock::now();
+    std::size_t orderedCount = 0, orderedNames = 0;
+    for (int lo : lows)
+        for (auto it = ordered.lower_bound(lo); it != ordered.end() && it->first <= lo + 4000; ++it) {
+            ++orderedCount;
+            orderedNames += it->second.getName().size();
+        }
+    line("range ns", registryRange, nsPer(start, orderedCount ? orderedCount : 1));
+    if (registryCount != orderedCount || registryNames != orderedNames)
+        std::cout << "ranges differ!" << std::endl;
+    return 0;
+}
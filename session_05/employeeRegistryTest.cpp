@@ -0,0 +1,121 @@
+//
+// Checks EmployeeRegistry's find and range against a std::map holding the
+// same employees, added one at a time and in bulk, on one thread and on
+// several, and that a duplicate id leaves the registry as it was. Exits
+// non zero if anything is off.
+//
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../topics/testing/Check.hpp"
+#include "EmployeeRegistry.hpp"
+
+namespace {
+
+// n employees with distinct ids, negative ones included, in no order
+std::vector<Employee> employees(std::size_t n, std::mt19937& random) {
+    std::map<int, bool> taken;
+    std::uniform_int_distribution<int> id(-50000000, 50000000);
+    std::vector<Employee> result;
+    while (result.size() < n) {
+        const int i = id(random);
+        if (taken[i])
+            continue;
+        taken[i] = true;
+        result.emplace_back("e" + std::to_string(i), i);
+    }
+    return result;
+}
+
+// everything in registry matches expected
+void compare(const EmployeeRegistry& registry, const std::map<int, std::string>& expected, std::mt19937& random) {
+    CHECK(registry.size() == expected.size());
+    bool found = true;
+    for (const auto& e : expected) {
+        const Employee* p = registry.find(e.first);
+        found = found && p && p->getId() == e.first && p->getName() == e.second;
+    }
+    CHECK(found);
+
+    std::uniform_int_distribution<int> id(-60000000, 60000000);
+    bool absent = true, ranges = true;
+    for (int i = 0; i < 1000; ++i) {
+        const int missing = id(random);
+        absent = absent && (expected.count(missing) != 0) == registry.contains(missing);
+
+        int lo = id(random), hi = lo + id(random) / 100;
+        const std::vector<const Employee*> got = registry.range(lo, hi);
+        auto it = expected.lower_bound(lo);
+        std::size_t at = 0;
+        for (; it != expected.end() && it->first <= hi; ++it, ++at)
+            ranges = ranges && at < got.size() && got[at]->getId() == it->first;
+        ranges = ranges && at == got.size();
+    }
+    CHECK(absent);
+    CHECK(ranges);
+    if (!expected.empty()) {
+        CHECK(registry.lowestId()->getId() == expected.begin()->first);
+        CHECK(registry.highestId()->getId() == expected.rbegin()->first);
+    }
+}
+
+}
+
+int main() {
+    std::mt19937 random(7);
+
+    EmployeeRegistry none;
+    CHECK(none.empty() && !none.find(0) && none.range(-10, 10).empty() && !none.lowestId());
+
+    // one at a time, through several rebuilds of the table
+    EmployeeRegistry single;
+    std::map<int, std::string> expected;
+    for (const Employee& e : employees(5000, random)) {
+        single.add(e);
+        expected[e.getId()] = e.getName();
+    }
+    compare(single, expected, random);
+
+    bool threw = false;
+    try {
+        single.add(Employee("again", expected.begin()->first));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw && single.size() == expected.size());
+
+    // in bulk, large enough to split between threads, on top of some already there
+    for (unsigned threads : {1u, 4u}) {
+        EmployeeRegistry bulk;
+        const std::vector<Employee> all = employees(300000, random);
+        std::map<int, std::string> bulkExpected;
+        for (std::size_t i = 0; i < all.size(); ++i) {
+            bulkExpected[all[i].getId()] = all[i].getName();
+            if (i < 1000)
+                bulk.add(all[i]);
+        }
+        bulk.bulkLoad(std::vector<Employee>(all.begin() + 1000, all.end()), threads);
+        compare(bulk, bulkExpected, random);
+
+        // a repeat within the load, and one already loaded, each change nothing
+        std::vector<Employee> repeated{Employee("new", 60000001), Employee("new again", 60000001)};
+        std::vector<Employee> loaded{Employee("new", 60000002), all[12345]};
+        for (const std::vector<Employee>* bad : {&repeated, &loaded}) {
+            threw = false;
+            try {
+                bulk.bulkLoad(*bad, threads);
+            } catch (const std::invalid_argument&) {
+                threw = true;
+            }
+            CHECK(threw);
+        }
+        CHECK(!bulk.contains(60000001) && !bulk.contains(60000002));
+        compare(bulk, bulkExpected, random);
+    }
+
+    return checkResult();
+}
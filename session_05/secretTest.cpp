@@ -0,0 +1,22 @@
+//
+// Counts the copies and moves Secret<T> makes of its T, for a T that is
+// big, and for one that cannot be copied at all. Exits non zero if any
+// count is off.
+//
+
+#include "../topics/testing/SecretChecks.hpp"
+#include "templatesEg.hpp"
+
+namespace {
+
+struct Reveal {
+    template <typename T>
+    static const T& reveal(const Secret<T>& s) { return s.getSecret(); }
+};
+
+}
+
+int main() {
+    checkSecret<Secret, Reveal>();
+    return checkResult();
+}
@@ -4,17 +4,38 @@
 
 #pragma once
 #include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 //
 // Secret class template
 //
+// The secret is built directly in its member, never default constructed
+// and then assigned. Copies and moves are the compiler's, so Secret<T> can
+// be moved exactly when T can, is noexcept exactly when T's are, and is
+// not copyable when T is not.
+//
 template <typename T>
 class Secret {
     T secret;
 public:
-    Secret(const T& rhs) {
-        secret = rhs;
-    }
+    Secret(const T& rhs) : secret(rhs) {}
+    Secret(T&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) : secret(std::move(rhs)) {}
+
+    // in place: Secret<std::string> s(3, 'x') builds the string from 3 and 'x'
+    template <typename First, typename... Rest,
+              typename = typename std::enable_if<
+                      !std::is_same<typename std::decay<First>::type, Secret>::value &&
+                      std::is_constructible<T, First&&, Rest&&...>::value>::type>
+    explicit Secret(First&& first, Rest&&... rest)
+            noexcept(std::is_nothrow_constructible<T, First&&, Rest&&...>::value)
+            : secret(std::forward<First>(first), std::forward<Rest>(rest)...) {}
+
+    Secret(const Secret&) = default;
+    Secret(Secret&&) = default;
+    Secret& operator=(const Secret&) = default;
+    Secret& operator=(Secret&&) = default;
 
     const T& getSecret() const { return secret; }
 
@@ -68,8 +89,10 @@ public:
 // max specialization
 
 
+// inline, as a full specialization is an ordinary function, and would
+// otherwise be defined again by every file including this
 template <>
-const Employee2& max<Employee2>(Employee2 & lhs, Employee2 & rhs) {
+inline const Employee2& max<Employee2>(Employee2 & lhs, Employee2 & rhs) {
 
     return lhs.getId() < rhs.getId() ? lhs : rhs;
 }
@@ -0,0 +1,165 @@
+//
+// AtomicSharedPtr.hpp
+//
+// A SharedPtr which many threads may load and replace at once, without a
+// lock: for configuration, lookup tables and the like, read all the time
+// and swapped now and then.
+//
+//     AtomicSharedPtr<Config> current(makeShared<Config>(...));
+//     SharedPtr<Config> c = current.load();    // readers
+//     current.store(makeShared<Config>(...));   // a writer
+//
+// The catch with a plain SharedPtr is the gap between reading the control
+// block pointer and bumping the count in it: a writer may drop the last
+// reference in between, and the reader bumps a freed count. Split
+// reference counting closes the gap. The atomic word holds the block
+// pointer together with a count of readers borrowing it ( in the top 16
+// bits, which x86-64 and arm64 user space pointers leave at 0 short of 5
+// level paging or pointer tagging ), so one fetch_add both reads the
+// pointer and pins the block. The reader then takes a proper
+// strong reference, and hands the borrow back by decrementing the word if
+// it still holds the same block. A writer which swaps the block out first
+// adds the borrows it took with it to the strong count, for those readers
+// to drop instead.
+//
+// Nothing waits on anything: writers exchange the word outright, and
+// readers only retry a compare and swap that lost to another thread.
+//
+// Where a block does get an address using those bits, the store, exchange
+// or compare_exchange putting it there throws std::runtime_error instead.
+//
+// Each stored value gets a small control block of its own, wrapping the
+// SharedPtr passed in, so a store costs an allocation and a load none. The
+// SharedPtrs handed out own that wrapper, which keeps the value alive.
+//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#include "SharedPtr.hpp"
+
+// the control block of one stored value
+template <typename T>
+struct StoredBlock : ControlBlock<AtomicCount> {
+    SharedPtr<T> value;
+
+    explicit StoredBlock(SharedPtr<T> v) : value(std::move(v)) {}
+    void dispose() override { value.reset(); }
+};
+
+template <typename T>
+class AtomicSharedPtr {
+    static_assert(sizeof(std::uintptr_t) == 8, "the borrow count needs the top bits of a 64 bit pointer");
+
+    using Block = StoredBlock<T>;
+
+    static const int countShift = 48;
+    static const std::uintptr_t oneBorrow = std::uintptr_t(1) << countShift;
+    static const std::uintptr_t pointerMask = oneBorrow - 1;
+
+    // block pointer, and the borrows of it in the top 16 bits. Loading
+    // writes to it, logically const as that is.
+    mutable std::atomic<std::uintptr_t> word;
+
+    static Block* blockOf(std::uintptr_t w) { return reinterpret_cast<Block*>(w & pointerMask); }
+    static long borrowsOf(std::uintptr_t w) { return static_cast<long>(w >> countShift); }
+
+    // a new block holding p, with one strong reference for this to hold
+    static std::uintptr_t wrap(SharedPtr<T> p) {
+        if (!p)
+            return 0;
+        Block* b = new Block(std::move(p));
+        const std::uintptr_t w = reinterpret_cast<std::uintptr_t>(b);
+        if ((w & ~pointerMask) != 0) {
+            b->releaseStrong();
+            throw std::runtime_error("AtomicSharedPtr: block address uses the bits the borrow count needs");
+        }
+        return w;
+    }
+
+    // the SharedPtr for a block whose strong reference the caller holds
+    static SharedPtr<T> adopt(Block* b) {
+        if (b == nullptr)
+            return SharedPtr<T>();
+        return SharedPtr<T>(b->value.get(), static_cast<ControlBlock<AtomicCount>*>(b));
+    }
+
+    // hand the reference for a word this just swapped out to the caller:
+    // the borrows still out on it become strong references, for the
+    // readers to drop
+    static SharedPtr<T> retire(std::uintptr_t old) {
+        Block* b = blockOf(old);
+        if (b && borrowsOf(old) != 0)
+            b->strong.add(borrowsOf(old));
+        return adopt(b);
+    }
+
+public:
+    AtomicSharedPtr() : word(0) {}
+    explicit AtomicSharedPtr(SharedPtr<T> p) : word(wrap(std::move(p))) {}
+
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+    // nobody may be loading by now, so no borrows are out
+    ~AtomicSharedPtr() {
+        if (Block* b = blockOf(word.load(std::memory_order_acquire)))
+            b->releaseStrong();
+    }
+
+    bool isLockFree() const { return word.is_lock_free(); }
+
+    SharedPtr<T> load() const {
+        // acquire, to see the block the writer built
+        const std::uintptr_t w = word.fetch_add(oneBorrow, std::memory_order_acquire);
+        Block* b = blockOf(w);
+        if (b)
+            b->strong.increment();
+
+        // return the borrow, if the block is still there to return it to.
+        // Blocks are never reused while referenced, so the same pointer
+        // means the same block.
+        std::uintptr_t cur = word.load(std::memory_order_relaxed);
+        while (blockOf(cur) == b) {
+            if (word.compare_exchange_weak(cur, cur - oneBorrow, std::memory_order_release, std::memory_order_relaxed))
+                return adopt(b);
+        }
+        // a writer swapped it out, and turned the borrow into a reference
+        if (b)
+            b->releaseStrong();
+        return adopt(b);
+    }
+
+    // replace the value, returning the old one
+    SharedPtr<T> exchange(SharedPtr<T> desired) {
+        return retire(word.exchange(wrap(std::move(desired)), std::memory_order_acq_rel));
+    }
+
+    void store(SharedPtr<T> desired) { exchange(std::move(desired)); }
+
+    // replace the value with desired if it is still the one expected holds,
+    // which must have come from this object's load, exchange or
+    // compare_exchange. Otherwise expected gets the current value.
+    bool compare_exchange(SharedPtr<T>& expected, SharedPtr<T> desired) {
+        std::uintptr_t cur = word.load(std::memory_order_relaxed);
+        std::uintptr_t next = 0;
+        bool wrapped = false;
+        while (static_cast<ControlBlock<AtomicCount>*>(blockOf(cur)) == expected.block) {
+            if (!wrapped) {
+                next = wrap(std::move(desired));
+                wrapped = true;
+            }
+            // fails, and retries, if only the borrows changed
+            if (word.compare_exchange_weak(cur, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                retire(cur);
+                return true;
+            }
+        }
+        if (Block* unused = blockOf(next))
+            unused->releaseStrong();
+        expected = load();
+        return false;
+    }
+};
@@ -0,0 +1,23 @@
+//
+// CountingNew.cpp
+//
+
+#include "CountingNew.hpp"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<long> allocations{0};
+std::atomic<long> allocatedBytes{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(static_cast<long>(size), std::memory_order_relaxed);
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
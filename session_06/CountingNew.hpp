@@ -0,0 +1,14 @@
+//
+// CountingNew.hpp
+//
+// Heap counters for the benchmarks. Linking CountingNew.cpp into a program
+// replaces the global operator new with one which counts every allocation
+// and the bytes asked for, so a benchmark can read the counters before and
+// after the code it measures.
+//
+#pragma once
+
+#include <atomic>
+
+extern std::atomic<long> allocations;
+extern std::atomic<long> allocatedBytes;
@@ -0,0 +1,127 @@
+//
+// IntrusivePtr.hpp
+//
+// A reference counted pointer which keeps the count inside the object
+// itself. SharedPtr has to find the count in a control block beside the
+// object; here the object carries it, by deriving from RefCounted:
+//
+//     class Node : public RefCounted<Node> { ... };
+//     IntrusivePtr<Node> n = makeIntrusive<Node>(...);
+//
+// The pointer is then a single raw pointer, copying it touches only the
+// object, and an IntrusivePtr can be made again from a plain Node* ( this,
+// say ) without splitting the count.
+//
+// RefCounted takes the same count policies as SharedPtr: AtomicCount by
+// default, or SingleThreadCount for objects which never cross threads.
+//
+#pragma once
+
+#include <utility>
+
+#include "SharedPtr.hpp"
+
+template <typename T>
+class IntrusivePtr;
+
+// CRTP base: Derived is the class deriving from it, which is what gets
+// deleted when the last reference goes, so no virtual destructor is needed
+template <typename Derived, typename Count = AtomicCount>
+class RefCounted {
+    mutable Count refs;
+
+    template <typename T>
+    friend class IntrusivePtr;
+
+    void addRef() const { refs.increment(); }
+
+    // the only reference can skip the locked decrement
+    void releaseRef() const {
+        if (refs.unique() || refs.decrement())
+            delete static_cast<const Derived*>(this);
+    }
+
+protected:
+    RefCounted() : refs(0) {}
+    // a copy is a new object, which nobody refers to yet
+    RefCounted(const RefCounted&) : refs(0) {}
+    RefCounted& operator=(const RefCounted&) { return *this; }
+    ~RefCounted() {}
+
+public:
+    // number of IntrusivePtrs to this object. Only a snapshot when other
+    // threads hold some.
+    long refCount() const { return refs.get(); }
+};
+
+template <typename T>
+class IntrusivePtr {
+    T* ptr;
+
+public:
+    IntrusivePtr() : ptr{nullptr} {}
+
+    // take a reference to p, which must have been allocated with new
+    explicit IntrusivePtr(T* p) : ptr(p) {
+        if (ptr)
+            ptr->addRef();
+    }
+
+    IntrusivePtr(const IntrusivePtr& p) : ptr(p.ptr) {
+        if (ptr)
+            ptr->addRef();
+    }
+
+    IntrusivePtr(IntrusivePtr&& p) noexcept : ptr(p.ptr) {
+        p.ptr = nullptr;
+    }
+
+    // take the new reference before dropping the old one, in case both
+    // are the last references to the same object
+    IntrusivePtr& operator=(const IntrusivePtr& p) {
+        if (p.ptr)
+            p.ptr->addRef();
+        if (ptr)
+            ptr->releaseRef();
+        ptr = p.ptr;
+        return *this;
+    }
+
+    IntrusivePtr& operator=(IntrusivePtr&& p) noexcept {
+        if (this != &p) {
+            if (ptr)
+                ptr->releaseRef();
+            ptr = p.ptr;
+            p.ptr = nullptr;
+        }
+        return *this;
+    }
+
+    ~IntrusivePtr() {
+        if (ptr)
+            ptr->releaseRef();
+    }
+
+    // let go of the object, leaving this empty
+    void reset() {
+        if (ptr)
+            ptr->releaseRef();
+        ptr = nullptr;
+    }
+
+    // refer to p instead
+    void reset(T* p) { *this = IntrusivePtr(p); }
+
+    long useCount() const { return ptr ? ptr->refCount() : 0; }
+
+    T* get() const { return ptr; }
+    T& operator*() const { return *ptr; }
+    T* operator->() const { return ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
+};
+
+// an IntrusivePtr to a new T built from args
+template <typename T, typename... Args>
+IntrusivePtr<T> makeIntrusive(Args&&... args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
@@ -0,0 +1,162 @@
+//
+// NamePool.cpp
+//
+
+#include "NamePool.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// FNV-1a
+std::uint64_t hashOf(const char* s, std::size_t length) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < length; ++i) {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::uint64_t tagOf(std::uint64_t hash) { return hash & 0xffffffff00000000ull; }
+
+// the first slot to probe, from the low bits, which the tag does not use
+std::size_t homeOf(std::uint64_t hash, std::size_t mask) { return static_cast<std::size_t>(hash) & mask; }
+
+}
+
+const NamePool::Handle NamePool::none;
+
+NamePool::Table::Table(std::size_t capacity) : mask(capacity - 1), slots(new std::atomic<std::uint64_t>[capacity]) {
+    for (std::size_t i = 0; i < capacity; ++i)
+        slots[i].store(0, std::memory_order_relaxed);
+}
+
+NamePool::NamePool() :
+        directory(new std::atomic<std::atomic<const char*>*>[std::size_t(1) << (32 - segmentBits)]),
+        table(nullptr),
+        count(0),
+        nextFree(nullptr),
+        freeBytes(0),
+        arenaBytes(0)
+{
+    for (std::size_t i = 0; i < std::size_t(1) << (32 - segmentBits); ++i)
+        directory[i].store(nullptr, std::memory_order_relaxed);
+    tables.emplace_back(new Table(1024));
+    table.store(tables.back().get(), std::memory_order_release);
+}
+
+NamePool::~NamePool() {
+    for (std::size_t i = 0; i < std::size_t(1) << (32 - segmentBits); ++i)
+        delete[] directory[i].load(std::memory_order_relaxed);
+}
+
+NamePool::Handle NamePool::probe(const Table& t, std::uint64_t hash, const char* s, std::size_t length) const {
+    const std::uint64_t tag = tagOf(hash);
+    for (std::size_t i = homeOf(hash, t.mask);; i = (i + 1) & t.mask) {
+        const std::uint64_t slot = t.slots[i].load(std::memory_order_acquire);
+        if (slot == 0)
+            return none;
+        if (tagOf(slot) != tag)
+            continue;
+        const Handle h = static_cast<Handle>(slot) - 1;
+        if (length == this->length(h) && std::memcmp(c_str(h), s, length) == 0)
+            return h;
+    }
+}
+
+NamePool::Handle NamePool::find(const char* s, std::size_t length) const {
+    return probe(*table.load(std::memory_order_acquire), hashOf(s, length), s, length);
+}
+
+std::uint32_t NamePool::length(Handle h) const {
+    std::uint32_t n;
+    std::memcpy(&n, record(h), sizeof n);
+    return n;
+}
+
+NamePool::Handle NamePool::intern(const char* s, std::size_t length) {
+    const std::uint64_t hash = hashOf(s, length);
+    Handle h = probe(*table.load(std::memory_order_acquire), hash, s, length);
+    if (h != none)
+        return h;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // someone may have added it since, or grown the table under us
+    h = probe(*table.load(std::memory_order_relaxed), hash, s, length);
+    if (h != none)
+        return h;
+    h = static_cast<Handle>(count.load(std::memory_order_relaxed));
+    if (h == none)
+        throw std::length_error("NamePool is full");
+    if (length > 0xffffffffu)
+        throw std::length_error("NamePool string too long");
+
+    const std::size_t segment = h >> segmentBits;
+    if (directory[segment].load(std::memory_order_relaxed) == nullptr)
+        directory[segment].store(new std::atomic<const char*>[segmentSize], std::memory_order_release);
+    directory[segment].load(std::memory_order_relaxed)[h & (segmentSize - 1)].store(
+            store(s, length), std::memory_order_release);
+    count.store(h + std::size_t(1), std::memory_order_release);
+
+    // at most half full, so probes stay short and always end
+    if (2 * (h + std::size_t(1)) > table.load(std::memory_order_relaxed)->mask + 1)
+        grow();
+    else {
+        Table& t = *table.load(std::memory_order_relaxed);
+        std::size_t i = homeOf(hash, t.mask);
+        while (t.slots[i].load(std::memory_order_relaxed) != 0)
+            i = (i + 1) & t.mask;
+        t.slots[i].store(tagOf(hash) | (h + std::uint64_t(1)), std::memory_order_release);
+    }
+    return h;
+}
+
+const char* NamePool::store(const char* s, std::size_t length) {
+    // keep records 4 byte aligned for their length
+    const std::size_t need = (sizeof(std::uint32_t) + length + 1 + 3) & ~std::size_t(3);
+    if (need > freeBytes) {
+        const std::size_t size = need > chunkSize ? need : chunkSize;
+        chunks.emplace_back(new char[size]);
+        nextFree = chunks.back().get();
+        freeBytes = size;
+        arenaBytes += size;
+    }
+    char* r = nextFree;
+    const std::uint32_t n = static_cast<std::uint32_t>(length);
+    std::memcpy(r, &n, sizeof n);
+    std::memcpy(r + sizeof n, s, length);
+    r[sizeof n + length] = '\0';
+    nextFree += need;
+    freeBytes -= need;
+    return r;
+}
+
+// a table twice the size, holding every handle including the one just
+// added. The old one stays, for readers still in it.
+void NamePool::grow() {
+    const Table& old = *table.load(std::memory_order_relaxed);
+    tables.emplace_back(new Table(2 * (old.mask + 1)));
+    Table& t = *tables.back();
+    const std::size_t n = count.load(std::memory_order_relaxed);
+    for (std::size_t h = 0; h < n; ++h) {
+        const Handle handle = static_cast<Handle>(h);
+        const std::uint64_t hash = hashOf(c_str(handle), length(handle));
+        std::size_t i = homeOf(hash, t.mask);
+        while (t.slots[i].load(std::memory_order_relaxed) != 0)
+            i = (i + 1) & t.mask;
+        t.slots[i].store(tagOf(hash) | (h + 1), std::memory_order_relaxed);
+    }
+    table.store(&t, std::memory_order_release);
+}
+
+std::size_t NamePool::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t total = arenaBytes + (std::size_t(1) << (32 - segmentBits)) * sizeof(std::atomic<const char*>*);
+    for (std::size_t i = 0; i << segmentBits < count.load(std::memory_order_relaxed); ++i)
+        total += segmentSize * sizeof(std::atomic<const char*>);
+    for (const std::unique_ptr<Table>& t : tables)
+        total += (t->mask + 1) * sizeof(std::uint64_t);
+    return total;
+}
@@ -0,0 +1,89 @@
+//
+// NamePool.hpp
+//
+// String interning: every distinct string is stored once, and referred to
+// by a 32 bit handle. A directory of tens of millions of people has far
+// fewer distinct first and last names, so a person holding two handles
+// costs 8 bytes and no allocations, and copying one copies 8 bytes.
+//
+// The characters live in an arena of large chunks, never moved or freed
+// until the pool goes, so a handle stays valid for the life of the pool.
+// Looking up a handle, or an already interned string, takes no lock:
+// the hash table and the handle directory are published with release
+// stores, and a table replaced by a bigger one stays around for readers
+// still probing it. Adding a string takes a mutex.
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class NamePool {
+public:
+    using Handle = std::uint32_t;
+    static const Handle none = 0xffffffffu;
+
+    NamePool();
+    ~NamePool();
+
+    NamePool(const NamePool&) = delete;
+    NamePool& operator=(const NamePool&) = delete;
+
+    // the handle for s, adding it if it is new. Throws std::length_error
+    // if the pool already holds 2^32 - 1 strings.
+    Handle intern(const char* s, std::size_t length);
+    Handle intern(const std::string& s) { return intern(s.data(), s.size()); }
+
+    // the handle for s, or none if it was never interned
+    Handle find(const char* s, std::size_t length) const;
+    Handle find(const std::string& s) const { return find(s.data(), s.size()); }
+
+    // the string for h, 0 terminated
+    const char* c_str(Handle h) const { return record(h) + sizeof(std::uint32_t); }
+    std::uint32_t length(Handle h) const;
+    std::string str(Handle h) const { return std::string(c_str(h), length(h)); }
+
+    std::size_t size() const { return count.load(std::memory_order_acquire); }
+    // arena, directory and table bytes
+    std::size_t bytes() const;
+
+private:
+    // open addressing: the top 32 bits of the hash, and the handle + 1
+    // ( 0 for an empty slot ), in one word
+    struct Table {
+        std::size_t mask;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+        explicit Table(std::size_t capacity);
+    };
+
+    static const int segmentBits = 16;
+    static const std::size_t segmentSize = std::size_t(1) << segmentBits;
+    static const std::size_t chunkSize = std::size_t(1) << 16;
+
+    const char* record(Handle h) const {
+        return directory[h >> segmentBits].load(std::memory_order_acquire)[h & (segmentSize - 1)].load(
+                std::memory_order_acquire);
+    }
+    Handle probe(const Table& table, std::uint64_t hash, const char* s, std::size_t length) const;
+    // copy s into the arena as its record: length, characters and a 0
+    const char* store(const char* s, std::size_t length);
+    void grow();
+
+    // records by handle, a segment at a time so that none ever moves
+    std::unique_ptr<std::atomic<std::atomic<const char*>*>[]> directory;
+    std::atomic<Table*> table;
+    std::atomic<std::size_t> count;
+
+    // only touched with mutex held
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Table>> tables;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char* nextFree;
+    std::size_t freeBytes;
+    std::size_t arenaBytes;
+};
@@ -6,6 +6,9 @@
 #define CPP_HAPPY_FUN_TIME_PERSON_HPP
 #include <string>
 
+// The broken first attempt: no copy or move operations, so copies share,
+// and delete, the same strings. main.cpp shows what goes wrong, and
+// PersonBetter fixes it.
 class Person {
     std::string* firstname;
     std::string* lastname;
@@ -5,11 +5,26 @@
 #include "PersonBetter.hpp"
 #include <iostream>
 #include <string>
+#include <utility>
 
 using std::string;
 using std::cout;
 using std::endl;
 
+namespace {
+
+// a moved from PersonBetter has no strings, and copies as one without any
+std::string* copyOf(const std::string* s) {
+    return s ? new std::string(*s) : nullptr;
+}
+
+const std::string& orEmpty(const std::string* s) {
+    static const std::string empty;
+    return s ? *s : empty;
+}
+
+}
+
 PersonBetter::PersonBetter(const std::string &fn, const std::string &ln) :
         firstname(new std::string(fn)),
         lastname(new std::string(ln))
@@ -19,7 +34,7 @@ PersonBetter::PersonBetter(const std::string &fn, const std::string &ln) :
 }
 
 void PersonBetter::greet() const {
-    cout << "hi my name is " << *firstname << " " << *lastname << endl;
+    cout << "hi my name is " << orEmpty(firstname) << " " << orEmpty(lastname) << endl;
 }
 
 PersonBetter::~PersonBetter() {
@@ -31,8 +46,8 @@ PersonBetter::~PersonBetter() {
 }
 
 PersonBetter::PersonBetter(const PersonBetter& other) {
-    firstname = new std::string(*other.firstname);
-    lastname = new std::string(*other.lastname);
+    firstname = copyOf(other.firstname);
+    lastname = copyOf(other.lastname);
 }
 
 // assignment operator
@@ -44,8 +59,35 @@ PersonBetter& PersonBetter::operator=(const PersonBetter& other) {
             delete firstname;
         if (lastname != nullptr)
             delete lastname;
-        firstname = new std::string(*other.firstname);
-        lastname = new std::string(*other.lastname);
+        firstname = copyOf(other.firstname);
+        lastname = copyOf(other.lastname);
+    }
+    return *this;
+}
+
+// move constructor. Takes other's strings instead of copying them.
+PersonBetter::PersonBetter(PersonBetter&& other) noexcept :
+        firstname(other.firstname),
+        lastname(other.lastname)
+{
+    other.firstname = nullptr;
+    other.lastname = nullptr;
+}
+
+// move assignment
+PersonBetter& PersonBetter::operator=(PersonBetter&& other) noexcept {
+    if(this != &other) {
+        delete firstname;
+        delete lastname;
+        firstname = other.firstname;
+        lastname = other.lastname;
+        other.firstname = nullptr;
+        other.lastname = nullptr;
     }
     return *this;
-}
\ No newline at end of file
+}
+
+void PersonBetter::swap(PersonBetter& other) noexcept {
+    std::swap(firstname, other.firstname);
+    std::swap(lastname, other.lastname);
+}
@@ -15,8 +15,16 @@ public:
     void greet() const;
     PersonBetter(const PersonBetter& other);
     PersonBetter& operator=(const PersonBetter& other);
+    // moves steal the strings, leaving other without any: it greets, copies
+    // and assigns as a person with empty names. noexcept, or std::vector
+    // copies instead when it grows.
+    PersonBetter(PersonBetter&& other) noexcept;
+    PersonBetter& operator=(PersonBetter&& other) noexcept;
+    void swap(PersonBetter& other) noexcept;
     ~PersonBetter();
 };
 
+inline void swap(PersonBetter& a, PersonBetter& b) noexcept { a.swap(b); }
+
 
 #endif //CPP_HAPPY_FUN_TIME_PERSONBETTER_HPP
@@ -0,0 +1,25 @@
+//
+// PersonInterned.cpp
+//
+
+#include "PersonInterned.hpp"
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+PersonInterned::PersonInterned(const std::string &fn, const std::string &ln) :
+        firstname(names().intern(fn)),
+        lastname(names().intern(ln))
+{
+}
+
+void PersonInterned::greet() const {
+    cout << "hi my name is " << firstName() << " " << lastName() << endl;
+}
+
+NamePool& PersonInterned::names() {
+    // never destroyed, so PersonInterneds in other statics may outlive it
+    static NamePool* pool = new NamePool();
+    return *pool;
+}
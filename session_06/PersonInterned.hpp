@@ -0,0 +1,34 @@
+//
+// PersonInterned.hpp
+//
+// A Person which holds its names as handles into a NamePool, shared by
+// every PersonInterned. Where Person and PersonBetter allocate two strings
+// each, and copy them on every copy, this is two 32 bit handles: the
+// default copy and assignment are right, and cost 8 bytes.
+//
+
+#pragma once
+
+#include <string>
+
+#include "NamePool.hpp"
+
+class PersonInterned {
+    NamePool::Handle firstname;
+    NamePool::Handle lastname;
+public:
+    PersonInterned(const std::string& fn, const std::string& ln);
+
+    void greet() const;
+
+    const char* firstName() const { return names().c_str(firstname); }
+    const char* lastName() const { return names().c_str(lastname); }
+
+    // the names are the same string exactly when the handles are
+    bool sameName(const PersonInterned& other) const {
+        return firstname == other.firstname && lastname == other.lastname;
+    }
+
+    // the pool every PersonInterned's names live in
+    static NamePool& names();
+};
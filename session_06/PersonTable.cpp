@@ -0,0 +1,362 @@
+//
+// PersonTable.cpp
+//
+
+#include "PersonTable.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+
+using std::cout;
+using std::endl;
+
+namespace {
+
+const std::size_t maxSize = 0xffffffffu;
+
+// a row being sorted, with a window of its key: up to 16 bytes of one of
+// its names from some depth on, most significant first and 0 past the end.
+// The first pass also keeps the first 8 bytes of the first name, for when
+// the last names tie. The names themselves are only read, a row at a time
+// from all over memory, when those run out.
+struct Entry {
+    std::uint64_t key[2];
+    std::uint64_t firstName;
+    std::uint32_t row;
+};
+
+// the part of the key an Entry holds: limit bytes of column from depth
+struct Window {
+    int column;
+    std::size_t depth;
+    int limit;
+};
+
+// below this many rows a comparison sort beats another radix pass
+const std::size_t smallRange = 16;
+
+enum { LastName, FirstName };
+
+// s up to its first 0 byte, which is where the sort takes it to end
+PersonTable::Name untilNul(const PersonTable::Name& s) {
+    const void* nul = s.size ? std::memchr(s.data, 0, s.size) : nullptr;
+    return nul ? PersonTable::Name{s.data, static_cast<std::uint32_t>(static_cast<const char*>(nul) - s.data)} : s;
+}
+
+int compare(PersonTable::Name a, PersonTable::Name b) {
+    a = untilNul(a);
+    b = untilNul(b);
+    const int c = std::memcmp(a.data, b.data, std::min(a.size, b.size));
+    if (c != 0)
+        return c;
+    return a.size < b.size ? -1 : a.size > b.size;
+}
+
+// 8 bytes of s from depth, most significant first, and 0 from its end or
+// its first 0 byte on. ended carries that across the words of one window;
+// a window is only filled past depth 0 once the bytes before it all
+// turned out nonzero.
+std::uint64_t word(const PersonTable::Name& s, std::size_t depth, bool& ended) {
+    std::uint64_t w = 0;
+    for (std::size_t b = 0; b < 8; ++b) {
+        const unsigned c = !ended && depth + b < s.size ? static_cast<unsigned char>(s.data[depth + b]) : 0u;
+        ended = ended || c == 0;
+        w = w << 8 | c;
+    }
+    return w;
+}
+
+class RadixSort {
+    const PersonTable& table;
+
+    PersonTable::Name name(std::uint32_t row, int column) const {
+        return column == LastName ? table.last(row) : table.first(row);
+    }
+
+    Window fill(Entry* a, std::size_t n, int column, std::size_t depth) const {
+        for (std::size_t i = 0; i < n; ++i) {
+            const PersonTable::Name s = name(a[i].row, column);
+            bool ended = false;
+            a[i].key[0] = word(s, depth, ended);
+            a[i].key[1] = word(s, depth + 8, ended);
+        }
+        return Window{column, depth, 16};
+    }
+
+    static unsigned byteOf(const Entry& e, int position) {
+        return static_cast<unsigned>(e.key[position >> 3] >> (56 - 8 * (position & 7))) & 0xff;
+    }
+
+    static PersonTable::Name from(PersonTable::Name s, std::size_t depth) {
+        const std::uint32_t skip = static_cast<std::uint32_t>(std::min<std::size_t>(depth, s.size));
+        return PersonTable::Name{s.data + skip, s.size - skip};
+    }
+
+    // for entries agreeing on everything before the window: the names are
+    // only read when the windows tie
+    bool less(const Entry& a, const Entry& b, const Window& w) const {
+        if (a.key[0] != b.key[0])
+            return a.key[0] < b.key[0];
+        if (a.key[1] != b.key[1])
+            return a.key[1] < b.key[1];
+        const std::size_t past = w.depth + w.limit;
+        int c = compare(from(untilNul(name(a.row, w.column)), past), from(untilNul(name(b.row, w.column)), past));
+        if (c == 0 && w.column == LastName)
+            c = compare(table.first(a.row), table.first(b.row));
+        return c < 0 || (c == 0 && a.row < b.row);
+    }
+
+public:
+    explicit RadixSort(const PersonTable& t) : table(t) {}
+
+    // fill a[0, n) for the first pass, in row order
+    void start(Entry* a, std::size_t begin, std::size_t n) const {
+        for (std::size_t i = 0; i < n; ++i) {
+            a[i].row = static_cast<std::uint32_t>(begin + i);
+            bool ended = false;
+            a[i].firstName = word(table.first(a[i].row), 0, ended);
+        }
+        fill(a, n, LastName, 0);
+    }
+
+    // a[0, n) share every key byte before position
+    void sort(Entry* a, Entry* tmp, std::size_t n, const Window& w, int position) const {
+        if (n < smallRange) {
+            std::sort(a, a + n, [&](const Entry& x, const Entry& y) { return less(x, y, w); });
+            return;
+        }
+        std::size_t counts[256] = {};
+        for (std::size_t i = 0; i < n; ++i)
+            ++counts[byteOf(a[i], position)];
+        // a shared prefix splits nothing, so skip the scatter
+        const unsigned only = byteOf(a[0], position);
+        if (counts[only] == n) {
+            descend(a, tmp, n, w, position, only);
+            return;
+        }
+        std::size_t starts[256];
+        std::size_t at = 0;
+        for (int b = 0; b < 256; ++b) {
+            starts[b] = at;
+            at += counts[b];
+        }
+        for (std::size_t i = 0; i < n; ++i)
+            tmp[starts[byteOf(a[i], position)]++] = a[i];
+        std::copy(tmp, tmp + n, a);
+        at = 0;
+        for (unsigned b = 0; b < 256; ++b) {
+            descend(a + at, tmp + at, counts[b], w, position, b);
+            at += counts[b];
+        }
+    }
+
+    // a[0, n) all have byte at position; sort them on what follows
+    void descend(Entry* a, Entry* tmp, std::size_t n, const Window& w, int position, unsigned byte) const {
+        if (n < 2)
+            return;
+        if (byte == 0) {
+            // the name ended: equal last names go on to the first name,
+            // and equal first names are left in row order
+            if (w.column == LastName) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    a[i].key[0] = a[i].firstName;
+                    a[i].key[1] = 0;
+                }
+                sort(a, tmp, n, Window{FirstName, 0, 8}, 0);
+            }
+        } else if (position == w.limit - 1)
+            sort(a, tmp, n, fill(a, n, w.column, w.depth + w.limit), 0);
+        else
+            sort(a, tmp, n, w, position + 1);
+    }
+
+    // the first pass in parallel, distributing on the first byte of the
+    // last name, then the buckets in parallel, biggest first
+    std::vector<std::uint32_t> run(unsigned threads) const {
+        const std::size_t n = table.size();
+        if (n < std::size_t(1) << 16)
+            threads = 1;
+        std::vector<Entry> entries(n), tmp(n);
+        std::vector<std::vector<std::size_t>> counts(threads, std::vector<std::size_t>(256));
+        std::vector<std::size_t> begins(threads + 1);
+        for (unsigned t = 0; t <= threads; ++t)
+            begins[t] = n * t / threads;
+
+        std::vector<std::thread> workers;
+        auto parallel = [&](const std::function<void(unsigned)>& f) {
+            workers.clear();
+            for (unsigned t = 1; t < threads; ++t)
+                workers.emplace_back(f, t);
+            f(0);
+            for (std::thread& w : workers)
+                w.join();
+        };
+
+        parallel([&](unsigned t) {
+            start(entries.data() + begins[t], begins[t], begins[t + 1] - begins[t]);
+            for (std::size_t i = begins[t]; i < begins[t + 1]; ++i)
+                ++counts[t][byteOf(entries[i], 0)];
+        });
+        // each thread's place in each bucket: bucket by bucket, and thread
+        // by thread within one, which keeps the pass stable
+        std::vector<std::size_t> bucketBegins(257);
+        std::size_t at = 0;
+        for (int b = 0; b < 256; ++b) {
+            bucketBegins[b] = at;
+            for (unsigned t = 0; t < threads; ++t) {
+                const std::size_t c = counts[t][b];
+                counts[t][b] = at;
+                at += c;
+            }
+        }
+        bucketBegins[256] = n;
+        parallel([&](unsigned t) {
+            for (std::size_t i = begins[t]; i < begins[t + 1]; ++i)
+                tmp[counts[t][byteOf(entries[i], 0)]++] = entries[i];
+        });
+
+        std::vector<unsigned> order(256);
+        for (unsigned b = 0; b < 256; ++b)
+            order[b] = b;
+        std::sort(order.begin(), order.end(), [&](unsigned x, unsigned y) {
+            return bucketBegins[x + 1] - bucketBegins[x] > bucketBegins[y + 1] - bucketBegins[y];
+        });
+        std::atomic<unsigned> next{0};
+        parallel([&](unsigned) {
+            for (unsigned i; (i = next++) < 256;) {
+                const unsigned b = order[i];
+                const std::size_t begin = bucketBegins[b];
+                // sorted in tmp, with entries as the scratch space
+                descend(tmp.data() + begin, entries.data() + begin, bucketBegins[b + 1] - begin,
+                        Window{LastName, 0, 16}, 0, b);
+            }
+        });
+
+        std::vector<std::uint32_t> rows(n);
+        parallel([&](unsigned t) {
+            for (std::size_t i = begins[t]; i < begins[t + 1]; ++i)
+                rows[i] = tmp[i].row;
+        });
+        return rows;
+    }
+};
+
+}
+
+void PersonTable::Column::append(const char* s, std::size_t n) {
+    if (chars.size() + n > maxSize)
+        throw std::length_error("PersonTable column over 2^32 characters");
+    chars.insert(chars.end(), s, s + n);
+    offsets.push_back(static_cast<std::uint32_t>(chars.size()));
+}
+
+void PersonTable::Column::gather(const Column& from, const std::vector<std::uint32_t>& rows, unsigned threads) {
+    const std::size_t n = rows.size();
+    std::vector<std::size_t> chunkChars(threads < 1 ? 1 : threads);
+    offsets.assign(n + 1, 0);
+    // the lengths of each chunk's rows, then where each chunk starts, then
+    // the offsets and characters of the chunks at once
+    forChunks(n, threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+        std::size_t total = 0;
+        for (std::size_t i = begin; i < end; ++i)
+            total += from.offsets[rows[i] + 1] - from.offsets[rows[i]];
+        chunkChars[t] = total;
+    });
+    std::size_t total = 0;
+    for (std::size_t& c : chunkChars) {
+        const std::size_t size = c;
+        c = total;
+        total += size;
+    }
+    chars.resize(total);
+    forChunks(n, threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+        std::size_t at = chunkChars[t];
+        for (std::size_t i = begin; i < end; ++i) {
+            const Name s = from.name(rows[i]);
+            std::memcpy(chars.data() + at, s.data, s.size);
+            at += s.size;
+            offsets[i + 1] = static_cast<std::uint32_t>(at);
+        }
+    });
+}
+
+void PersonTable::reserve(std::size_t people, std::size_t chars) {
+    firstnames.offsets.reserve(firstnames.offsets.size() + people);
+    lastnames.offsets.reserve(lastnames.offsets.size() + people);
+    firstnames.chars.reserve(firstnames.chars.size() + chars);
+    lastnames.chars.reserve(lastnames.chars.size() + chars);
+}
+
+void PersonTable::append(const std::string& first, const std::string& last) {
+    if (size() >= maxSize)
+        throw std::length_error("PersonTable over 2^32 - 1 people");
+    firstnames.append(first.data(), first.size());
+    lastnames.append(last.data(), last.size());
+}
+
+void PersonTable::append(const std::vector<std::string>& first, const std::vector<std::string>& last) {
+    if (first.size() != last.size())
+        throw std::invalid_argument("PersonTable::append needs as many first names as last names");
+    if (size() + first.size() > maxSize)
+        throw std::length_error("PersonTable over 2^32 - 1 people");
+    std::size_t firstChars = 0, lastChars = 0;
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        firstChars += first[i].size();
+        lastChars += last[i].size();
+    }
+    firstnames.offsets.reserve(firstnames.offsets.size() + first.size());
+    lastnames.offsets.reserve(lastnames.offsets.size() + first.size());
+    firstnames.chars.reserve(firstnames.chars.size() + firstChars);
+    lastnames.chars.reserve(lastnames.chars.size() + lastChars);
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        firstnames.append(first[i].data(), first[i].size());
+        lastnames.append(last[i].data(), last[i].size());
+    }
+}
+
+void PersonTable::append(const PersonTable& other) {
+    if (&other == this) {
+        const PersonTable copy(other);
+        append(copy);
+        return;
+    }
+    if (size() + other.size() > maxSize)
+        throw std::length_error("PersonTable over 2^32 - 1 people");
+    for (int c = 0; c < 2; ++c) {
+        Column& to = c == 0 ? firstnames : lastnames;
+        const Column& from = c == 0 ? other.firstnames : other.lastnames;
+        const std::size_t base = to.chars.size();
+        if (base + from.chars.size() > maxSize)
+            throw std::length_error("PersonTable column over 2^32 characters");
+        to.chars.insert(to.chars.end(), from.chars.begin(), from.chars.end());
+        to.offsets.reserve(to.offsets.size() + from.offsets.size() - 1);
+        for (std::size_t i = 1; i < from.offsets.size(); ++i)
+            to.offsets.push_back(static_cast<std::uint32_t>(base + from.offsets[i]));
+    }
+}
+
+void PersonTable::greet(std::size_t row) const {
+    cout << "hi my name is " << first(row).str() << " " << last(row).str() << endl;
+}
+
+PersonTable PersonTable::gather(const std::vector<std::uint32_t>& rows, unsigned threads) const {
+    PersonTable result;
+    result.firstnames.gather(firstnames, rows, threads);
+    result.lastnames.gather(lastnames, rows, threads);
+    return result;
+}
+
+void PersonTable::sortByName(unsigned threads) {
+    if (threads < 1)
+        threads = 1;
+    const std::vector<std::uint32_t> rows = RadixSort(*this).run(threads);
+    *this = gather(rows, threads);
+}
+
+std::size_t PersonTable::bytes() const {
+    return (firstnames.offsets.size() + lastnames.offsets.size()) * sizeof(std::uint32_t) +
+           firstnames.chars.size() + lastnames.chars.size();
+}
@@ -0,0 +1,130 @@
+//
+// PersonTable.hpp
+//
+// Millions of people, stored by column instead of one object each. All the
+// first names sit end to end in one block of characters, with an array of
+// offsets saying where each begins, and the last names likewise: four
+// allocations for the whole table, instead of several per person, and a
+// scan over the names reads memory straight through.
+//
+//     PersonTable people;
+//     people.append(firstNames, lastNames);
+//     people.sortByName();
+//     PersonTable smiths = people.filter([](PersonTable::Name, PersonTable::Name last) {
+//         return last == "Smith";
+//     });
+//
+// Sorting is by last name, then first name, comparing bytes. It is a most
+// significant digit radix sort of the row numbers, whose first pass, and
+// then whose buckets, are split between threads. The rows are then moved
+// into the new order a column at a time.
+//
+// Rows are 32 bit, so a table holds fewer than 2^32 people, and the names
+// of each column fewer than 2^32 characters.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PersonTable {
+public:
+    // a name in the table, valid until the table next changes
+    struct Name {
+        const char* data;
+        std::uint32_t size;
+
+        std::string str() const { return std::string(data, size); }
+        bool operator==(const char* s) const { return std::strlen(s) == size && std::memcmp(data, s, size) == 0; }
+        bool operator==(const std::string& s) const { return s.size() == size && std::memcmp(data, s.data(), size) == 0; }
+    };
+
+    static unsigned defaultThreads() {
+        const unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+    std::size_t size() const { return firstnames.offsets.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    // room for people more rows, and chars more characters in each column
+    void reserve(std::size_t people, std::size_t chars);
+
+    void append(const std::string& first, const std::string& last);
+    // many people at once, first[i] and last[i] each. Throws
+    // std::invalid_argument if the two differ in size.
+    void append(const std::vector<std::string>& first, const std::vector<std::string>& last);
+    void append(const PersonTable& other);
+
+    Name first(std::size_t row) const { return firstnames.name(row); }
+    Name last(std::size_t row) const { return lastnames.name(row); }
+
+    void greet(std::size_t row) const;
+
+    // the rows for which pred(first, last) is true, in order. pred is
+    // called from several threads at once.
+    template <typename Pred>
+    PersonTable filter(Pred pred, unsigned threads = defaultThreads()) const;
+
+    // by last name, then first name. Stable, so the same on any number of
+    // threads. Names containing a 0 byte sort as if they ended there.
+    void sortByName(unsigned threads = defaultThreads());
+
+    // characters and offsets of both columns
+    std::size_t bytes() const;
+
+private:
+    struct Column {
+        std::vector<std::uint32_t> offsets{0};
+        std::vector<char> chars;
+
+        Name name(std::size_t row) const {
+            return Name{chars.data() + offsets[row], offsets[row + 1] - offsets[row]};
+        }
+        void append(const char* s, std::size_t n);
+        // the given rows of from, in that order
+        void gather(const Column& from, const std::vector<std::uint32_t>& rows, unsigned threads);
+    };
+
+    // [begin, end) of [0, n) for each of threads calls, f(begin, end, t)
+    template <typename F>
+    static void forChunks(std::size_t n, unsigned threads, F f);
+
+    PersonTable gather(const std::vector<std::uint32_t>& rows, unsigned threads) const;
+
+    Column firstnames, lastnames;
+};
+
+template <typename F>
+void PersonTable::forChunks(std::size_t n, unsigned threads, F f) {
+    if (threads < 1)
+        threads = 1;
+    // not worth a thread for less
+    const std::size_t grain = 1 << 14;
+    if (n / grain < threads)
+        threads = static_cast<unsigned>(n / grain > 0 ? n / grain : 1);
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(f, n * t / threads, n * (t + 1) / threads, t);
+    f(0, n / threads, 0u);
+    for (std::thread& w : workers)
+        w.join();
+}
+
+template <typename Pred>
+PersonTable PersonTable::filter(Pred pred, unsigned threads) const {
+    std::vector<std::vector<std::uint32_t>> kept(threads < 1 ? 1 : threads);
+    forChunks(size(), threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+        for (std::size_t row = begin; row < end; ++row)
+            if (pred(first(row), last(row)))
+                kept[t].push_back(static_cast<std::uint32_t>(row));
+    });
+    std::vector<std::uint32_t> rows;
+    for (const std::vector<std::uint32_t>& k : kept)
+        rows.insert(rows.end(), k.begin(), k.end());
+    return gather(rows, threads);
+}
@@ -0,0 +1,183 @@
+//
+// Reclaimer.hpp
+//
+// Deferred destruction. When the last SharedPtr to a big structure goes
+// away, deleting it tears down everything it owns, right there on the
+// thread which happened to let go. A Reclaimer takes that work to a
+// background thread instead: the releasing thread only appends the pointer
+// to a queue, and the reclaimer thread deletes whatever has piled up, a
+// batch at a time.
+//
+// It is opt in, per pointer, as a deleter:
+//
+//     Reclaimer reclaimer;
+//     SharedPtr<Graph> g(new Graph(), DeferredDelete<Graph>(reclaimer));
+//
+// Only the object handed to the deleter moves; whatever it owns is freed
+// by its destructor, on the reclaimer thread. makeShared objects live in
+// their control block, so they cannot be deferred this way.
+//
+// The queue is bounded. If the reclaimer falls that far behind, releasing
+// threads wait for it to make room rather than let garbage grow without
+// limit, and each thread counts how often and how long it waited.
+//
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class Reclaimer {
+public:
+    // what the calling thread has handed to any Reclaimer
+    struct ThreadStats {
+        long retired = 0;
+        // retire() calls which had to wait for a full queue, and how long
+        // they waited in total and at worst
+        long stalls = 0;
+        double stallNs = 0;
+        double maxStallNs = 0;
+    };
+
+    // what the reclaimer thread has done
+    struct Stats {
+        long batches = 0;
+        long objects = 0;
+        std::size_t largestBatch = 0;
+        double drainNs = 0;
+    };
+
+    // capacity is how many objects may wait before retire() blocks. Throws
+    // std::invalid_argument for 0, with which every retire() would block.
+    explicit Reclaimer(std::size_t capacity = 4096) : capacity(capacity) {
+        if (capacity == 0)
+            throw std::invalid_argument("Reclaimer capacity must be at least 1");
+        queue.reserve(capacity);
+        worker = std::thread([this] { run(); });
+    }
+
+    // destroys everything still queued. Every pointer using this must be
+    // gone by then.
+    ~Reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        notEmpty.notify_one();
+        worker.join();
+    }
+
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    template <typename T>
+    void retire(T* p) {
+        retire(p, [](void* q) { delete static_cast<T*>(q); });
+    }
+
+    // queue p to be destroyed by calling destroy(p) on the reclaimer thread
+    void retire(void* p, void (*destroy)(void*)) {
+        ThreadStats& mine = threadStats();
+        ++mine.retired;
+        // an object destroyed on the reclaimer thread may retire more, and
+        // waiting for room there would wait for itself
+        if (std::this_thread::get_id() == worker.get_id()) {
+            destroy(p);
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (queue.size() >= capacity) {
+            const auto start = std::chrono::steady_clock::now();
+            notFull.wait(lock, [this] { return queue.size() < capacity; });
+            const std::chrono::duration<double, std::nano> waited = std::chrono::steady_clock::now() - start;
+            ++mine.stalls;
+            mine.stallNs += waited.count();
+            if (waited.count() > mine.maxStallNs)
+                mine.maxStallNs = waited.count();
+        }
+        const bool wasEmpty = queue.empty();
+        queue.push_back(Entry{p, destroy});
+        ++retired;
+        lock.unlock();
+        if (wasEmpty)
+            notEmpty.notify_one();
+    }
+
+    // wait until everything retired so far has been destroyed
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        const long target = retired;
+        drained.wait(lock, [this, target] { return destroyed >= target; });
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reclaimed;
+    }
+
+    // the calling thread's counts, for all Reclaimers together
+    static ThreadStats& threadStats() {
+        static thread_local ThreadStats stats;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    void run() {
+        // swapped with the queue, so that neither side allocates once both
+        // have grown to capacity
+        std::vector<Entry> batch;
+        batch.reserve(capacity);
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            notEmpty.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+            batch.swap(queue);
+            lock.unlock();
+            notFull.notify_all();
+
+            const auto start = std::chrono::steady_clock::now();
+            for (const Entry& e : batch)
+                e.destroy(e.object);
+            const std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;
+
+            lock.lock();
+            ++reclaimed.batches;
+            reclaimed.objects += static_cast<long>(batch.size());
+            if (batch.size() > reclaimed.largestBatch)
+                reclaimed.largestBatch = batch.size();
+            reclaimed.drainNs += took.count();
+            destroyed += static_cast<long>(batch.size());
+            batch.clear();
+            drained.notify_all();
+        }
+    }
+
+    const std::size_t capacity;
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty, notFull, drained;
+    std::vector<Entry> queue;
+    bool stopping = false;
+    long retired = 0, destroyed = 0;
+    Stats reclaimed;
+    std::thread worker;
+};
+
+// a SharedPtr deleter which hands the object to a Reclaimer, which must
+// outlive the pointer
+template <typename T>
+struct DeferredDelete {
+    Reclaimer* reclaimer;
+
+    explicit DeferredDelete(Reclaimer& r) : reclaimer(&r) {}
+    void operator()(T* p) const { reclaimer->retire(p); }
+};
@@ -3,53 +3,348 @@
 //
 
 #pragma once
+#include <atomic>
 #include <iostream>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//
+// reference count policies
+//
+// The count is shared by every copy of a SharedPtr. If copies live on
+// different threads, two of them may bump it at the same time, and a plain
+// int loses updates. AtomicCount is safe for that, and is the default.
+// SingleThreadCount is a plain integer, for code which never lets a
+// SharedPtr cross threads and does not want to pay for the atomics.
+//
+struct AtomicCount {
+    std::atomic<long> n;
+
+    explicit AtomicCount(long start) : n(start) {}
+
+    // taking another reference needs no ordering: the caller already holds
+    // one, so nothing can be freed under it
+    void increment() { n.fetch_add(1, std::memory_order_relaxed); }
+    void add(long k) { n.fetch_add(k, std::memory_order_relaxed); }
+
+    // true when that was the last reference. acq_rel so that every write
+    // made through the other copies is visible to whoever deletes.
+    bool decrement() { return n.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+    // increment unless the count already reached 0, for turning a weak
+    // reference into a strong one. A compare and swap loop, so it never
+    // blocks.
+    bool incrementIfNonZero() {
+        long c = n.load(std::memory_order_relaxed);
+        while (c != 0)
+            if (n.compare_exchange_weak(c, c + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                return true;
+        return false;
+    }
+
+    // whether the caller holds the only reference. Acquire, so the caller
+    // may go on to delete without a decrement.
+    bool unique() const { return n.load(std::memory_order_acquire) == 1; }
+
+    long get() const { return n.load(std::memory_order_relaxed); }
+};
+
+struct SingleThreadCount {
+    long n;
+
+    explicit SingleThreadCount(long start) : n(start) {}
+    void increment() { ++n; }
+    void add(long k) { n += k; }
+    bool decrement() { return --n == 0; }
+    bool incrementIfNonZero() { return n != 0 && ++n; }
+    bool unique() const { return n == 1; }
+    long get() const { return n; }
+};
+
+//
+// control blocks
+//
+// The counts live in a control block shared by every copy. The block also
+// knows how to get rid of the object, so SharedPtr itself does not need to
+// know whether it came from new, from a custom deleter, or from makeShared.
+//
+// strong counts the SharedPtrs, and the object dies when it reaches 0.
+// weak counts the WeakPtrs, plus one for all the SharedPtrs together, and
+// the block itself dies when that reaches 0: a WeakPtr must still be able
+// to look at strong after the object is gone.
+//
+template <typename Count>
+struct ControlBlock {
+    Count strong;
+    Count weak;
+
+    ControlBlock() : strong(1), weak(1) {}
+    virtual ~ControlBlock() {}
+
+    // destroy the object, once the last strong reference is gone
+    virtual void dispose() = 0;
+
+    // Always a real decrement: strong and weak are two words, and no pair of
+    // loads can show that a WeakPtr is not locking in between them.
+    void releaseStrong() {
+        if (strong.decrement()) {
+            dispose();
+            releaseWeak();
+        }
+    }
+
+    void releaseWeak() {
+        if (weak.decrement())
+            delete this;
+    }
+};
+
+// an object allocated on its own, destroyed by calling deleter on it
+template <typename T, typename Deleter, typename Count>
+struct PointerBlock : ControlBlock<Count> {
+    T* ptr;
+    Deleter deleter;
+
+    PointerBlock(T* p, Deleter d) : ptr(p), deleter(std::move(d)) {}
+    void dispose() override { deleter(ptr); }
+};
+
+// an object living inside the block itself, as makeShared builds them: one
+// allocation instead of two, and the count next to the object in memory
+template <typename T, typename Count>
+struct InPlaceBlock : ControlBlock<Count> {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+    template <typename... Args>
+    explicit InPlaceBlock(Args&&... args) {
+        ::new (static_cast<void*>(&storage)) T(std::forward<Args>(args)...);
+    }
+    T* object() { return reinterpret_cast<T*>(&storage); }
+    void dispose() override { object()->~T(); }
+};
 
 template <typename T>
+struct DefaultDelete {
+    void operator()(T* p) const { delete p; }
+};
+
+template <typename T, typename Count>
+class WeakPtr;
+template <typename T>
+class AtomicSharedPtr;
+
+// define SHARED_PTR_TRACE before including this to see every destruction
+// ( of single threaded code: the trace reads the count before dropping it )
+template <typename T, typename Count = AtomicCount>
 class SharedPtr {
     T* ptr;
-    int* cnt;
+    ControlBlock<Count>* block;
+
+    template <typename U, typename C>
+    friend class SharedPtr;
+    template <typename U, typename C>
+    friend class WeakPtr;
+    template <typename U>
+    friend class AtomicSharedPtr;
+    template <typename U, typename C, typename... Args>
+    friend SharedPtr<U, C> makeShared(Args&&... args);
+
+    // adopt a reference to block which the caller already took
+    SharedPtr(T* p, ControlBlock<Count>* b) : ptr(p), block(b) {}
+
+    // drop our reference, destroying the object if it was the last one
+    void release() {
+        if (block == nullptr)
+            return;
+#ifdef SHARED_PTR_TRACE
+        std::cout << "SharedPtr destructor called. cnt is " << block->strong.get() - 1 << std::endl;
+        if (block->strong.get() == 1)
+            std::cout << "SharedPtr deleting ptr" << std::endl;
+#endif
+        block->releaseStrong();
+        ptr = nullptr;
+        block = nullptr;
+    }
+
 public:
-    SharedPtr() : ptr{nullptr}, cnt{nullptr} {}
+    SharedPtr() : ptr{nullptr}, block{nullptr} {}
 
-    // constructor
-    SharedPtr(T* i_ptr) : ptr(i_ptr) {
-        cnt = new int(1);
+    // constructor. Takes ownership of i_ptr, deleting it if the control
+    // block cannot be allocated.
+    SharedPtr(T* i_ptr) : SharedPtr(i_ptr, DefaultDelete<T>()) {}
+
+    // constructor with a custom deleter, called as deleter(i_ptr) when the
+    // last SharedPtr goes away
+    template <typename Deleter>
+    SharedPtr(T* i_ptr, Deleter deleter) : ptr(i_ptr), block(nullptr) {
+        try {
+            block = new PointerBlock<T, Deleter, Count>(i_ptr, deleter);
+        } catch (...) {
+            deleter(i_ptr);
+            throw;
+        }
     }
 
 
+    // aliasing constructor: shares ownership with owner, but points at p,
+    // typically a part of owner's object. The whole object stays alive as
+    // long as this does.
+    //
+    //     SharedPtr<Data> data(node, &node->data);
+    template <typename U>
+    SharedPtr(const SharedPtr<U, Count>& owner, T* p) : ptr(p), block(owner.block) {
+        if (block)
+            block->strong.increment();
+    }
+
     // copy sontructor
     SharedPtr(const SharedPtr& p) :
             ptr(p.ptr),
-            cnt(p.cnt)
+            block(p.block)
     {
-        (*cnt)++;
+        if (block)
+            block->strong.increment();
     }
-    // assignment operator
+
+    // move constructor. Steals the reference, so the count does not change.
+    SharedPtr(SharedPtr&& p) noexcept : ptr(p.ptr), block(p.block) {
+        p.ptr = nullptr;
+        p.block = nullptr;
+    }
+
+    // assignment operator. Take the new reference before dropping the old
+    // one, in case both are the last references to the same object.
     SharedPtr& operator=(const SharedPtr& p) {
         if (this == &p)
             return *this;
 
+        if (p.block)
+            p.block->strong.increment();
+        release();
         ptr = p.ptr;
-        cnt = p.cnt;
-        (*cnt)++;
+        block = p.block;
+        return *this;
+    }
+
+    // move assignment
+    SharedPtr& operator=(SharedPtr&& p) noexcept {
+        if (this == &p)
+            return *this;
+
+        release();
+        ptr = p.ptr;
+        block = p.block;
+        p.ptr = nullptr;
+        p.block = nullptr;
         return *this;
     }
 
     // destructor
     ~SharedPtr() {
-        (*cnt)--;
-        std::cout << "SharedPtr destructor called. cnt is " << *cnt << std::endl;
-        if (*cnt  <= 0) {
-            std::cout << "SharedPtr deleting ptr" << std::endl;
-            delete ptr;
-            ptr = nullptr;
-            *cnt = 0;
-        }
+        release();
     }
-    // dereference overload
-    T operator*() {
+
+    // let go of the object, leaving this empty
+    void reset() { release(); }
+
+    // number of SharedPtrs sharing the object, 0 for an empty one. Only a
+    // snapshot when other threads hold copies.
+    long useCount() const { return block ? block->strong.get() : 0; }
+
+    T* get() const { return ptr; }
+
+    // dereference overload. Returns a reference: returning T would copy
+    // the object on every use.
+    T& operator*() const {
         return *ptr;
     }
 
-};
\ No newline at end of file
+    T* operator->() const { return ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
+
+};
+
+// A non owning reference to an object owned by SharedPtrs. It does not
+// keep the object alive, so it can point back up a tree, or anywhere else
+// an owning pointer would make a cycle that never gets freed. lock() turns
+// it into a SharedPtr if the object is still there.
+template <typename T, typename Count = AtomicCount>
+class WeakPtr {
+    T* ptr;
+    ControlBlock<Count>* block;
+
+    void release() {
+        if (block)
+            block->releaseWeak();
+        ptr = nullptr;
+        block = nullptr;
+    }
+
+public:
+    WeakPtr() : ptr{nullptr}, block{nullptr} {}
+
+    WeakPtr(const SharedPtr<T, Count>& p) : ptr(p.ptr), block(p.block) {
+        if (block)
+            block->weak.increment();
+    }
+
+    WeakPtr(const WeakPtr& p) : ptr(p.ptr), block(p.block) {
+        if (block)
+            block->weak.increment();
+    }
+
+    WeakPtr(WeakPtr&& p) noexcept : ptr(p.ptr), block(p.block) {
+        p.ptr = nullptr;
+        p.block = nullptr;
+    }
+
+    WeakPtr& operator=(const WeakPtr& p) {
+        if (p.block)
+            p.block->weak.increment();
+        release();
+        ptr = p.ptr;
+        block = p.block;
+        return *this;
+    }
+
+    WeakPtr& operator=(WeakPtr&& p) noexcept {
+        if (this != &p) {
+            release();
+            ptr = p.ptr;
+            block = p.block;
+            p.ptr = nullptr;
+            p.block = nullptr;
+        }
+        return *this;
+    }
+
+    WeakPtr& operator=(const SharedPtr<T, Count>& p) { return *this = WeakPtr(p); }
+
+    ~WeakPtr() {
+        release();
+    }
+
+    void reset() { release(); }
+
+    // number of SharedPtrs to the object, 0 once it is gone
+    long useCount() const { return block ? block->strong.get() : 0; }
+    bool expired() const { return useCount() == 0; }
+
+    // a SharedPtr to the object, or an empty one if it is gone. Lock free:
+    // the strong count goes up only if it has not reached 0 yet.
+    SharedPtr<T, Count> lock() const {
+        if (block && block->strong.incrementIfNonZero())
+            return SharedPtr<T, Count>(ptr, block);
+        return SharedPtr<T, Count>();
+    }
+};
+
+// a SharedPtr to a new T built from args, with the object and its count
+// in a single allocation
+template <typename T, typename Count = AtomicCount, typename... Args>
+SharedPtr<T, Count> makeShared(Args&&... args) {
+    InPlaceBlock<T, Count>* block = new InPlaceBlock<T, Count>(std::forward<Args>(args)...);
+    // as the base class, or it would pick the deleter constructor
+    return SharedPtr<T, Count>(block->object(), static_cast<ControlBlock<Count>*>(block));
+}
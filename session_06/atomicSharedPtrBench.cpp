@@ -0,0 +1,138 @@
+//
+// Read-mostly shared state: AtomicSharedPtr against a std::shared_ptr
+// guarded by a std::mutex.
+//
+// Reader threads load the current table and read from it, over and over,
+// while one writer replaces it with a new table every so often. Reported
+// are the loads per microsecond of all readers together, and how many
+// stores the writer got in meanwhile: with the mutex, readers hold the
+// writer up as well as each other.
+//
+// usage: atomicSharedPtrBench [loads per reader] [microseconds between stores]
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AtomicSharedPtr.hpp"
+
+namespace {
+
+struct Table {
+    long version;
+    long values[15];
+};
+
+class LockFree {
+    AtomicSharedPtr<Table> current;
+
+public:
+    LockFree() : current(makeShared<Table>()) {}
+    long read() const { return current.load()->version; }
+    void replace(long version) {
+        SharedPtr<Table> next = makeShared<Table>();
+        next->version = version;
+        current.store(std::move(next));
+    }
+};
+
+class Locked {
+    mutable std::mutex mutex;
+    std::shared_ptr<Table> current;
+
+    std::shared_ptr<Table> load() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return current;
+    }
+
+public:
+    Locked() : current(std::make_shared<Table>()) {}
+    long read() const { return load()->version; }
+    void replace(long version) {
+        std::shared_ptr<Table> next = std::make_shared<Table>();
+        next->version = version;
+        std::lock_guard<std::mutex> lock(mutex);
+        current.swap(next);
+        // the old table is freed outside the lock, by next going away
+    }
+};
+
+struct Result {
+    double loadsPerUs;
+    long stores;
+};
+
+template <typename Shared>
+Result run(int readers, long loads, long pauseUs) {
+    Shared shared;
+    std::atomic<int> ready{0}, done{0};
+    std::atomic<bool> go{false};
+    std::atomic<long> sink{0}, backwards{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < readers; ++t) {
+        workers.emplace_back([&] {
+            ++ready;
+            while (!go)
+                std::this_thread::yield();
+            // one writer stores ever higher versions, so a reader never
+            // sees one go back
+            long sum = 0, last = 0;
+            for (long i = 0; i < loads; ++i) {
+                const long v = shared.read();
+                backwards += v < last;
+                last = v;
+                sum += v;
+            }
+            sink += sum;
+            ++done;
+        });
+    }
+    long stores = 0;
+    std::thread writer([&] {
+        while (!go)
+            std::this_thread::yield();
+        while (done != readers) {
+            shared.replace(++stores);
+            std::this_thread::sleep_for(std::chrono::microseconds(pauseUs));
+        }
+    });
+    while (ready != readers)
+        std::this_thread::yield();
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (std::thread& w : workers)
+        w.join();
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    writer.join();
+    if (backwards != 0)
+        std::cout << "versions went backwards!" << std::endl;
+    return Result{static_cast<double>(loads) * readers / elapsed.count(), stores};
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const long loads = argc > 1 ? std::atol(argv[1]) : 1000000;
+    const long pauseUs = argc > 2 ? std::atol(argv[2]) : 100;
+
+    std::cout << "loads per us of all readers, " << loads << " loads per reader, a store every "
+              << pauseUs << " us" << std::endl;
+    std::cout << std::setw(9) << "readers" << std::setw(14) << "atomic" << std::setw(10) << "stores"
+              << std::setw(14) << "mutex" << std::setw(10) << "stores" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (int readers : {1, 2, 4, 8, 16, 32, 64}) {
+        const Result atomic = run<LockFree>(readers, loads, pauseUs);
+        const Result locked = run<Locked>(readers, loads, pauseUs);
+        std::cout << std::setw(9) << readers << std::setw(14) << atomic.loadsPerUs << std::setw(10) << atomic.stores
+                  << std::setw(14) << locked.loadsPerUs << std::setw(10) << locked.stores << std::endl;
+    }
+    return 0;
+}
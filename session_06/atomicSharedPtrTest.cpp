@@ -0,0 +1,92 @@
+//
+// Readers load an AtomicSharedPtr while one writer stores new versions and
+// another replaces them with compare_exchange. Every value read must be a
+// version some writer made and still alive, and once it is all over no
+// version may be left. Worth running under -fsanitize=address or thread as well.
+// Exits non zero if anything is off.
+//
+// usage: atomicSharedPtrTest [writes per writer]
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../topics/testing/Check.hpp"
+#include "AtomicSharedPtr.hpp"
+
+namespace {
+
+std::atomic<long> live{0}, made{0};
+
+struct Version {
+    static const int alive = 0x5eed;
+    long id;
+    int state = alive;
+    Version() : id(made.fetch_add(1)) { live.fetch_add(1); }
+    ~Version() {
+        state = 0;
+        live.fetch_sub(1);
+    }
+};
+
+// a version made, and still alive
+bool good(const SharedPtr<Version>& v) {
+    return v && v->state == Version::alive && v->id >= 0 && v->id < made.load();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const int writes = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const int readers = 2;
+
+    std::atomic<long> bad{0}, loads{0}, swapped{0};
+    std::atomic<int> writing{2};
+    {
+        AtomicSharedPtr<Version> current(makeShared<Version>());
+
+        std::vector<std::thread> threads;
+        threads.emplace_back([&] {
+            for (int i = 0; i < writes; ++i) {
+                if (i % 2)
+                    current.store(makeShared<Version>());
+                else if (!good(current.exchange(makeShared<Version>())))
+                    bad.fetch_add(1);
+                if (i % 64 == 0)
+                    std::this_thread::yield();
+            }
+            writing.fetch_sub(1);
+        });
+        threads.emplace_back([&] {
+            SharedPtr<Version> expected = current.load();
+            for (int i = 0; i < writes; ++i) {
+                if (current.compare_exchange(expected, makeShared<Version>()))
+                    swapped.fetch_add(1);
+                else if (!good(expected))
+                    bad.fetch_add(1);
+                if (i % 64 == 0)
+                    std::this_thread::yield();
+            }
+            writing.fetch_sub(1);
+        });
+        for (int t = 0; t < readers; ++t)
+            threads.emplace_back([&] {
+                for (int n = 0; writing.load() > 0 || n < 1000; ++n) {
+                    if (!good(current.load()))
+                        bad.fetch_add(1);
+                    loads.fetch_add(1);
+                    std::this_thread::yield();
+                }
+            });
+        for (std::thread& t : threads)
+            t.join();
+        CHECK(good(current.load()));
+    }
+
+    CHECK(bad.load() == 0);
+    CHECK(swapped.load() > 0 && loads.load() > 0);
+    CHECK(live.load() == 0);
+    return checkResult();
+}
@@ -0,0 +1,119 @@
+//
+// Footprint and dereference cost of SharedPtr, built with new or with
+// makeShared, against IntrusivePtr.
+//
+// A million small nodes are each owned by one pointer in a vector, and
+// visited in random order:
+//
+//   deref       read a field through the pointer
+//   copy        copy the pointer, then read through the copy: the count
+//               has to be found as well as the object
+//
+// Memory per node is the pointer itself plus the heap bytes asked for,
+// counted by replacing the global operator new.
+//
+// usage: intrusivePtrBench [nodes]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CountingNew.hpp"
+#include "IntrusivePtr.hpp"
+#include "SharedPtr.hpp"
+
+namespace {
+
+struct Payload {
+    double x, y, z;
+};
+
+struct PlainNode {
+    Payload value;
+};
+
+struct AtomicNode : RefCounted<AtomicNode> {
+    Payload value;
+};
+
+struct SingleNode : RefCounted<SingleNode, SingleThreadCount> {
+    Payload value;
+};
+
+// how each kind of pointer gets made
+struct WithNew {
+    static SharedPtr<PlainNode> make() { return SharedPtr<PlainNode>(new PlainNode()); }
+};
+
+struct WithMakeShared {
+    static SharedPtr<PlainNode> make() { return makeShared<PlainNode>(); }
+};
+
+template <typename Node>
+struct WithIntrusive {
+    static IntrusivePtr<Node> make() { return makeIntrusive<Node>(); }
+};
+
+template <typename Maker>
+void row(const std::string& name, std::size_t n) {
+    using Ptr = decltype(Maker::make());
+
+    const long bytesBefore = allocatedBytes.load(), countBefore = allocations.load();
+    std::vector<Ptr> nodes;
+    nodes.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        nodes.push_back(Maker::make());
+        nodes.back()->value.x = static_cast<double>(i);
+    }
+    // the vector's own buffer is counted as sizeof(Ptr) below
+    const long bytes = allocatedBytes.load() - bytesBefore - static_cast<long>(n * sizeof(Ptr));
+    const long count = allocations.load() - countBefore - 1;
+
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::shuffle(order.begin(), order.end(), std::mt19937(1));
+
+    double sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i : order)
+        sum += nodes[i]->value.x;
+    const std::chrono::duration<double, std::nano> deref = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i : order) {
+        const Ptr copy = nodes[i];
+        sum += copy->value.x;
+    }
+    const std::chrono::duration<double, std::nano> copy = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::setw(16) << name << std::setw(10) << sizeof(Ptr)
+              << std::setw(12) << static_cast<double>(bytes) / n
+              << std::setw(13) << static_cast<double>(count) / n
+              << std::setw(11) << deref.count() / n << std::setw(11) << copy.count() / n;
+    // keep the sums live
+    std::cout << (sum < 0 ? " !" : "") << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << n << " nodes of " << sizeof(Payload) << " bytes, in random order" << std::endl;
+    std::cout << std::setw(16) << "pointer" << std::setw(10) << "sizeof" << std::setw(12) << "heap bytes"
+              << std::setw(13) << "allocations" << std::setw(11) << "deref ns" << std::setw(11) << "copy ns"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    row<WithNew>("SharedPtr new", n);
+    row<WithMakeShared>("makeShared", n);
+    row<WithIntrusive<AtomicNode>>("Intrusive", n);
+    row<WithIntrusive<SingleNode>>("Intrusive single", n);
+    return 0;
+}
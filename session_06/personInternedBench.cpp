@@ -0,0 +1,124 @@
+//
+// Memory and copy cost of people with heavily repeated names, held four
+// ways:
+//
+//   strings     two std::string members
+//   heap        two owned std::string*, deep copied, as PersonBetter does
+//   shared      two std::shared_ptr<std::string>, as PersonSharedPtr does
+//   interned    two NamePool handles, as PersonInterned does
+//
+// Each row builds a vector of people, then copies it. Heap bytes and
+// allocations are counted by replacing the global operator new, and for
+// interned include the pool itself.
+//
+// usage: personInternedBench [people] [distinct first names] [distinct last names]
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CountingNew.hpp"
+#include "PersonInterned.hpp"
+#include "PersonSharedPtr.hpp"
+
+namespace {
+
+struct StringPerson {
+    std::string firstname, lastname;
+    StringPerson(const std::string& fn, const std::string& ln) : firstname(fn), lastname(ln) {}
+};
+
+struct HeapPerson {
+    std::string* firstname;
+    std::string* lastname;
+    HeapPerson(const std::string& fn, const std::string& ln) :
+            firstname(new std::string(fn)), lastname(new std::string(ln)) {}
+    HeapPerson(const HeapPerson& other) :
+            firstname(new std::string(*other.firstname)), lastname(new std::string(*other.lastname)) {}
+    HeapPerson& operator=(const HeapPerson&) = delete;
+    ~HeapPerson() {
+        delete firstname;
+        delete lastname;
+    }
+};
+
+// names of 4 to 19 letters
+std::vector<std::string> names(std::size_t n, std::mt19937& random) {
+    std::uniform_int_distribution<int> length(4, 19), letter('a', 'z');
+    std::vector<std::string> result(n);
+    for (std::string& s : result) {
+        s.resize(length(random));
+        for (char& c : s)
+            c = static_cast<char>(letter(random));
+    }
+    return result;
+}
+
+template <typename Person>
+void row(const std::string& name, const std::vector<std::string>& first, const std::vector<std::string>& last,
+         const std::vector<std::uint32_t>& picks) {
+    const std::size_t n = picks.size() / 2;
+    const long bytesBefore = allocatedBytes.load(), countBefore = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Person> people;
+    people.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        people.emplace_back(first[picks[2 * i]], last[picks[2 * i + 1]]);
+    const std::chrono::duration<double, std::nano> build = std::chrono::steady_clock::now() - start;
+    // the vector's own buffer is counted as sizeof(Person) below
+    const long bytes = allocatedBytes.load() - bytesBefore - static_cast<long>(n * sizeof(Person));
+    const long count = allocations.load() - countBefore - 1;
+
+    start = std::chrono::steady_clock::now();
+    const std::vector<Person> copy = people;
+    const std::chrono::duration<double, std::nano> copied = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::setw(10) << name << std::setw(9) << sizeof(Person)
+              << std::setw(12) << static_cast<double>(bytes) / n << std::setw(13) << static_cast<double>(count) / n
+              << std::setw(11) << build.count() / n << std::setw(11) << copied.count() / n
+              << (copy.size() != n ? " !" : "") << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    const std::size_t firstCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    const std::size_t lastCount = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 50000;
+
+    std::mt19937 random(1);
+    const std::vector<std::string> first = names(firstCount, random), last = names(lastCount, random);
+    std::vector<std::uint32_t> picks(2 * n);
+    std::uniform_int_distribution<std::uint32_t> pickFirst(0, firstCount - 1), pickLast(0, lastCount - 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        picks[2 * i] = pickFirst(random);
+        picks[2 * i + 1] = pickLast(random);
+    }
+
+    std::cout << n << " people, " << firstCount << " first and " << lastCount << " last names" << std::endl;
+    std::cout << std::setw(10) << "names" << std::setw(9) << "sizeof" << std::setw(12) << "heap bytes"
+              << std::setw(13) << "allocations" << std::setw(11) << "build ns" << std::setw(11) << "copy ns"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    row<StringPerson>("strings", first, last, picks);
+    row<HeapPerson>("heap", first, last, picks);
+    row<Person>("shared", first, last, picks);
+    row<PersonInterned>("interned", first, last, picks);
+
+    // interning a name already in the pool is a lock free lookup
+    NamePool& pool = PersonInterned::names();
+    const auto start = std::chrono::steady_clock::now();
+    NamePool::Handle sum = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        sum += pool.intern(last[picks[2 * i + 1]]);
+    const std::chrono::duration<double, std::nano> lookup = std::chrono::steady_clock::now() - start;
+    std::cout << std::endl << pool.size() << " names in " << pool.bytes() << " pool bytes, "
+              << lookup.count() / n << " ns to intern one again" << (sum == 0 ? " !" : "") << std::endl;
+    return 0;
+}
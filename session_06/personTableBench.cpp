@@ -0,0 +1,150 @@
+//
+// PersonTable against a std::vector of people holding their names through
+// std::shared_ptr<std::string>, as PersonSharedPtr does.
+//
+//   build       append everyone, from vectors of first and last names
+//   scan        total length of the names, and how many last names start
+//               with 'q', reading every name once
+//   filter      the people whose first name is under 8 letters
+//   sort        by last name, then first name: the table's radix sort
+//               on 1 and on all threads, std::sort for the vector
+//
+// Times are per person. Heap bytes are counted by replacing the global
+// operator new.
+//
+// usage: personTableBench [people] [distinct first names] [distinct last names]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CountingNew.hpp"
+#include "PersonTable.hpp"
+
+namespace {
+
+struct SharedPerson {
+    std::shared_ptr<std::string> firstname, lastname;
+};
+
+// names of 4 to 19 letters
+std::vector<std::string> names(std::size_t n, std::mt19937& random) {
+    std::uniform_int_distribution<int> length(4, 19), letter('a', 'z');
+    std::vector<std::string> result(n);
+    for (std::string& s : result) {
+        s.resize(length(random));
+        for (char& c : s)
+            c = static_cast<char>(letter(random));
+    }
+    return result;
+}
+
+using Clock = std::chrono::steady_clock;
+
+double nsPer(Clock::time_point start, std::size_t n) {
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / n;
+}
+
+void line(const std::string& what, double table, double vector) {
+    std::cout << std::setw(16) << what << std::setw(14) << table << std::setw(14) << vector << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    const std::size_t firstCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    const std::size_t lastCount = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 50000;
+
+    std::mt19937 random(1);
+    const std::vector<std::string> firstPool = names(firstCount, random), lastPool = names(lastCount, random);
+    std::vector<std::string> first(n), last(n);
+    std::uniform_int_distribution<std::size_t> pickFirst(0, firstCount - 1), pickLast(0, lastCount - 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        first[i] = firstPool[pickFirst(random)];
+        last[i] = lastPool[pickLast(random)];
+    }
+
+    std::cout << n << " people, " << firstCount << " first and " << lastCount << " last names, "
+              << PersonTable::defaultThreads() << " threads" << std::endl;
+    std::cout << std::setw(16) << "" << std::setw(14) << "PersonTable" << std::setw(14) << "shared_ptr" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    long before = allocatedBytes.load();
+    Clock::time_point start = Clock::now();
+    PersonTable table;
+    table.append(first, last);
+    const double tableBuild = nsPer(start, n);
+    const long tableBytes = allocatedBytes.load() - before;
+
+    before = allocatedBytes.load();
+    start = Clock::now();
+    std::vector<SharedPerson> people;
+    people.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        people.push_back(SharedPerson{std::make_shared<std::string>(first[i]), std::make_shared<std::string>(last[i])});
+    const double vectorBuild = nsPer(start, n);
+    const long vectorBytes = allocatedBytes.load() - before;
+    line("build ns", tableBuild, vectorBuild);
+    line("heap bytes", static_cast<double>(tableBytes) / n, static_cast<double>(vectorBytes) / n);
+
+    start = Clock::now();
+    std::size_t tableLength = 0, tableQ = 0;
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        const PersonTable::Name f = table.first(i), l = table.last(i);
+        tableLength += f.size + l.size;
+        tableQ += l.size > 0 && l.data[0] == 'q';
+    }
+    const double tableScan = nsPer(start, n);
+    start = Clock::now();
+    std::size_t vectorLength = 0, vectorQ = 0;
+    for (const SharedPerson& p : people) {
+        vectorLength += p.firstname->size() + p.lastname->size();
+        vectorQ += !p.lastname->empty() && (*p.lastname)[0] == 'q';
+    }
+    line("scan ns", tableScan, nsPer(start, n));
+    if (tableLength != vectorLength || tableQ != vectorQ)
+        std::cout << "scans differ!" << std::endl;
+
+    start = Clock::now();
+    const PersonTable shortNames = table.filter([](PersonTable::Name f, PersonTable::Name) { return f.size < 8; });
+    const double tableFilter = nsPer(start, n);
+    start = Clock::now();
+    std::vector<SharedPerson> shortPeople;
+    std::copy_if(people.begin(), people.end(), std::back_inserter(shortPeople),
+                 [](const SharedPerson& p) { return p.firstname->size() < 8; });
+    line("filter ns", tableFilter, nsPer(start, n));
+    if (shortNames.size() != shortPeople.size())
+        std::cout << "filters differ!" << std::endl;
+
+    PersonTable sorted = table;
+    start = Clock::now();
+    sorted.sortByName(1);
+    const double tableSort1 = nsPer(start, n);
+    sorted = table;
+    start = Clock::now();
+    sorted.sortByName();
+    const double tableSort = nsPer(start, n);
+    start = Clock::now();
+    std::sort(people.begin(), people.end(), [](const SharedPerson& a, const SharedPerson& b) {
+        const int c = a.lastname->compare(*b.lastname);
+        return c < 0 || (c == 0 && *a.firstname < *b.firstname);
+    });
+    const double vectorSort = nsPer(start, n);
+    line("sort ns, 1", tableSort1, vectorSort);
+    line("sort ns, all", tableSort, vectorSort);
+    for (std::size_t i = 0; i < n; ++i)
+        if (!(sorted.last(i) == *people[i].lastname) || !(sorted.first(i) == *people[i].firstname)) {
+            std::cout << "sorts differ!" << std::endl;
+            break;
+        }
+    return 0;
+}
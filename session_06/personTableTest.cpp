@@ -0,0 +1,84 @@
+//
+// PersonTable::sortByName against std::sort with the order the header
+// promises: by last name, then first name, each compared as bytes up to
+// its end or its first 0 byte, and stable. Names with a 0 byte go both in
+// a bucket big enough for more radix passes and in one small enough for
+// the comparison sort. Exits non zero if anything is off.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../topics/testing/Check.hpp"
+#include "PersonTable.hpp"
+
+namespace {
+
+std::string untilNul(const std::string& s) {
+    return s.substr(0, std::min(s.size(), s.find('\0')));
+}
+
+struct Person {
+    std::string first, last;
+    std::size_t row;
+};
+
+bool before(const Person& a, const Person& b) {
+    const std::string al = untilNul(a.last), bl = untilNul(b.last);
+    if (al != bl)
+        return al < bl;
+    const std::string af = untilNul(a.first), bf = untilNul(b.first);
+    if (af != bf)
+        return af < bf;
+    return a.row < b.row;
+}
+
+void check(std::vector<Person> people, unsigned threads) {
+    PersonTable table;
+    for (const Person& p : people)
+        table.append(p.first, p.last);
+    table.sortByName(threads);
+    std::stable_sort(people.begin(), people.end(), before);
+
+    bool same = table.size() == people.size();
+    for (std::size_t i = 0; same && i < people.size(); ++i)
+        same = table.last(i) == people[i].last && table.first(i) == people[i].first;
+    CHECK(same);
+}
+
+std::string name(std::mt19937& random, char start, std::size_t length) {
+    std::uniform_int_distribution<int> letter('a', 'c'), nul(0, 5);
+    std::string s(1, start);
+    while (s.size() < length)
+        s += nul(random) == 0 ? '\0' : static_cast<char>(letter(random));
+    return s;
+}
+
+}
+
+int main() {
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> length(1, 24);
+
+    // 'b' last names fill a big bucket, 'z' a small one; each has a 0 byte
+    // in about one place in six, and few enough letters to collide often
+    std::vector<Person> people;
+    for (std::size_t i = 0; i < 3000; ++i)
+        people.push_back(Person{name(random, 'a', length(random)), name(random, 'b', length(random)), i});
+    for (std::size_t i = 0; i < 10; ++i)
+        people.push_back(Person{name(random, 'a', length(random)), name(random, 'z', length(random)), 3000 + i});
+    // names equal up to the 0 byte, differing after it
+    people.push_back(Person{"ann", std::string("zed\0b", 5), 3010});
+    people.push_back(Person{"ann", std::string("zed\0a", 5), 3011});
+    people.push_back(Person{"ann", "zed", 3012});
+    check(people, 1);
+
+    // and past the size at which the first pass is split between threads
+    for (std::size_t i = people.size(); i < 100000; ++i)
+        people.push_back(Person{name(random, 'a', length(random)), name(random, 'b' + i % 3, length(random)), i});
+    check(people, 4);
+    return checkResult();
+}
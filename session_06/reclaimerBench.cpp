@@ -0,0 +1,122 @@
+//
+// Release latency of big SharedPtr graphs, deleted inline or handed to a
+// Reclaimer.
+//
+// Each thread builds trees of SharedPtr nodes, and times nothing but
+// dropping the last pointer to the root. Inline, that one release frees the
+// whole tree; deferred, it queues the root and returns. The percentiles are
+// over every release of every thread.
+//
+// The deferred rows end with what the releasing threads waited for a full
+// queue, and what the reclaimer thread did.
+//
+// usage: reclaimerBench [trees per thread] [nodes per tree]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Reclaimer.hpp"
+#include "SharedPtr.hpp"
+
+namespace {
+
+struct Node {
+    SharedPtr<Node> left, right;
+    double value[4];
+};
+
+// a balanced tree of n nodes
+SharedPtr<Node> tree(long n) {
+    if (n == 0)
+        return SharedPtr<Node>();
+    SharedPtr<Node> node = makeShared<Node>();
+    node->left = tree((n - 1) / 2);
+    node->right = tree(n - 1 - (n - 1) / 2);
+    return node;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[static_cast<std::size_t>(p * (sorted.size() - 1))];
+}
+
+// release latencies in nanoseconds, deferred to reclaimer unless it is null
+std::vector<double> run(Reclaimer* reclaimer, int threads, long trees, long nodes,
+                        std::vector<Reclaimer::ThreadStats>& perThread) {
+    std::vector<double> all;
+    std::mutex allMutex;
+    perThread.assign(threads, Reclaimer::ThreadStats());
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<double> mine;
+            mine.reserve(trees);
+            for (long i = 0; i < trees; ++i) {
+                SharedPtr<Node> built = tree(nodes);
+                // the root again, owned by a pointer with the deleter under test
+                Node* root = new Node(*built);
+                built.reset();
+                SharedPtr<Node> owner = reclaimer ? SharedPtr<Node>(root, DeferredDelete<Node>(*reclaimer))
+                                                  : SharedPtr<Node>(root);
+                const auto start = std::chrono::steady_clock::now();
+                owner.reset();
+                const std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;
+                mine.push_back(took.count());
+            }
+            // a new thread, so its counts are only this run's
+            perThread[t] = Reclaimer::threadStats();
+            std::lock_guard<std::mutex> lock(allMutex);
+            all.insert(all.end(), mine.begin(), mine.end());
+        });
+    }
+    for (std::thread& w : workers)
+        w.join();
+    if (reclaimer)
+        reclaimer->flush();
+    std::sort(all.begin(), all.end());
+    return all;
+}
+
+void row(const std::string& name, Reclaimer* reclaimer, int threads, long trees, long nodes) {
+    std::vector<Reclaimer::ThreadStats> perThread;
+    const std::vector<double> ns = run(reclaimer, threads, trees, nodes, perThread);
+    std::cout << std::setw(10) << name << std::setw(9) << threads
+              << std::setw(12) << percentile(ns, 0.5) / 1000 << std::setw(12) << percentile(ns, 0.99) / 1000
+              << std::setw(12) << ns.back() / 1000 << std::endl;
+    if (!reclaimer)
+        return;
+    for (int t = 0; t < threads; ++t)
+        std::cout << std::setw(19) << "thread " << t << ": " << perThread[t].retired << " retired, "
+                  << perThread[t].stalls << " stalls, " << perThread[t].stallNs / 1000 << " us stalled, worst "
+                  << perThread[t].maxStallNs / 1000 << " us" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const long trees = argc > 1 ? std::atol(argv[1]) : 200;
+    const long nodes = argc > 2 ? std::atol(argv[2]) : 20000;
+
+    std::cout << "us to release a tree of " << nodes << " nodes, " << trees << " trees per thread" << std::endl;
+    std::cout << std::setw(10) << "delete" << std::setw(9) << "threads"
+              << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (int threads : {1, 2, 4}) {
+        row("inline", nullptr, threads, trees, nodes);
+        // small enough that several threads can fill it
+        Reclaimer reclaimer(16);
+        row("deferred", &reclaimer, threads, trees, nodes);
+        const Reclaimer::Stats stats = reclaimer.stats();
+        std::cout << std::setw(19) << "reclaimer: " << stats.objects << " objects in " << stats.batches
+                  << " batches, largest " << stats.largestBatch << ", " << stats.drainNs / 1e6 << " ms"
+                  << std::endl;
+    }
+    return 0;
+}
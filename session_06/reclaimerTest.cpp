@@ -0,0 +1,97 @@
+//
+// Reclaimer with room for one: a retire() waits while the queue is full,
+// flush() waits for everything retired, and an object retired from the
+// reclaimer thread itself is destroyed there and then. Exits non zero if
+// anything is off.
+//
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "../topics/testing/Check.hpp"
+#include "Reclaimer.hpp"
+
+namespace {
+
+std::atomic<int> destroyed{0};
+
+struct Counted {
+    ~Counted() { destroyed.fetch_add(1); }
+};
+
+// its destructor holds up the reclaimer thread until the gate opens
+std::atomic<bool> entered{false}, gate{false};
+
+struct Blocking {
+    ~Blocking() {
+        entered.store(true);
+        while (!gate.load())
+            std::this_thread::yield();
+        destroyed.fetch_add(1);
+    }
+};
+
+// retires another object as it is destroyed, on the reclaimer thread
+struct Parent {
+    Reclaimer* reclaimer;
+    ~Parent() {
+        reclaimer->retire(new Counted());
+        destroyed.fetch_add(1);
+    }
+};
+
+}
+
+int main() {
+    bool threw = false;
+    try {
+        Reclaimer none(0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    Reclaimer reclaimer(1);
+
+    // the reclaimer thread takes the first object and is stuck in its
+    // destructor; the second fills the queue; the third has to wait
+    reclaimer.retire(new Blocking());
+    while (!entered.load())
+        std::this_thread::yield();
+    reclaimer.retire(new Counted());
+    CHECK(Reclaimer::threadStats().stalls == 0);
+
+    std::atomic<bool> started{false}, returned{false};
+    long stalls = 0;
+    std::thread waiter([&] {
+        started.store(true);
+        reclaimer.retire(new Counted());
+        returned.store(true);
+        stalls = Reclaimer::threadStats().stalls;
+    });
+    while (!started.load())
+        std::this_thread::yield();
+    // nothing can make room until the gate opens; give the waiter time to
+    // get to the full queue first
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(!returned.load());
+    gate.store(true);
+    waiter.join();
+    CHECK(stalls == 1);
+
+    reclaimer.flush();
+    CHECK(destroyed.load() == 3);
+
+    // with room for one, a retire() on the reclaimer thread which waited
+    // would never return
+    reclaimer.retire(new Parent{&reclaimer});
+    reclaimer.flush();
+    CHECK(destroyed.load() == 5);
+    CHECK(Reclaimer::threadStats().retired == 3);
+
+    const Reclaimer::Stats stats = reclaimer.stats();
+    CHECK(stats.objects == 4 && stats.largestBatch == 1);
+    return checkResult();
+}
@@ -0,0 +1,165 @@
+//
+// Stress benchmark for SharedPtr's reference count policies, against
+// std::shared_ptr.
+//
+// Every thread assigns into a ring of its own slots over and over, from
+// two sources in turn. Each assignment takes a reference to one source and
+// drops the one the slot held to the other, so it is one increment and one
+// decrement. ( With a single source std::shared_ptr would notice the slot
+// already shares it and skip both. )
+//
+//   copy        each thread copies its own pointers: the counts stay in
+//               that thread's cache
+//   contended   every thread copies the same two pointers, so they all
+//               fight over two counts
+//   create      each assignment is from a new pointer: allocate, count,
+//               and destroy
+//   make        the same, built by makeShared / std::make_shared with the
+//               count and the object in one allocation
+//   lock        each assignment is from WeakPtr::lock / weak_ptr::lock on
+//               the thread's own pointers: a compare and swap instead of a
+//               plain increment
+//
+// It ends with the heap allocations each way of creating a pointer takes,
+// counted by replacing the global operator new.
+//
+// usage: sharedPtrBench [iterations per thread]
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CountingNew.hpp"
+#include "SharedPtr.hpp"
+
+namespace {
+
+const int slots = 64;
+
+enum class Mode { Copy, Contended, Create, Make, Lock };
+
+// a new pointer to value, in a single allocation where the type can
+template <typename Ptr>
+struct Make;
+
+template <typename Count>
+struct Make<SharedPtr<int, Count>> {
+    static SharedPtr<int, Count> make(int value) { return makeShared<int, Count>(value); }
+};
+
+template <>
+struct Make<std::shared_ptr<int>> {
+    static std::shared_ptr<int> make(int value) { return std::make_shared<int>(value); }
+};
+
+// the weak pointer that goes with Ptr
+template <typename Ptr>
+struct WeakOf;
+
+template <typename Count>
+struct WeakOf<SharedPtr<int, Count>> {
+    using type = WeakPtr<int, Count>;
+};
+
+template <>
+struct WeakOf<std::shared_ptr<int>> {
+    using type = std::weak_ptr<int>;
+};
+
+// nanoseconds per assignment, averaged over all the threads' assignments
+template <typename Ptr>
+double run(Mode mode, int threads, long iterations) {
+    const Ptr common[2] = {Ptr(new int(1)), Ptr(new int(2))};
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const Ptr own[2] = {Ptr(new int(t)), Ptr(new int(t))};
+            const Ptr* source = mode == Mode::Contended ? common : own;
+            const typename WeakOf<Ptr>::type weak[2] = {own[0], own[1]};
+            std::vector<Ptr> ring(slots);
+            ++ready;
+            while (!go)
+                std::this_thread::yield();
+            for (long i = 0; i < iterations; ++i) {
+                if (mode == Mode::Create)
+                    ring[i % slots] = Ptr(new int(static_cast<int>(i)));
+                else if (mode == Mode::Make)
+                    ring[i % slots] = Make<Ptr>::make(static_cast<int>(i));
+                else if (mode == Mode::Lock)
+                    ring[i % slots] = weak[i / slots % 2].lock();
+                else
+                    ring[i % slots] = source[i / slots % 2];
+            }
+        });
+    }
+    while (ready != threads)
+        std::this_thread::yield();
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (std::thread& w : workers)
+        w.join();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(iterations) * threads);
+}
+
+void row(const std::string& name, Mode mode, int threads, long iterations) {
+    std::cout << std::setw(10) << name << std::setw(9) << threads
+              << std::setw(14) << run<SharedPtr<int, AtomicCount>>(mode, threads, iterations)
+              << std::setw(14) << run<std::shared_ptr<int>>(mode, threads, iterations);
+    // the single thread policy is only safe with one thread
+    if (threads == 1)
+        std::cout << std::setw(14) << run<SharedPtr<int, SingleThreadCount>>(mode, threads, iterations);
+    std::cout << std::endl;
+}
+
+// heap allocations for one new pointer
+template <typename Ptr>
+double allocationsPerPointer(Mode mode) {
+    const int count = 1000;
+    std::vector<Ptr> made;
+    made.reserve(count);
+    const long before = allocations.load();
+    for (int i = 0; i < count; ++i)
+        made.push_back(mode == Mode::Make ? Make<Ptr>::make(i) : Ptr(new int(i)));
+    return static_cast<double>(allocations.load() - before) / count;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 2000000;
+
+    std::cout << "ns per assignment, " << iterations << " per thread" << std::endl;
+    std::cout << std::setw(10) << "mode" << std::setw(9) << "threads"
+              << std::setw(14) << "atomic" << std::setw(14) << "std::shared" << std::setw(14) << "single"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    const std::pair<const char*, Mode> modes[] = {
+        {"copy", Mode::Copy}, {"contended", Mode::Contended}, {"create", Mode::Create}, {"make", Mode::Make},
+        {"lock", Mode::Lock}};
+    for (const auto& m : modes)
+        for (int threads : {1, 2, 4, 8})
+            row(m.first, m.second, threads, iterations);
+
+    std::cout << std::endl << "allocations per pointer" << std::endl;
+    for (const auto& m : modes) {
+        if (m.second != Mode::Create && m.second != Mode::Make)
+            continue;
+        std::cout << std::setw(10) << m.first << std::setw(9) << ""
+                  << std::setw(14) << allocationsPerPointer<SharedPtr<int, AtomicCount>>(m.second)
+                  << std::setw(14) << allocationsPerPointer<std::shared_ptr<int>>(m.second)
+                  << std::setw(14) << allocationsPerPointer<SharedPtr<int, SingleThreadCount>>(m.second)
+                  << std::endl;
+    }
+    return 0;
+}
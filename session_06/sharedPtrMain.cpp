@@ -3,6 +3,8 @@
 //
 
 #include <iostream>
+// print each destruction, to watch the count go down
+#define SHARED_PTR_TRACE
 #include "SharedPtr.hpp"
 #include <string>
 
@@ -0,0 +1,80 @@
+//
+// Races WeakPtr::lock() against the release of the last SharedPtr, round
+// after round. Every lock must either fail or hand back a live object, and
+// when it is all over no object may be left. Worth running under
+// -fsanitize=address or thread as well. Exits non zero if anything is off.
+//
+// usage: weakPtrTest [rounds]
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../topics/testing/Check.hpp"
+#include "SharedPtr.hpp"
+
+namespace {
+
+std::atomic<long> live{0};
+
+struct Tracked {
+    static const int alive = 0x5eed;
+    int state = alive;
+    Tracked() { live.fetch_add(1); }
+    ~Tracked() {
+        state = 0;
+        live.fetch_sub(1);
+    }
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const int lockers = 2;
+
+    std::atomic<long> locked{0}, dead{0};
+    for (int round = 0; round < rounds; ++round) {
+        SharedPtr<Tracked> owner = makeShared<Tracked>();
+        const WeakPtr<Tracked> weak(owner);
+        std::atomic<int> running{0};
+        std::atomic<bool> released{false};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < lockers; ++t)
+            threads.emplace_back([&] {
+                // lock, and make and drop WeakPtrs of our own, until the
+                // object is gone, or for a while after the owner lets go:
+                // the last release is then one of ours, racing the others'
+                // locks
+                int after = 0;
+                for (bool first = true; !released.load() || ++after < 20; first = false) {
+                    SharedPtr<Tracked> p = weak.lock();
+                    if (!p)
+                        break;
+                    WeakPtr<Tracked> again(p);
+                    SharedPtr<Tracked> copy = again.lock();
+                    if (p->state != Tracked::alive || !copy || copy->state != Tracked::alive)
+                        dead.fetch_add(1);
+                    locked.fetch_add(1);
+                    if (first)
+                        running.fetch_add(1);
+                    std::this_thread::yield();
+                }
+            });
+        while (running.load() < lockers)
+            std::this_thread::yield();
+        owner.reset();
+        released.store(true);
+        for (std::thread& t : threads)
+            t.join();
+        CHECK(weak.expired() && !weak.lock());
+    }
+
+    CHECK(dead.load() == 0);
+    CHECK(live.load() == 0);
+    CHECK(locked.load() >= 2 * rounds);
+    return checkResult();
+}
@@ -5,6 +5,7 @@
 #include "Secret.hpp"
 #include <string>
 #include <iostream>
+#include <utility>
 
 using namespace std;
 
@@ -16,6 +17,37 @@ Secret::Secret(const string& s) :
 
 };
 
+Secret::Secret(const Secret& rhs) :
+    _secret{rhs._secret ? new string(*rhs._secret) : nullptr}
+{
+}
+
+// copy and swap: if the copy throws, this is left as it was
+Secret& Secret::operator=(const Secret& rhs) {
+    Secret copy(rhs);
+    swap(copy);
+    return *this;
+}
+
+Secret::Secret(Secret&& rhs) noexcept :
+    _secret{rhs._secret}
+{
+    rhs._secret = nullptr;
+}
+
+Secret& Secret::operator=(Secret&& rhs) noexcept {
+    if (this != &rhs) {
+        delete _secret;
+        _secret = rhs._secret;
+        rhs._secret = nullptr;
+    }
+    return *this;
+}
+
+void Secret::swap(Secret& rhs) noexcept {
+    std::swap(_secret, rhs._secret);
+}
+
 void Secret::tell() const {
 
     cout << "calling " << __PRETTY_FUNCTION__ << endl;
@@ -7,37 +7,60 @@
 
 #include <string>
 #include <iostream>
+#include <type_traits>
+#include <utility>
 
 class Secret {
     std::string* _secret;
 public:
     Secret();
     Secret(const std::string& s);
+    // Secret owns _secret, so copies need a string of their own, or both
+    // would delete the same one
+    Secret(const Secret& rhs);
+    Secret& operator=(const Secret& rhs);
+    Secret(Secret&& rhs) noexcept;
+    Secret& operator=(Secret&& rhs) noexcept;
+    void swap(Secret& rhs) noexcept;
     void tell() const;
     ~Secret();
 };
 
+inline void swap(Secret& a, Secret& b) noexcept { a.swap(b); }
+
+// T held by value. The copies and moves are the compiler's: declaring our
+// own copies would hide the moves, and copy T where it could be moved.
 template <typename T>
 class SecretT {
     T _secret;
 public:
     SecretT(const T& rhs)
-    : _secret{rhs}
+    : _secret(rhs)
+    {};
+
+    SecretT(T&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+    : _secret(std::move(rhs))
+    {};
+
+    // build T in place from args
+    template <typename First, typename... Rest,
+              typename = typename std::enable_if<
+                      !std::is_same<typename std::decay<First>::type, SecretT>::value &&
+                      std::is_constructible<T, First&&, Rest&&...>::value>::type>
+    explicit SecretT(First&& first, Rest&&... rest)
+            noexcept(std::is_nothrow_constructible<T, First&&, Rest&&...>::value)
+    : _secret(std::forward<First>(first), std::forward<Rest>(rest)...)
     {};
 
     void tell() const {
        std::cout << "secret " << _secret << std::endl;
     };
-    SecretT(const SecretT& rhs) {
-        _secret = rhs._secret;
-    };
-    SecretT& operator=(const SecretT& rhs) {
-        if (this == &rhs)
-            return *this;
 
-        _secret = rhs._secret;
-        return *this;
-    };
+    const T& secret() const { return _secret; }
 
+    SecretT(const SecretT&) = default;
+    SecretT(SecretT&&) = default;
+    SecretT& operator=(const SecretT&) = default;
+    SecretT& operator=(SecretT&&) = default;
 };
 #endif //CPP_HAPPY_FUN_TIME_SECRET_HPP
@@ -0,0 +1,22 @@
+//
+// Counts the copies and moves SecretT<T> makes of its T, for a T that is
+// big, and for one that cannot be copied at all. Exits non zero if any
+// count is off.
+//
+
+#include "../testing/SecretChecks.hpp"
+#include "Secret.hpp"
+
+namespace {
+
+struct Reveal {
+    template <typename T>
+    static const T& reveal(const SecretT<T>& s) { return s.secret(); }
+};
+
+}
+
+int main() {
+    checkSecret<SecretT, Reveal>();
+    return checkResult();
+}
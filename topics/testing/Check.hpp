@@ -0,0 +1,35 @@
+//
+// Check.hpp
+//
+// The little harness the plain test executables share, for the parts of
+// the tree built without gtest. CHECK reports a failed condition with its
+// file and line and carries on; main returns checkResult(), which prints
+// the verdict and is non zero if anything failed.
+//
+//     CHECK(registry.size() == 3);
+//     return checkResult();
+//
+// Meant for a test which is one file; each file gets its own count.
+//
+#pragma once
+
+#include <iostream>
+
+namespace {
+
+int failures = 0;
+
+int checkResult() {
+    std::cout << (failures ? "FAILED" : "ok") << std::endl;
+    return failures ? 1 : 0;
+}
+
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #condition << std::endl; \
+            ++failures; \
+        } \
+    } while (0)
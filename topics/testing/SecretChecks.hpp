@@ -0,0 +1,120 @@
+//
+// SecretChecks.hpp
+//
+// Counts the copies and moves a Secret-like class template makes of its T,
+// for a T that is big, and for one that cannot be copied at all. session_05's
+// Secret<T> and topics/mem's SecretT<T> differ only in how the value is
+// read back, so each test names its class and a Reveal with
+//
+//     template <typename T> static const T& reveal(const S<T>& s);
+//
+// and calls checkSecret<S, Reveal>().
+//
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Check.hpp"
+
+namespace {
+
+struct Counts {
+    static int copies, moves;
+    static void reset() { copies = moves = 0; }
+};
+int Counts::copies = 0;
+int Counts::moves = 0;
+
+// 4KB, which is what makes the extra copy hurt
+struct Large {
+    char bytes[4096];
+    Large(std::size_t n, char c) noexcept { std::memset(bytes, c, n < sizeof bytes ? n : sizeof bytes); }
+    Large(const Large& other) { std::memcpy(bytes, other.bytes, sizeof bytes); ++Counts::copies; }
+    Large(Large&& other) noexcept { std::memcpy(bytes, other.bytes, sizeof bytes); ++Counts::moves; }
+    Large& operator=(const Large& other) { std::memcpy(bytes, other.bytes, sizeof bytes); ++Counts::copies; return *this; }
+    Large& operator=(Large&& other) noexcept { std::memcpy(bytes, other.bytes, sizeof bytes); ++Counts::moves; return *this; }
+};
+
+struct MoveOnly {
+    std::unique_ptr<int> value;
+    explicit MoveOnly(int v) : value(new int(v)) {}
+    MoveOnly(MoveOnly&& other) noexcept : value(std::move(other.value)) { ++Counts::moves; }
+    MoveOnly& operator=(MoveOnly&& other) noexcept { value = std::move(other.value); ++Counts::moves; return *this; }
+};
+
+// moves, but may throw doing it
+struct ThrowingMove {
+    ThrowingMove() {}
+    ThrowingMove(const ThrowingMove&) {}
+    ThrowingMove(ThrowingMove&&) {}
+};
+
+template <template <typename> class S>
+struct SecretTraits {
+    static_assert(std::is_nothrow_move_constructible<S<Large>>::value, "moves as Large does");
+    static_assert(std::is_nothrow_move_assignable<S<Large>>::value, "moves as Large does");
+    static_assert(!std::is_nothrow_move_constructible<S<ThrowingMove>>::value, "may throw as ThrowingMove does");
+    static_assert(std::is_nothrow_move_constructible<S<std::string>>::value, "moves as std::string does");
+    static_assert(std::is_move_constructible<S<MoveOnly>>::value, "moves a MoveOnly");
+    static_assert(!std::is_copy_constructible<S<MoveOnly>>::value, "cannot copy a MoveOnly");
+    static_assert(!std::is_copy_assignable<S<MoveOnly>>::value, "cannot copy a MoveOnly");
+    static_assert(std::is_nothrow_constructible<S<Large>, std::size_t, char>::value, "Large(n, c) is noexcept");
+    static_assert(std::is_constructible<S<MoveOnly>, int>::value, "builds a MoveOnly in place");
+    static_assert(!std::is_convertible<int, S<MoveOnly>>::value, "in place construction is explicit");
+    static const bool ok = true;
+};
+
+template <template <typename> class S, typename Reveal>
+void checkSecret() {
+    static_assert(SecretTraits<S>::ok, "");
+    const Large large(10, 'x');
+
+    Counts::reset();
+    S<Large> inPlace(std::size_t(10), 'x');
+    CHECK(Counts::copies == 0 && Counts::moves == 0);
+
+    Counts::reset();
+    S<Large> fromLvalue(large);
+    CHECK(Counts::copies == 1 && Counts::moves == 0);
+
+    Counts::reset();
+    S<Large> fromTemporary(Large(10, 'y'));
+    CHECK(Counts::copies == 0 && Counts::moves == 1);
+
+    Counts::reset();
+    S<Large> moved(std::move(inPlace));
+    CHECK(Counts::copies == 0 && Counts::moves == 1);
+    fromLvalue = std::move(moved);
+    CHECK(Counts::copies == 0 && Counts::moves == 2);
+    fromLvalue = fromTemporary;
+    CHECK(Counts::copies == 1 && Counts::moves == 2);
+
+    // growing moves the old elements, as the move is noexcept: fill the
+    // vector to capacity, so the next one has to reallocate
+    std::vector<S<Large>> secrets;
+    secrets.emplace_back(std::size_t(1), 'z');
+    while (secrets.size() < secrets.capacity())
+        secrets.emplace_back(std::size_t(1), 'z');
+    const std::size_t full = secrets.size();
+    Counts::reset();
+    secrets.emplace_back(std::size_t(1), 'z');
+    CHECK(secrets.capacity() > full);
+    CHECK(Counts::copies == 0 && Counts::moves == static_cast<int>(full));
+
+    Counts::reset();
+    S<MoveOnly> only(42);
+    S<MoveOnly> taken(std::move(only));
+    CHECK(Counts::moves == 1 && *Reveal::reveal(taken).value == 42 && !Reveal::reveal(only).value);
+
+    S<std::string> repeated(std::size_t(3), 'x');
+    CHECK(Reveal::reveal(repeated) == "xxx");
+    S<std::string> converted = std::string("implicit from T");
+    CHECK(Reveal::reveal(converted) == "implicit from T");
+}
+
+}